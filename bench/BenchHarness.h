@@ -0,0 +1,57 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// Self-registering benchmarks for the game_bench binary, laid out like the test
+// harness: each is named "suite.name" and the binary runs every benchmark whose
+// name starts with its argument. Benchmarks print their own tables.
+namespace bench {
+
+typedef std::chrono::steady_clock Clock;
+
+struct Benchmark {
+    const char* name;
+    void (*run)();
+};
+
+inline std::vector<Benchmark>& registry() {
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+struct Registrar {
+    Registrar(const char* name, void (*run)()) { registry().push_back(Benchmark{name, run}); }
+};
+
+// Keeps the compiler from dropping work whose result nothing else reads
+inline void keep(uint64_t value) {
+    static volatile uint64_t sink;
+    sink = value;
+}
+
+// Calls fn in doubling rounds until minSeconds have passed; average nanoseconds per call
+template <typename F>
+double nanosPerCall(F&& fn, double minSeconds = 0.2) {
+    fn(); // Warm caches and lazily grown buffers
+    
+    uint64_t calls = 0;
+    uint64_t round = 1;
+    Clock::time_point start = Clock::now();
+    Clock::duration elapsed;
+    do {
+        for (uint64_t i = 0; i < round; i++) fn();
+        calls += round;
+        round *= 2;
+        elapsed = Clock::now() - start;
+    } while (elapsed < std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(minSeconds)));
+    
+    return std::chrono::duration<double, std::nano>(elapsed).count() / calls;
+}
+
+} // namespace bench
+
+#define BENCH_CASE(suite, name)                                                       \
+    static void suite##_##name();                                                     \
+    static bench::Registrar suite##_##name##_registrar(#suite "." #name, suite##_##name); \
+    static void suite##_##name()
@@ -0,0 +1,24 @@
+#include "BenchHarness.h"
+#include <cstring>
+#include <iostream>
+
+// Runs the benchmarks whose name starts with the first argument (all of them without one)
+int main(int argc, char* argv[]) {
+    const char* prefix = argc > 1 ? argv[1] : "";
+    
+    int run = 0;
+    for (const bench::Benchmark& benchmark : bench::registry()) {
+        if (std::strncmp(benchmark.name, prefix, std::strlen(prefix)) != 0) continue;
+        
+        std::cout << "== " << benchmark.name << std::endl;
+        benchmark.run();
+        std::cout << std::endl;
+        run++;
+    }
+    
+    if (run == 0) {
+        std::cerr << "No benchmarks match '" << prefix << "'" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include "BenchHarness.h"
+#include "GameState.h"
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// Bullet-vs-player hits through the spatial hash against the nested loop, over
+// 8-512 players and 100-20,000 bullets. Both paths run the same world and must
+// deal the same damage; the crossover is where "hash/loop" drops below 1.
+
+namespace {
+
+typedef bench::Clock Clock;
+
+const int TICKS = 10;
+
+struct PathResult {
+    double millisPerTick;
+    int64_t damage; // Health lost plus deaths, to check both paths agree
+};
+
+PathResult runPath(int players, size_t bullets, size_t hashThreshold) {
+    std::srand(12); // Same spawn points on both paths
+    GameState state;
+    state.setSpatialHashThreshold(hashThreshold);
+    for (int id = 1; id <= players; id++) {
+        state.addPlayer(id, "bot" + std::to_string(id));
+    }
+    
+    int nextBulletId = 1;
+    Clock::duration total(0);
+    for (int tick = 0; tick < TICKS; tick++) {
+        // Bullets that expired or hit are replaced outside the timing
+        const std::vector<Player*>& all = state.getAllPlayers();
+        for (size_t live = state.getBullets().size(); live < bullets; live++) {
+            const Player* shooter = all[nextBulletId % all.size()];
+            float angle = static_cast<float>((nextBulletId * 37) % 628) / 100.0f;
+            state.addBullet(nextBulletId++, shooter->getId(), shooter->getX() + 20, shooter->getY() + 20, angle, 400.0f);
+        }
+        
+        Clock::time_point start = Clock::now();
+        state.update(1.0f / 30.0f);
+        total += Clock::now() - start;
+    }
+    
+    PathResult result;
+    result.millisPerTick = std::chrono::duration<double, std::milli>(total).count() / TICKS;
+    result.damage = 0;
+    for (const Player* player : state.getAllPlayers()) {
+        result.damage += 100 - player->getHealth() + (player->isAlive() ? 0 : 1000);
+    }
+    return result;
+}
+
+} // namespace
+
+BENCH_CASE(broadphase, scaling) {
+    std::cout << "players  bullets   loop ms   hash ms  hash/loop" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+    
+    const int playerCounts[] = {8, 16, 24, 32, 64, 128, 256, 512};
+    const size_t bulletCounts[] = {100, 1000, 5000, 20000};
+    for (size_t bullets : bulletCounts) {
+        for (int players : playerCounts) {
+            PathResult loop = runPath(players, bullets, SIZE_MAX);
+            PathResult hash = runPath(players, bullets, 0);
+            std::cout << std::setw(7) << players << std::setw(9) << bullets << std::setw(10) << loop.millisPerTick
+                      << std::setw(10) << hash.millisPerTick << std::setw(11) << hash.millisPerTick / loop.millisPerTick
+                      << (loop.damage == hash.damage ? "" : "  damage differs!") << std::endl;
+        }
+    }
+}
@@ -0,0 +1,59 @@
+#include "BenchHarness.h"
+#include "Bullet.h"
+#include "BulletSystem.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+// Nanoseconds per bullet per tick: BulletSystem::integrate against the loop over
+// heap-allocated Bullets it replaced. The old loop is shown with the bullets in
+// allocation order and shuffled, as a long-running server's heap ends up. The SIMD
+// kernel is whatever GameShared was built with (SSE2 on x86-64, or AVX2 with
+// -DENABLE_AVX2=ON).
+
+namespace {
+
+// Small enough that no bullet expires however long the timing loop runs
+const float STEP = 1e-5f;
+
+} // namespace
+
+BENCH_CASE(bullets, integrate) {
+    std::cout << "bullets   Bullet* ns   shuffled ns   BulletSystem ns" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    
+    const size_t bulletCounts[] = {1000, 10000, 100000};
+    for (size_t count : bulletCounts) {
+        std::vector<std::unique_ptr<Bullet>> owned;
+        BulletSystem system;
+        system.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            float angle = static_cast<float>((i * 37) % 628) / 100.0f;
+            float x = static_cast<float>(i % 2000), y = static_cast<float>(i % 1500);
+            owned.emplace_back(new Bullet(static_cast<int>(i), 1, x, y, angle, 400.0f));
+            system.add(static_cast<int>(i), 1, x, y, owned.back()->getVelX(), owned.back()->getVelY());
+        }
+        
+        std::vector<Bullet*> inOrder;
+        for (auto& bullet : owned) {
+            inOrder.push_back(bullet.get());
+        }
+        std::vector<Bullet*> shuffled = inOrder;
+        std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(1));
+        
+        auto updateAll = [](const std::vector<Bullet*>& bullets) {
+            for (Bullet* bullet : bullets) {
+                bullet->update(STEP);
+            }
+        };
+        double ordered = bench::nanosPerCall([&]() { updateAll(inOrder); });
+        double scattered = bench::nanosPerCall([&]() { updateAll(shuffled); });
+        double soa = bench::nanosPerCall([&]() { system.integrate(STEP); });
+        
+        std::cout << std::setw(7) << count << std::setw(13) << ordered / count << std::setw(14) << scattered / count
+                  << std::setw(18) << soa / count << std::endl;
+    }
+}
@@ -0,0 +1,122 @@
+#include "BenchHarness.h"
+#include "GameState.h"
+#include "CollisionMap.h"
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Obstacle queries through the CollisionMap grid against the linear scan over every
+// obstacle that GameState::checkObstacleCollision used to do, then a whole tick
+// with 10k bullets in flight.
+
+namespace {
+
+typedef bench::Clock Clock;
+
+const size_t QUERIES = 4096;
+
+// The old checkObstacleCollision
+bool linearScan(const std::vector<Obstacle>& obstacles, float x, float y, float width, float height) {
+    for (const Obstacle& obs : obstacles) {
+        if (x < obs.x + obs.width && x + width > obs.x && y < obs.y + obs.height && y + height > obs.y) {
+            return true;
+        }
+    }
+    return false;
+}
+
+struct Query {
+    float x, y;
+};
+
+std::vector<Query> randomQueries(const GameState& state, unsigned seed) {
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> x(0, state.getWorldWidth()), y(0, state.getWorldHeight());
+    std::vector<Query> queries(QUERIES);
+    for (Query& query : queries) {
+        query = Query{x(random), y(random)};
+    }
+    return queries;
+}
+
+// Tops the world up to the given number of bullets flying in all directions
+void refill(GameState& state, size_t bullets, int& nextBulletId) {
+    const std::vector<Player*>& players = state.getAllPlayers();
+    for (size_t live = state.getBullets().size(); live < bullets; live++) {
+        const Player* shooter = players[nextBulletId % players.size()];
+        float angle = static_cast<float>((nextBulletId * 37) % 628) / 100.0f;
+        state.addBullet(nextBulletId++, shooter->getId(), shooter->getX() + 20, shooter->getY() + 20, angle, 400.0f);
+    }
+}
+
+} // namespace
+
+BENCH_CASE(obstacles, query_cost) {
+    GameState state;
+    const std::vector<Obstacle>& obstacles = state.getObstacles();
+    CollisionMap map;
+    map.build(obstacles, state.getWorldWidth(), state.getWorldHeight());
+    std::vector<Query> queries = randomQueries(state, 4);
+    
+    std::cout << obstacles.size() << " obstacles, " << map.getColumns() << "x" << map.getRows() << " grid" << std::endl;
+    std::cout << "query            linear ns   grid ns" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    
+    const float sizes[] = {5, 40}; // A bullet, a player
+    for (float size : sizes) {
+        size_t next = 0;
+        uint64_t hits = 0;
+        double linear = bench::nanosPerCall([&]() {
+            hits += linearScan(obstacles, queries[next].x, queries[next].y, size, size);
+            next = (next + 1) % QUERIES;
+        });
+        double grid = bench::nanosPerCall([&]() {
+            hits += map.overlaps(queries[next].x, queries[next].y, size, size);
+            next = (next + 1) % QUERIES;
+        });
+        bench::keep(hits);
+        std::cout << std::setw(2) << static_cast<int>(size) << "x" << std::setw(2) << std::left
+                  << static_cast<int>(size) << " overlap" << std::right << std::setw(17) << linear
+                  << std::setw(10) << grid << std::endl;
+    }
+    
+    // One bullet step at 400 px/s and 30 Hz, as checkBulletCollisions sweeps it
+    size_t next = 0;
+    uint64_t hits = 0;
+    double sweep = bench::nanosPerCall([&]() {
+        float hitTime;
+        const Query& query = queries[next];
+        hits += map.sweep(query.x, query.y, query.x + 13.3f, query.y + 2.0f, 2.5f, hitTime);
+        next = (next + 1) % QUERIES;
+    });
+    bench::keep(hits);
+    std::cout << "5x5 sweep                    -" << std::setw(10) << sweep << std::endl;
+}
+
+BENCH_CASE(obstacles, tick_with_10k_bullets) {
+    const size_t BULLETS = 10000;
+    const int TICKS = 200;
+    
+    std::srand(8);
+    GameState state;
+    for (int id = 1; id <= 16; id++) {
+        state.addPlayer(id, "bot" + std::to_string(id));
+    }
+    int nextBulletId = 1;
+    refill(state, BULLETS, nextBulletId);
+    state.update(1.0f / 30.0f);
+    
+    // Bullets that expire or hit are replaced between ticks, outside the timing
+    Clock::duration total(0);
+    for (int tick = 0; tick < TICKS; tick++) {
+        refill(state, BULLETS, nextBulletId);
+        Clock::time_point start = Clock::now();
+        state.update(1.0f / 30.0f);
+        total += Clock::now() - start;
+    }
+    
+    std::cout << std::fixed << std::setprecision(3) << "16 players, " << BULLETS << " bullets: "
+              << std::chrono::duration<double, std::milli>(total).count() / TICKS << " ms per tick" << std::endl;
+}
@@ -0,0 +1,68 @@
+#include "BenchHarness.h"
+#include "HitboxHistory.h"
+#include "Player.h"
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Rewind lookups in the hitbox history: finding one player's hitbox a few ticks
+// back (what a lag-compensated hit check asks for), fetching a whole rewound
+// frame, and recording a tick for comparison.
+
+namespace {
+
+const int MAX_REWIND_TICKS = 6; // 200 ms at 30 Hz
+const size_t QUERIES = 4096;
+
+} // namespace
+
+BENCH_CASE(hitbox, rewind_lookup) {
+    std::cout << "players   find ns   frame ns   record ns" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    
+    const int playerCounts[] = {16, 64, 256};
+    for (int count : playerCounts) {
+        std::vector<Player> storage;
+        for (int id = 1; id <= count; id++) {
+            storage.push_back(Player(id, "p" + std::to_string(id), id * 7.0f, id * 3.0f));
+        }
+        std::vector<Player*> players;
+        for (Player& player : storage) {
+            players.push_back(&player);
+        }
+        
+        HitboxHistory history;
+        int tick = 0;
+        for (; tick < static_cast<int>(history.getCapacity()); tick++) {
+            history.record(tick, players);
+        }
+        const int now = tick - 1;
+        
+        // Random shooters' rewinds and targets, drawn up front
+        std::mt19937 random(9);
+        std::vector<int> ticks(QUERIES), ids(QUERIES);
+        for (size_t i = 0; i < QUERIES; i++) {
+            ticks[i] = now - static_cast<int>(random() % (MAX_REWIND_TICKS + 1));
+            ids[i] = 1 + static_cast<int>(random() % count);
+        }
+        
+        size_t next = 0;
+        double findNanos = bench::nanosPerCall([&]() {
+            const HitboxEntry* entry = history.find(ticks[next], ids[next]);
+            bench::keep(entry ? static_cast<uint64_t>(entry->x) : 0);
+            next = (next + 1) % QUERIES;
+        });
+        double frameNanos = bench::nanosPerCall([&]() {
+            size_t entries;
+            const HitboxEntry* frame = history.frame(ticks[next], entries);
+            bench::keep(frame ? entries : 0);
+            next = (next + 1) % QUERIES;
+        });
+        double recordNanos = bench::nanosPerCall([&]() { history.record(tick++, players); });
+        
+        std::cout << std::setw(7) << count << std::setw(10) << findNanos << std::setw(11) << frameNanos
+                  << std::setw(12) << recordNanos << std::endl;
+    }
+}
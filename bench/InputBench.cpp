@@ -0,0 +1,95 @@
+#include "BenchHarness.h"
+#include "InputCommand.h"
+#include "NetworkManager.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Server-side decode throughput of PLAYER_MOVE payloads: the text form (one command
+// per packet) against binary packets carrying the newest 3 commands, on their own
+// and with the NetworkMessage parsing every datagram goes through first.
+
+namespace {
+
+const size_t PACKETS = 4096;
+const size_t REDUNDANCY = 3; // Commands per binary packet, as the client sends them
+
+InputCommand scripted(uint32_t sequence) {
+    InputCommand command;
+    command.sequence = sequence;
+    command.left = (sequence / 20) % 4 == 0;
+    command.right = (sequence / 20) % 4 == 2;
+    command.up = (sequence / 7) % 3 == 0;
+    command.down = (sequence / 7) % 3 == 1;
+    command.angle = static_cast<float>(sequence % 628) / 100.0f - 3.14f;
+    return command;
+}
+
+std::string wrap(const std::string& payload) {
+    NetworkMessage message;
+    message.type = MessageType::PLAYER_MOVE;
+    message.playerId = 42;
+    message.data = payload;
+    return message.serialize();
+}
+
+void printRow(const char* format, double bytes, double nanosPerPacket, size_t commandsPerPacket) {
+    std::cout << "  " << std::setw(22) << std::left << format << std::right << std::setw(8) << bytes
+              << std::setw(14) << 1e3 / nanosPerPacket << std::setw(16) << commandsPerPacket * 1e3 / nanosPerPacket
+              << std::endl;
+}
+
+} // namespace
+
+BENCH_CASE(input, decode_throughput) {
+    std::vector<std::string> text(PACKETS), binary(PACKETS), textDatagrams(PACKETS), binaryDatagrams(PACKETS);
+    std::vector<InputCommand> history;
+    double textBytes = 0, binaryBytes = 0;
+    for (uint32_t sequence = 1; sequence <= PACKETS; sequence++) {
+        history.push_back(scripted(sequence));
+        size_t count = std::min(history.size(), REDUNDANCY);
+        
+        text[sequence - 1] = history.back().toText();
+        InputCommand::encodeBatch(&history[history.size() - count], count, binary[sequence - 1]);
+        textDatagrams[sequence - 1] = wrap(text[sequence - 1]);
+        binaryDatagrams[sequence - 1] = wrap(binary[sequence - 1]);
+        textBytes += text[sequence - 1].size();
+        binaryBytes += binary[sequence - 1].size();
+    }
+    
+    size_t next = 0;
+    uint64_t decoded = 0;
+    InputCommand command;
+    std::vector<InputCommand> commands;
+    NetworkMessage message;
+    
+    double textNanos = bench::nanosPerCall([&]() {
+        decoded += InputCommand::fromText(text[next], command);
+        next = (next + 1) % PACKETS;
+    });
+    double binaryNanos = bench::nanosPerCall([&]() {
+        decoded += InputCommand::decodeBatch(binary[next], commands) ? commands.size() : 0;
+        next = (next + 1) % PACKETS;
+    });
+    double textMessageNanos = bench::nanosPerCall([&]() {
+        message = NetworkMessage::deserialize(textDatagrams[next]);
+        decoded += InputCommand::fromText(message.data, command);
+        next = (next + 1) % PACKETS;
+    });
+    double binaryMessageNanos = bench::nanosPerCall([&]() {
+        message = NetworkMessage::deserialize(binaryDatagrams[next]);
+        decoded += InputCommand::decodeBatch(message.data, commands) ? commands.size() : 0;
+        next = (next + 1) % PACKETS;
+    });
+    bench::keep(decoded);
+    
+    std::cout << "  " << std::setw(22) << std::left << "payload" << std::right << std::setw(8) << "bytes"
+              << std::setw(14) << "M packets/s" << std::setw(16) << "M commands/s" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    printRow("text", textBytes / PACKETS, textNanos, 1);
+    printRow("binary", binaryBytes / PACKETS, binaryNanos, REDUNDANCY);
+    printRow("text + message", textBytes / PACKETS, textMessageNanos, 1);
+    printRow("binary + message", binaryBytes / PACKETS, binaryMessageNanos, REDUNDANCY);
+}
@@ -0,0 +1,110 @@
+#include "BenchHarness.h"
+#include "GameState.h"
+#include "InterestFilter.h"
+#include "SnapshotCodec.h"
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Snapshot bandwidth per client with and without interest filtering, for a busy
+// room where everyone strafes and fires. Every client acks the previous snapshot,
+// so each row is the size of a steady-state delta. Same seed every run.
+
+namespace {
+
+const float STEP = 1.0f / 30.0f;
+const int SNAPSHOTS_PER_SECOND = 30;
+const int TICKS = 300;
+
+struct Bandwidth {
+    double bytesPerSnapshot;
+    double kilobytesPerSecond;
+};
+
+// byteBudget < 0: no filtering, everyone gets the whole world
+Bandwidth measure(int players, int byteBudget) {
+    std::srand(18);
+    GameState state;
+    for (int id = 1; id <= players; id++) {
+        state.addPlayer(id, "player" + std::to_string(id));
+    }
+    
+    InterestFilter filter;
+    std::vector<InterestState> views(players);
+    WorldSnapshot previous, snapshot;
+    std::string data;
+    int nextBulletId = 1;
+    uint64_t bytes = 0, sent = 0;
+    for (int tick = 1; tick <= TICKS; tick++) {
+        for (Player* player : state.getAllPlayers()) {
+            InputCommand command;
+            command.right = (tick / 15 + player->getId()) % 2 == 0;
+            command.left = !command.right;
+            command.down = (tick / 25 + player->getId()) % 3 == 0;
+            state.applyInput(player, command);
+            if ((tick + player->getId()) % 6 == 0) {
+                float angle = static_cast<float>((nextBulletId * 37) % 628) / 100.0f;
+                state.addBullet(nextBulletId++, player->getId(), player->getX() + 20, player->getY() + 20, angle, 400.0f);
+            }
+        }
+        state.update(STEP);
+        state.captureSnapshot(snapshot);
+        
+        // The first second is everyone joining; only count the steady state after it
+        bool counted = tick > SNAPSHOTS_PER_SECOND;
+        if (byteBudget < 0) {
+            SnapshotCodec::encodeDelta(previous, snapshot, data);
+            if (counted) {
+                bytes += data.size() * players; // One encoding, sent to everyone
+                sent += players;
+            }
+            std::swap(previous, snapshot);
+            continue;
+        }
+        
+        for (int id = 1; id <= players; id++) {
+            InterestState& view = views[id - 1];
+            previous = view.view;
+            filter.update(snapshot, id, byteBudget, view);
+            SnapshotCodec::encodeDelta(previous, view.view, data);
+            if (counted) {
+                bytes += data.size();
+                sent++;
+            }
+        }
+    }
+    
+    Bandwidth result;
+    result.bytesPerSnapshot = static_cast<double>(bytes) / sent;
+    result.kilobytesPerSecond = result.bytesPerSnapshot * SNAPSHOTS_PER_SECOND / 1000;
+    return result;
+}
+
+} // namespace
+
+BENCH_CASE(interest, bandwidth_per_client) {
+    std::cout << "players  mode                 bytes/snapshot    kB/s" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    
+    struct Mode {
+        const char* name;
+        int byteBudget;
+    };
+    const Mode modes[] = {
+        {"whole world", -1},
+        {"filtered", 0},
+        {"filtered, 20 kB/s", 20000 / SNAPSHOTS_PER_SECOND},
+        {"filtered, 8 kB/s", 8000 / SNAPSHOTS_PER_SECOND},
+    };
+    const int playerCounts[] = {32, 128};
+    for (int players : playerCounts) {
+        for (const Mode& mode : modes) {
+            Bandwidth bandwidth = measure(players, mode.byteBudget);
+            std::cout << std::setw(7) << players << "  " << std::setw(19) << std::left << mode.name << std::right
+                      << std::setw(16) << bandwidth.bytesPerSnapshot << std::setw(8) << bandwidth.kilobytesPerSecond
+                      << std::endl;
+        }
+    }
+}
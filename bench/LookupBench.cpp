@@ -0,0 +1,66 @@
+#include "BenchHarness.h"
+#include "FlatHashMap.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+// Random id lookups in FlatHashMap against the std::map it replaced (and
+// std::unordered_map for reference), at 16, 256 and 4096 entries. Ids are sparse,
+// as they are once players and bullets have come and gone.
+
+namespace {
+
+const size_t QUERIES = 4096;
+
+template <typename Map>
+double lookupNanos(const Map& map, const std::vector<int>& queries) {
+    size_t next = 0;
+    uint64_t sum = 0;
+    double nanos = bench::nanosPerCall([&]() {
+        auto it = map.find(queries[next]);
+        if (it != map.end()) sum += it->second;
+        next = (next + 1) % QUERIES;
+    });
+    bench::keep(sum);
+    return nanos;
+}
+
+} // namespace
+
+BENCH_CASE(lookup, id_maps) {
+    std::cout << "entries   std::map ns   unordered_map ns   FlatHashMap ns" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    
+    const size_t entryCounts[] = {16, 256, 4096};
+    for (size_t entries : entryCounts) {
+        std::mt19937 random(static_cast<unsigned>(entries));
+        std::vector<int> ids(entries * 4);
+        for (size_t i = 0; i < ids.size(); i++) {
+            ids[i] = static_cast<int>(i + 1);
+        }
+        std::shuffle(ids.begin(), ids.end(), random);
+        ids.resize(entries);
+        
+        std::map<int, uintptr_t> tree;
+        std::unordered_map<int, uintptr_t> buckets;
+        FlatHashMap<int, uintptr_t> flat;
+        for (int id : ids) {
+            tree[id] = static_cast<uintptr_t>(id);
+            buckets[id] = static_cast<uintptr_t>(id);
+            flat[id] = static_cast<uintptr_t>(id);
+        }
+        
+        std::vector<int> queries(QUERIES);
+        for (int& query : queries) {
+            query = ids[random() % entries];
+        }
+        
+        std::cout << std::setw(7) << entries << std::setw(14) << lookupNanos(tree, queries)
+                  << std::setw(19) << lookupNanos(buckets, queries) << std::setw(17) << lookupNanos(flat, queries)
+                  << std::endl;
+    }
+}
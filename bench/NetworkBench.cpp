@@ -0,0 +1,116 @@
+#include "BenchHarness.h"
+#include "NetworkManager.h"
+#include <arpa/inet.h>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Syscalls a server spends per tick over loopback: every client sends one input,
+// the server drains its socket and broadcasts one snapshot to everyone, with and
+// without batched I/O (recvmmsg/sendmmsg).
+
+namespace {
+
+typedef bench::Clock Clock;
+
+const int TICKS = 300;
+const size_t SNAPSHOT_BYTES = 600;
+
+struct TickCost {
+    double receiveCalls;
+    double sendCalls;
+    double micros; // Server side: drain and broadcast
+    size_t lost;
+};
+
+TickCost runTicks(int clients, bool batched) {
+    NetworkManager server;
+    server.initializeSocket();
+    server.setBatchedIO(batched);
+    server.bindToPort(0);
+    
+    // Room for a full tick of inputs, so the default buffer doesn't turn this into a loss test
+    int bufferBytes = 4 * 1024 * 1024;
+    setsockopt(server.getSocketHandle(), SOL_SOCKET, SO_RCVBUF, &bufferBytes, sizeof(bufferBytes));
+    
+    sockaddr_in bound;
+    socklen_t boundLength = sizeof(bound);
+    getsockname(server.getSocketHandle(), (sockaddr*)&bound, &boundLength);
+    
+    std::vector<std::unique_ptr<NetworkManager>> players;
+    for (int i = 0; i < clients; i++) {
+        players.emplace_back(new NetworkManager());
+        players.back()->initializeSocket();
+        players.back()->setServerAddress("127.0.0.1", ntohs(bound.sin_port));
+    }
+    
+    NetworkMessage input;
+    input.type = MessageType::PLAYER_MOVE;
+    input.data = "0,1,0,0,90";
+    NetworkMessage snapshot;
+    snapshot.type = MessageType::GAME_STATE_UPDATE;
+    snapshot.playerId = 0;
+    snapshot.data.assign(SNAPSHOT_BYTES, 's');
+    
+    std::vector<sockaddr_in> addresses;
+    NetworkMessage message;
+    sockaddr_in from;
+    Clock::duration serverTime(0);
+    size_t sent = 0;
+    
+    for (int tick = 0; tick < TICKS; tick++) {
+        for (int i = 0; i < clients; i++) {
+            input.playerId = i + 1;
+            players[i]->sendMessage(input, players[i]->getServerAddress());
+            sent++;
+        }
+        
+        // The first tick learns the client addresses and isn't counted
+        if (tick == 1) {
+            server.resetIOStats();
+            serverTime = Clock::duration(0);
+            sent = clients;
+        }
+        
+        Clock::time_point start = Clock::now();
+        while (server.receiveMessage(message, from)) {
+            if (tick == 0) addresses.push_back(from);
+        }
+        server.queueBroadcast(snapshot, addresses);
+        server.flushQueued();
+        serverTime += Clock::now() - start;
+        
+        for (auto& player : players) {
+            while (player->receiveMessage(message, from)) {
+            }
+        }
+    }
+    
+    const double counted = TICKS - 1;
+    TickCost cost;
+    cost.receiveCalls = server.getReceiveCalls() / counted;
+    cost.sendCalls = server.getSendCalls() / counted;
+    cost.micros = std::chrono::duration<double, std::micro>(serverTime).count() / counted;
+    cost.lost = sent - server.getDatagramsReceived();
+    return cost;
+}
+
+} // namespace
+
+BENCH_CASE(network, loopback_syscalls_per_tick) {
+    std::cout << "clients  mode      recv calls/tick  send calls/tick  server us/tick  inputs lost" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    
+    const int clientCounts[] = {16, 64, 256};
+    for (int clients : clientCounts) {
+        for (bool batched : {false, true}) {
+            TickCost cost = runTicks(clients, batched);
+            std::cout << std::setw(7) << clients << "  " << std::setw(8) << std::left
+                      << (batched ? "batched" : "single") << std::right << std::setw(17) << cost.receiveCalls
+                      << std::setw(17) << cost.sendCalls << std::setw(16) << cost.micros
+                      << std::setw(13) << cost.lost << std::endl;
+        }
+    }
+}
@@ -0,0 +1,71 @@
+#include "BenchHarness.h"
+#include "TickProfiler.h"
+#include "GameState.h"
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// What PROFILE_SCOPE costs: per scope, against the same work with no scope at all
+// (as built with -DENABLE_PROFILING=OFF), and for a whole GameState tick, which
+// runs about a dozen scopes.
+
+namespace {
+
+uint64_t counter = 0;
+
+void bare() {
+    bench::keep(++counter);
+}
+
+void scoped() {
+    PROFILE_SCOPE("bench.scope");
+    bench::keep(++counter);
+}
+
+} // namespace
+
+BENCH_CASE(profiler, scope_overhead) {
+#ifndef ENABLE_PROFILING
+    std::cout << "Built with ENABLE_PROFILING off; every row is the bare loop" << std::endl;
+#endif
+    TickProfiler profiler;
+    TickProfiler::setCurrent(&profiler);
+    std::cout << std::fixed << std::setprecision(2);
+    
+    double none = bench::nanosPerCall(bare);
+    TickProfiler::setEnabled(false);
+    double disabled = bench::nanosPerCall(scoped);
+    TickProfiler::setEnabled(true);
+    double enabled = bench::nanosPerCall(scoped);
+    TickProfiler::setEnabled(false);
+    profiler.endTick();
+    
+    std::cout << "ns per call: no scope " << none << ", disabled " << disabled << ", enabled " << enabled << std::endl;
+    
+    std::srand(2);
+    GameState state;
+    for (int id = 1; id <= 40; id++) {
+        state.addPlayer(id, "bot" + std::to_string(id));
+    }
+    int bulletId = 1;
+    auto tick = [&]() {
+        const std::vector<Player*>& players = state.getAllPlayers();
+        for (int i = 0; i < 4; i++) {
+            const Player* shooter = players[bulletId % players.size()];
+            float angle = static_cast<float>((bulletId * 37) % 628) / 100.0f;
+            state.addBullet(bulletId++, shooter->getId(), shooter->getX() + 20, shooter->getY() + 20, angle, 400.0f);
+        }
+        state.update(1.0f / 30.0f);
+        profiler.endTick();
+    };
+    
+    double tickDisabled = bench::nanosPerCall(tick, 1.0);
+    TickProfiler::setEnabled(true);
+    double tickEnabled = bench::nanosPerCall(tick, 1.0);
+    TickProfiler::setEnabled(false);
+    TickProfiler::setCurrent(nullptr);
+    
+    std::cout << "us per 40-player tick: disabled " << tickDisabled / 1000 << ", enabled " << tickEnabled / 1000
+              << std::endl;
+}
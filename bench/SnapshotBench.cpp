@@ -0,0 +1,95 @@
+#include "BenchHarness.h"
+#include "GameState.h"
+#include "SnapshotCodec.h"
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// The binary snapshot codec against the text format (GameState::serialize), end to
+// end on both sides: encode includes capturing the snapshot, decode includes
+// applying it to a client's GameState.
+
+namespace {
+
+const float STEP = 1.0f / 30.0f;
+
+void populate(GameState& state, int players) {
+    std::srand(3);
+    for (int id = 1; id <= players; id++) {
+        state.addPlayer(id, "player" + std::to_string(id));
+    }
+    int bulletId = 1;
+    for (Player* player : state.getAllPlayers()) {
+        for (int i = 0; i < 2; i++) {
+            float angle = static_cast<float>((bulletId * 97) % 628) / 100.0f;
+            state.addBullet(bulletId++, player->getId(), player->getX() + 20, player->getY() + 20, angle, 300.0f);
+        }
+    }
+    state.update(STEP);
+}
+
+// Everyone keeps moving, so a delta carries every player's position
+void stepAll(GameState& state, int tick) {
+    for (Player* player : state.getAllPlayers()) {
+        InputCommand command;
+        command.right = (tick / 20 + player->getId()) % 2 == 0;
+        command.left = !command.right;
+        state.applyInput(player, command);
+    }
+    state.update(STEP);
+}
+
+void printRow(const char* format, double bytesPerPlayer, double encodeNanos, double decodeNanos) {
+    std::cout << "  " << std::setw(12) << std::left << format << std::right << std::setw(16) << bytesPerPlayer
+              << std::setw(12) << encodeNanos / 1000 << std::setw(12) << decodeNanos / 1000 << std::endl;
+}
+
+} // namespace
+
+BENCH_CASE(codec, text_vs_binary) {
+    std::cout << std::fixed << std::setprecision(1);
+    
+    const int playerCounts[] = {8, 32, 128};
+    for (int players : playerCounts) {
+        GameState server;
+        populate(server, players);
+        GameState client;
+        WorldSnapshot baseline, snapshot, decoded;
+        server.captureSnapshot(baseline);
+        stepAll(server, 1);
+        
+        std::cout << players << " players, " << server.getBullets().size()
+                  << " bullets:     bytes/player   encode us   decode us" << std::endl;
+        
+        std::string text = server.serialize();
+        double textEncode = bench::nanosPerCall([&]() { bench::keep(server.serialize().size()); });
+        double textDecode = bench::nanosPerCall([&]() { client.deserialize(text); });
+        printRow("text", static_cast<double>(text.size()) / players, textEncode, textDecode);
+        
+        std::string full;
+        double fullEncode = bench::nanosPerCall([&]() {
+            server.captureSnapshot(snapshot);
+            SnapshotCodec::encode(snapshot, full);
+        });
+        double fullDecode = bench::nanosPerCall([&]() {
+            SnapshotCodec::decode(full, decoded);
+            client.applySnapshot(decoded);
+        });
+        printRow("binary full", static_cast<double>(full.size()) / players, fullEncode, fullDecode);
+        
+        // Against the previous tick, as for a client that acked it
+        SnapshotHistory history;
+        history.store(baseline);
+        std::string delta;
+        double deltaEncode = bench::nanosPerCall([&]() {
+            server.captureSnapshot(snapshot);
+            SnapshotCodec::encodeDelta(baseline, snapshot, delta);
+        });
+        double deltaDecode = bench::nanosPerCall([&]() {
+            SnapshotCodec::decode(delta, decoded, &history);
+            client.applySnapshot(decoded);
+        });
+        printRow("binary delta", static_cast<double>(delta.size()) / players, deltaEncode, deltaDecode);
+    }
+}
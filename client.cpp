@@ -1,18 +1,33 @@
 #include <iostream>
 #include <string>
 #include <chrono>
+#include <thread>
 #include <sstream>
 #include <cmath>
+#include <cstdlib>
 #include "GameState.h"
 #include "GameRenderer.h"
 #include "InputHandler.h"
 #include "NetworkManager.h"
+#include "ReliableChannel.h"
+#include "SnapshotCodec.h"
+#include "FixedTimestep.h"
+#include "PredictionBuffer.h"
+#include "SnapshotInterpolator.h"
 
 #define SERVER_PORT 8080
+#define INPUT_REDUNDANCY 3 // Commands repeated in each input packet, so one lost packet loses no input
+#define LEAVE_LINGER_MS 300 // How long cleanup waits for the server to ack the leave
 
 class GameClient {
 public:
-    GameClient() : playerId_(-1), connected_(false), inNameEntry_(true), serverIP_("127.0.0.1") {}
+    GameClient() : latestSnapshotTick_(-1), inputSequence_(0), recentInputCount_(0), aimAngle_(0),
+                   serverIP_("127.0.0.1"), rate_(0), playerId_(-1), connected_(false), inNameEntry_(true) {}
+    
+    void setInterpolationDelay(float seconds) { interpolator_.setDelay(seconds); }
+    void setRoom(const std::string& room) { room_ = room; }
+    void setRate(int bytesPerSecond) { rate_ = bytesPerSecond; }
+    void setLinkConditions(const LinkConditions& conditions) { linkConditions_ = conditions; }
     
     bool initialize() {
         // Initialize graphics first
@@ -32,15 +47,23 @@ public:
         }
         
         networkManager_.setServerAddress(serverIP_, SERVER_PORT);
+        networkManager_.setLinkConditions(linkConditions_);
         playerName_ = playerName;
         
         // Send join request
         NetworkMessage joinMessage;
         joinMessage.type = MessageType::PLAYER_JOIN;
         joinMessage.data = playerName;
+        if (!room_.empty() || rate_ > 0) {
+            joinMessage.data += "|" + room_; // Ask for a specific room instead of auto-fill
+        }
+        if (rate_ > 0) {
+            joinMessage.data += "|" + std::to_string(rate_); // Cap on game state bytes per second
+        }
         joinMessage.playerId = 0; // Will be assigned by server
         
-        networkManager_.sendMessage(joinMessage, networkManager_.getServerAddress());
+        reliable_.reset();
+        sendReliable(joinMessage);
         
         std::cout << "Connected to server: " << serverIP_ << ":" << SERVER_PORT << std::endl;
         connected_ = true;
@@ -58,9 +81,6 @@ public:
             auto currentTime = std::chrono::high_resolution_clock::now();
             float deltaTime = std::chrono::duration<float>(currentTime - lastUpdate).count();
             
-            // Cap deltaTime to prevent large jumps
-            if (deltaTime > 0.016f) deltaTime = 0.016f;
-            
             if (inNameEntry_) {
                 // Name entry screen
                 BeginDrawing();
@@ -102,8 +122,8 @@ public:
                 // Handle text input
                 int key = GetCharPressed();
                 while (key > 0) {
-                    // Only allow alphanumeric and space
-                    if ((key >= 32) && (key <= 125) && (nameLength < 31)) {
+                    // Only allow printable characters; '|' separates the join fields
+                    if ((key >= 32) && (key <= 125) && (key != '|') && (nameLength < 31)) {
                         nameBuffer[nameLength] = (char)key;
                         nameLength++;
                         nameBuffer[nameLength] = '\0';
@@ -131,6 +151,7 @@ public:
                 // Game is running
                 // Process network messages first to get player ID and game state
                 processNetworkMessages();
+                flushReliable();
                 
                 // Update camera to follow local player - do this before input handling
                 Player* localPlayer = gameState_.getPlayer(playerId_);
@@ -144,8 +165,18 @@ public:
                     handleInput();
                 }
                 
-                // Update local game state (prediction)
-                gameState_.update(deltaTime);
+                // Update local game state (prediction) in the same fixed steps as the server,
+                // sending one input command per step
+                int steps = timestep_.advance(deltaTime);
+                for (int i = 0; i < steps; i++) {
+                    if (playerId_ != -1) {
+                        sendInputCommand();
+                    }
+                    gameState_.update(timestep_.getStepSeconds());
+                }
+                
+                // Smooth remote players and bullets between snapshots
+                interpolator_.apply(gameState_, deltaTime, playerId_);
                 
                 // Render everything in one go, passing local player ID
                 renderer_.render(gameState_, playerId_);
@@ -161,8 +192,15 @@ public:
             NetworkMessage disconnectMessage;
             disconnectMessage.type = MessageType::PLAYER_LEAVE;
             disconnectMessage.playerId = playerId_;
+            sendReliable(disconnectMessage);
             
-            networkManager_.sendMessage(disconnectMessage, networkManager_.getServerAddress());
+            // Give the leave a moment to get through, resending it if it was lost
+            auto deadline = ReliableChannel::Clock::now() + std::chrono::milliseconds(LEAVE_LINGER_MS);
+            while (reliable_.getPendingCount() > 0 && ReliableChannel::Clock::now() < deadline) {
+                processNetworkMessages();
+                flushReliable();
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
         }
         
         networkManager_.cleanup();
@@ -174,9 +212,25 @@ private:
     GameRenderer renderer_;
     InputHandler inputHandler_;
     NetworkManager networkManager_;
+    ReliableChannel reliable_; // Join, leave, respawn and shoot; also acks on input and snapshot acks
+    std::vector<NetworkMessage> reliableMessages_;
+    WorldSnapshot snapshot_;
+    SnapshotHistory snapshotHistory_;
+    int latestSnapshotTick_;
+    FixedTimestep timestep_;
+    PredictionBuffer prediction_;
+    SnapshotInterpolator interpolator_;
+    uint32_t inputSequence_;
+    InputCommand recentInputs_[INPUT_REDUNDANCY]; // Oldest first
+    size_t recentInputCount_;
+    std::string inputPacket_;
+    float aimAngle_;
     
     std::string playerName_;
     std::string serverIP_;
+    std::string room_;
+    int rate_;
+    LinkConditions linkConditions_; // Impairs what we send, for testing
     int playerId_;
     bool connected_;
     bool inNameEntry_;
@@ -195,7 +249,7 @@ private:
                 respawnMessage.type = MessageType::PLAYER_RESPAWN;
                 respawnMessage.playerId = playerId_;
                 respawnMessage.data = "";
-                networkManager_.sendMessage(respawnMessage, networkManager_.getServerAddress());
+                sendReliable(respawnMessage);
                 std::cout << "Requesting respawn..." << std::endl;
             }
             // Reset velocity for dead player
@@ -203,33 +257,12 @@ private:
             return;
         }
         
-        // Local movement for immediate feedback - 4 directions
-        // Only process movement if player is alive
-        float moveSpeed = 200.0f;
-        float velX = 0, velY = 0;
-        
-        // Use IsKeyDown directly for all movement keys to ensure consistent behavior
-        if (IsKeyDown(KEY_A)) {
-            velX = -moveSpeed;
-        }
-        if (IsKeyDown(KEY_D)) {
-            velX = moveSpeed;
-        }
-        if (IsKeyDown(KEY_W)) {
-            velY = -moveSpeed; // Move up
-        }
-        if (IsKeyDown(KEY_S)) {
-            velY = moveSpeed;  // Move down
-        }
-        
-        // Apply movement locally
-        localPlayer->setVelocity(velX, velY);
-        
         // Update aim angle based on mouse
         Vector2 playerPos = {localPlayer->getX(), localPlayer->getY()};
         Vector2 mousePos = renderer_.screenToWorld(inputHandler_.getMousePosition());
         float angle = atan2(mousePos.y - playerPos.y, mousePos.x - playerPos.x);
         localPlayer->setAngle(angle);
+        aimAngle_ = angle;
         
         // Handle shooting - only if alive
         if (input.shoot) {
@@ -242,31 +275,105 @@ private:
             oss << localPlayer->getX() + 10 << "," 
                 << localPlayer->getY() + 10 << "," 
                 << angle;
+            
+            // Include the tick other players were drawn at so the server can rewind to it
+            if (interpolator_.getRenderTime() > 0.0f) {
+                oss << "," << std::lround(interpolator_.getRenderTime() / timestep_.getStepSeconds());
+            }
             shootMessage.data = oss.str();
             
-            networkManager_.sendMessage(shootMessage, networkManager_.getServerAddress());
+            sendReliable(shootMessage);
         }
+    }
+    
+    // Called once per simulation step: movement is sampled at the tick rate, applied
+    // locally for immediate feedback, and remembered until the server acknowledges it
+    void sendInputCommand() {
+        Player* localPlayer = gameState_.getPlayer(playerId_);
+        if (!localPlayer || !localPlayer->isAlive()) return;
+        
+        InputCommand command;
+        command.sequence = ++inputSequence_;
+        command.left = IsKeyDown(KEY_A);
+        command.right = IsKeyDown(KEY_D);
+        command.up = IsKeyDown(KEY_W);
+        command.down = IsKeyDown(KEY_S);
+        command.angle = aimAngle_;
+        
+        gameState_.applyInput(localPlayer, command);
+        prediction_.record(command);
+        
+        // Each packet carries this command and the ones just before it
+        if (recentInputCount_ == INPUT_REDUNDANCY) {
+            for (size_t i = 1; i < INPUT_REDUNDANCY; i++) {
+                recentInputs_[i - 1] = recentInputs_[i];
+            }
+            recentInputCount_--;
+        }
+        recentInputs_[recentInputCount_++] = command;
+        InputCommand::encodeBatch(recentInputs_, recentInputCount_, inputPacket_);
         
-        // Always send movement and angle to server for multiplayer sync
         NetworkMessage moveMessage;
         moveMessage.type = MessageType::PLAYER_MOVE;
         moveMessage.playerId = playerId_;
-        
-        std::ostringstream oss;
-        if (IsKeyDown(KEY_A) || IsKeyDown(KEY_D) || IsKeyDown(KEY_W) || IsKeyDown(KEY_S)) {
-            // Send movement with angle
-            if (IsKeyDown(KEY_A)) oss << "LEFT,";
-            if (IsKeyDown(KEY_D)) oss << "RIGHT,";
-            if (IsKeyDown(KEY_W)) oss << "UP,";
-            if (IsKeyDown(KEY_S)) oss << "DOWN,";
-        } else {
-            oss << "STOP,";
+        moveMessage.data = inputPacket_;
+        sendUnreliable(moveMessage);
+    }
+    
+    // Snapshots overwrite the local player with the server's (older) position;
+    // replay the inputs the server hasn't seen yet to bring it back to the present
+    void reconcileLocalPlayer(float predictedX, float predictedY) {
+        Player* localPlayer = gameState_.getPlayer(playerId_);
+        if (!localPlayer || !localPlayer->isAlive()) {
+            prediction_.clear();
+            return;
         }
-        // Append angle to movement data
-        oss << "ANGLE:" << angle;
-        moveMessage.data = oss.str();
         
-        networkManager_.sendMessage(moveMessage, networkManager_.getServerAddress());
+        prediction_.reconcile(gameState_, *localPlayer, localPlayer->getLastInputSequence(),
+                              predictedX, predictedY, timestep_.getStepSeconds());
+    }
+    
+    bool applyBinarySnapshot(const std::string& data) {
+        // Deltas that reference a baseline we no longer have are dropped;
+        // the server falls back to a full snapshot once our ack ages out
+        if (!SnapshotCodec::decode(data, snapshot_, &snapshotHistory_)) return false;
+        
+        // Ignore snapshots that arrive out of order
+        if (snapshot_.tick <= latestSnapshotTick_) return false;
+        latestSnapshotTick_ = snapshot_.tick;
+        
+        snapshotHistory_.store(snapshot_);
+        gameState_.applySnapshot(snapshot_);
+        
+        // Tell the server which baseline it can delta against
+        NetworkMessage ackMessage;
+        ackMessage.type = MessageType::SNAPSHOT_ACK;
+        ackMessage.playerId = playerId_;
+        ackMessage.data = std::to_string(snapshot_.tick);
+        sendUnreliable(ackMessage);
+        return true;
+    }
+    
+    // Events that must arrive go through the reliable channel; update() resends them
+    void sendReliable(const NetworkMessage& message) {
+        NetworkMessage envelope;
+        if (reliable_.send(message, ReliableChannel::Clock::now(), envelope)) {
+            networkManager_.sendMessage(envelope, networkManager_.getServerAddress());
+        }
+    }
+    
+    // Streams that are replaced by newer data anyway; they carry any acks we owe
+    void sendUnreliable(NetworkMessage& message) {
+        reliable_.wrapUnreliable(message);
+        networkManager_.sendMessage(message, networkManager_.getServerAddress());
+    }
+    
+    void flushReliable() {
+        reliableMessages_.clear();
+        reliable_.update(ReliableChannel::Clock::now(), reliableMessages_);
+        for (const NetworkMessage& message : reliableMessages_) {
+            networkManager_.sendMessage(message, networkManager_.getServerAddress());
+        }
     }
     
     void processNetworkMessages() {
@@ -274,23 +381,72 @@ private:
         sockaddr_in fromAddress;
         
         while (networkManager_.receiveMessage(message, fromAddress)) {
-            switch (message.type) {
-                case MessageType::GAME_STATE_UPDATE:
-                    // Update game state from server
+            if (message.type != MessageType::RELIABLE) {
+                handleMessage(message);
+                continue;
+            }
+            
+            reliableMessages_.clear();
+            reliable_.receive(message, ReliableChannel::Clock::now(), reliableMessages_);
+            for (const NetworkMessage& delivered : reliableMessages_) {
+                handleMessage(delivered);
+            }
+        }
+    }
+    
+    void handleMessage(const NetworkMessage& message) {
+        switch (message.type) {
+            case MessageType::GAME_STATE_UPDATE: {
+                Player* localPlayer = gameState_.getPlayer(playerId_);
+                float predictedX = localPlayer ? localPlayer->getX() : 0;
+                float predictedY = localPlayer ? localPlayer->getY() : 0;
+                
+                // Update game state from server (either wire format is accepted)
+                if (SnapshotCodec::isBinary(message.data)) {
+                    if (!applyBinarySnapshot(message.data)) break;
+                } else {
                     gameState_.deserialize(message.data);
-                    break;
+                }
+                
+                reconcileLocalPlayer(predictedX, predictedY);
+                
+                // Remote entities are drawn slightly in the past, between received states
+                interpolator_.addSnapshot(gameState_, gameState_.getTick() * timestep_.getStepSeconds(), playerId_);
+                break;
+            }
+                
+            case MessageType::PLAYER_JOIN:
+                if (playerId_ == -1) {
+                    // This is our player ID assignment
+                    playerId_ = message.playerId;
+                    reliable_.setPlayerId(playerId_);
+                    std::cout << "Assigned player ID: " << playerId_ << std::endl;
                     
-                case MessageType::PLAYER_JOIN:
-                    if (playerId_ == -1) {
-                        // This is our player ID assignment
-                        playerId_ = message.playerId;
-                        std::cout << "Assigned player ID: " << playerId_ << std::endl;
+                    // The join reply carries the server's simulation tick rate and room name
+                    size_t separator = message.data.find('|');
+                    if (separator != std::string::npos) {
+                        std::cout << "Joined room: " << message.data.substr(separator + 1) << std::endl;
                     }
-                    break;
-                    
-                default:
-                    break;
+                    int tickRate = std::atoi(message.data.c_str());
+                    if (tickRate > 0) {
+                        timestep_.setTickRate(tickRate);
+                        timestep_.reset();
+                    }
+                }
+                break;
+                
+            case MessageType::PING: {
+                // The server measures our round trip and times us out if we go quiet
+                NetworkMessage pong;
+                pong.type = MessageType::PONG;
+                pong.playerId = playerId_;
+                pong.data = message.data;
+                sendUnreliable(pong);
+                break;
             }
+                
+            default:
+                break;
         }
     }
 };
@@ -298,6 +454,43 @@ private:
 int main(int argc, char* argv[]) {
     GameClient client;
     
+    // Optional: --interp-delay=ms (how far behind the newest snapshot remote entities are drawn),
+    // --room=NAME (join or create a named room instead of being auto-filled),
+    // --rate=BYTES_PER_SEC (ask the server to keep game state updates under this),
+    // --net-sim=SPEC (simulate a bad link for what we send, e.g. latency=80,jitter=10,loss=2)
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        const std::string roomFlag = "--room=";
+        if (arg.compare(0, roomFlag.size(), roomFlag) == 0) {
+            std::string room = arg.substr(roomFlag.size());
+            if (room.find('|') != std::string::npos) {
+                std::cerr << "Room names can't contain '|': " << room << std::endl;
+                return -1;
+            }
+            client.setRoom(room);
+            continue;
+        }
+        const std::string rateFlag = "--rate=";
+        if (arg.compare(0, rateFlag.size(), rateFlag) == 0) {
+            client.setRate(std::atoi(arg.c_str() + rateFlag.size()));
+            continue;
+        }
+        const std::string netSimFlag = "--net-sim=";
+        if (arg.compare(0, netSimFlag.size(), netSimFlag) == 0) {
+            LinkConditions conditions;
+            if (!LinkConditioner::parseConditions(arg.substr(netSimFlag.size()), conditions)) {
+                std::cerr << "Invalid link conditions: " << arg.substr(netSimFlag.size()) << std::endl;
+                return -1;
+            }
+            client.setLinkConditions(conditions);
+            continue;
+        }
+        const std::string delayFlag = "--interp-delay=";
+        if (arg.compare(0, delayFlag.size(), delayFlag) == 0) {
+            client.setInterpolationDelay(std::atoi(arg.c_str() + delayFlag.size()) / 1000.0f);
+        }
+    }
+    
     if (!client.initialize()) {
         return -1;
     }
@@ -0,0 +1,100 @@
+#pragma once
+#include "NetworkManager.h"
+#include "Snapshot.h"
+#include "SpscQueue.h"
+#include "InterestFilter.h"
+#include "FlatHashMap.h"
+#include "TickProfiler.h"
+#include <atomic>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+
+enum class BroadcastKind {
+    MESSAGE,         // Send message as-is to every recipient
+    BINARY_SNAPSHOT, // Delta-encode snapshot against each recipient's acked baseline
+    CLIENT_LEFT,     // Forget the recipients' filtered views; their ids may be reused
+    ROOM_CLOSED      // Forget the room's snapshot history; its index will be reused
+};
+
+struct SnapshotRecipient {
+    int playerId;
+    sockaddr_in address;
+    int ackedTick; // Last snapshot tick the client applied, -1 if none
+    int byteBudget; // Snapshot bytes for this client, 0 = unlimited (filtered snapshots only)
+};
+
+// Everything the send side needs, copied out of a room so the simulation can move
+// on while it's encoded and sent. A submitted job is never touched by the room again.
+struct BroadcastJob {
+    int roomIndex;
+    BroadcastKind kind;
+    WorldSnapshot snapshot;
+    bool interestFilter; // Send each recipient only what's around it
+    NetworkMessage message;
+    std::vector<SnapshotRecipient> recipients;
+};
+
+// Encodes and sends what the rooms of one worker publish. By default each job runs as
+// soon as it's submitted; after start() jobs go through a lock-free queue to a send
+// thread, so encoding and sendmmsg overlap the next tick instead of eating into it.
+// Finished jobs come back through a second queue and are reused, keeping their buffers.
+class BroadcastStage {
+public:
+    static const size_t QUEUE_CAPACITY = 256; // Jobs in flight before the producer waits
+    
+    explicit BroadcastStage(NetworkManager& network);
+    ~BroadcastStage();
+    
+    bool start(); // Linux only; returns false (and stays inline) elsewhere
+    void stop();
+    bool isThreaded() const { return thread_.joinable(); }
+    
+    // Producer side: fill the job returned by beginJob(), then submit() it
+    BroadcastJob& beginJob(int roomIndex, BroadcastKind kind);
+    void submit();
+    void sendMessage(int roomIndex, const NetworkMessage& message, const sockaddr_in& address);
+    
+    // Wakes the send thread if anything was submitted since the last call
+    void publish();
+    
+    // Time spent encoding and sending since the last call
+    double takeBusySeconds();
+    
+    // Section timings of the send thread, one sample per job (inline, jobs are
+    // timed by the caller's profiler instead)
+    TickProfiler& getProfiler() { return profiler_; }
+    
+private:
+    NetworkManager& network_;
+    SpscQueue<BroadcastJob*> pending_;  // Producer -> send thread
+    SpscQueue<BroadcastJob*> recycled_; // Send thread -> producer
+    std::vector<std::unique_ptr<BroadcastJob>> jobs_; // Owns every job handed out
+    BroadcastJob* current_;
+    bool unpublished_;
+    
+    std::thread thread_;
+    std::atomic<bool> running_;
+    int wakeFd_;
+    std::atomic<uint64_t> busyNanos_;
+    TickProfiler profiler_;
+    
+    // Per-client state for filtered snapshots; deltas are against what that client was
+    // sent. Kept until the room reports the client gone (CLIENT_LEFT).
+    struct ClientView {
+        InterestState interest;
+        SnapshotHistory history;
+    };
+    
+    // Send side only
+    FlatHashMap<int, SnapshotHistory> histories_; // Per room, for delta baselines
+    FlatHashMap<int, ClientView> views_; // Per player id
+    InterestFilter interest_;
+    std::map<int, std::vector<sockaddr_in>> clientsByBaseline_;
+    std::vector<sockaddr_in> addresses_;
+    
+    void run();
+    void process(BroadcastJob& job);
+    void sendFiltered(BroadcastJob& job);
+};
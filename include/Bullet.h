@@ -14,11 +14,13 @@ public:
     float getVelY() const { return velY_; }
     bool isActive() const { return active_; }
     int getDamage() const { return damage_; }
+    int getRewindTicks() const { return rewindTicks_; }
     
     // Setters
     void setPosition(float x, float y);
     void setVelocity(float velX, float velY);
     void setActive(bool active);
+    void setRewindTicks(int ticks) { rewindTicks_ = ticks; }
     
     // Game logic
     void update(float deltaTime);
@@ -34,4 +36,5 @@ private:
     int damage_;
     float lifeTime_;
     float maxLifeTime_;
+    int rewindTicks_; // How far in the past the shooter saw the targets (lag compensation)
 };
\ No newline at end of file
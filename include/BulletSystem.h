@@ -0,0 +1,81 @@
+#pragma once
+#include "Bullet.h"
+#include "SlotMap.h"
+#include "FlatHashMap.h"
+#include "CollisionMap.h"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Structure-of-arrays storage for every live bullet. Each field lives in its own
+// contiguous array, so the per-tick integrate pass streams through memory and runs
+// as SIMD (AVX2 when built with ENABLE_AVX2, SSE2 on x86-64, scalar elsewhere).
+// Bullets are addressed by index for iteration, and by slot handle or network id
+// otherwise; despawned slots are recycled, so steady-state firing doesn't allocate.
+class BulletSystem {
+public:
+    static constexpr float BULLET_SIZE = 4.0f;
+    static constexpr float MAX_LIFETIME = 5.0f;
+    
+    BulletSystem();
+    
+    // Returns an invalid handle if the id is already in use
+    SlotHandle add(int id, int ownerId, float x, float y, float velX, float velY, int rewindTicks = 0);
+    bool remove(int id);
+    bool remove(SlotHandle handle);
+    void clear();
+    void reserve(size_t capacity);
+    
+    // Move every bullet and age it, deactivating expired ones. The position before
+    // the move is kept so collisions can be swept along the whole step.
+    void integrate(float deltaTime);
+    
+    // Drop inactive and out-of-world bullets, keeping the rest in order
+    size_t removeInactive(float worldWidth, float worldHeight);
+    
+    size_t size() const { return ids_.size(); }
+    int indexOf(int id) const;
+    int indexOf(SlotHandle handle) const { return slots_.denseIndex(handle); }
+    SlotHandle handleAt(size_t i) const { return slots_.handleAt(i); }
+    
+    int getId(size_t i) const { return ids_[i]; }
+    int getOwnerId(size_t i) const { return ownerIds_[i]; }
+    float getX(size_t i) const { return x_[i]; }
+    float getY(size_t i) const { return y_[i]; }
+    float getPrevX(size_t i) const { return prevX_[i]; }
+    float getPrevY(size_t i) const { return prevY_[i]; }
+    float getVelX(size_t i) const { return velX_[i]; }
+    float getVelY(size_t i) const { return velY_[i]; }
+    bool isActive(size_t i) const { return active_[i] != 0; }
+    int getDamage(size_t i) const { return damage_[i]; }
+    int getRewindTicks(size_t i) const { return rewindTicks_[i]; }
+    
+    void setPosition(size_t i, float x, float y) { x_[i] = x; y_[i] = y; }
+    void setVelocity(size_t i, float velX, float velY) { velX_[i] = velX; velY_[i] = velY; }
+    void setActive(size_t i, bool active) { active_[i] = active ? 1 : 0; }
+    
+    // Same AABB test as Bullet::checkCollision
+    bool overlaps(size_t i, float x, float y, float width, float height) const;
+    
+    // Swept version of overlaps() over the last integrate step; hitTime is 0..1 along it
+    bool sweep(size_t i, float x, float y, float width, float height, float& hitTime) const;
+    
+    // Copy one bullet out as a standalone object (rendering, debugging)
+    Bullet toBullet(size_t i) const;
+    
+private:
+    std::vector<int> ids_;
+    std::vector<int> ownerIds_;
+    std::vector<float> x_, y_;
+    std::vector<float> prevX_, prevY_;
+    std::vector<float> velX_, velY_;
+    std::vector<float> lifeTime_;
+    std::vector<int> damage_;
+    std::vector<int> rewindTicks_;
+    std::vector<uint8_t> active_;
+    SlotIndex slots_;
+    FlatHashMap<int, SlotHandle> handleById_;
+    
+    void moveElement(size_t from, size_t to);
+    void resizeArrays(size_t size);
+};
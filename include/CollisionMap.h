@@ -0,0 +1,46 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+struct Obstacle {
+    float x, y, width, height;
+    Obstacle(float _x, float _y, float _w, float _h) : x(_x), y(_y), width(_w), height(_h) {}
+};
+
+// Static uniform grid over the world, baked once from the obstacle list.
+// Each cell stores the indices of the obstacles touching it in one flat array
+// (cellStart_[c] .. cellStart_[c + 1]), so a query only tests the few obstacles
+// near the rectangle instead of the whole map.
+class CollisionMap {
+public:
+    explicit CollisionMap(float cellSize = 64.0f);
+    
+    void build(const std::vector<Obstacle>& obstacles, float worldWidth, float worldHeight);
+    
+    // True if the rectangle overlaps any obstacle (same AABB test as before)
+    bool overlaps(float x, float y, float width, float height) const;
+    
+    // Swept test for a square of the given half size moving from (x0, y0) to (x1, y1).
+    // Reports the earliest time of impact along the move, from 0 to 1.
+    bool sweep(float x0, float y0, float x1, float y1, float halfSize, float& hitTime) const;
+    
+    // Segment from (x0, y0) along (dx, dy) against the open box [minX, maxX] x [minY, maxY]
+    static bool segmentHitsBox(float x0, float y0, float dx, float dy,
+                               float minX, float minY, float maxX, float maxY, float& hitTime);
+    
+    float getCellSize() const { return cellSize_; }
+    int getColumns() const { return columns_; }
+    int getRows() const { return rows_; }
+    
+private:
+    float cellSize_;
+    float inverseCellSize_;
+    int columns_;
+    int rows_;
+    std::vector<Obstacle> obstacles_;
+    std::vector<uint32_t> cellStart_;
+    std::vector<uint16_t> cellObstacles_;
+    
+    int cellColumn(float x) const;
+    int cellRow(float y) const;
+};
@@ -0,0 +1,56 @@
+#pragma once
+#include "NetworkManager.h"
+#include "FlatHashMap.h"
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Liveness and round-trip time of a room's clients. Anything heard from a client
+// keeps it alive; a client silent for longer than the timeout is reported so the
+// room can drop it instead of simulating and sending to a dead peer. Each client
+// is pinged every PING_INTERVAL and its PONG gives an RTT sample.
+class ConnectionManager {
+public:
+    typedef std::chrono::steady_clock Clock;
+    
+    static constexpr float PING_INTERVAL = 1.0f;
+    static const int PING_HISTORY = 4; // Outstanding pings matched against PONGs
+    
+    struct Connection {
+        Clock::time_point lastHeard;
+        Clock::time_point lastPing;
+        uint32_t nextPingId;
+        uint32_t pingIds[PING_HISTORY];
+        Clock::time_point pingTimes[PING_HISTORY];
+        bool hasRtt;
+        float rtt;      // Smoothed round trip, seconds
+        float jitter;   // Smoothed change between consecutive samples, seconds
+        float lastSample;
+    };
+    
+    explicit ConnectionManager(float timeoutSeconds = 10.0f) : timeoutSeconds_(timeoutSeconds) {}
+    
+    void setTimeout(float seconds) { timeoutSeconds_ = seconds; } // 0 = never time out
+    
+    // Ping ids count up from firstPingId and skip 0 when they wrap
+    void add(int playerId, Clock::time_point now, uint32_t firstPingId = 1);
+    void remove(int playerId) { connections_.erase(playerId); }
+    void heard(int playerId, Clock::time_point now);
+    
+    // Records the round trip of an echoed ping; false if it matches none still outstanding
+    bool handlePong(int playerId, const std::string& data, Clock::time_point now);
+    
+    // Appends the players that have gone silent for too long and the pings now due
+    void update(Clock::time_point now, std::vector<int>& timedOut, std::vector<NetworkMessage>& pings);
+    
+    const Connection* find(int playerId) const;
+    float getRtt(int playerId) const;    // 0 until the first PONG
+    float getJitter(int playerId) const;
+    
+    // Adds up the RTT of every measured connection, for load reports
+    void accumulateRtt(float& total, float& maximum, size_t& count) const;
+    
+private:
+    float timeoutSeconds_;
+    FlatHashMap<int, Connection> connections_;
+};
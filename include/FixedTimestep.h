@@ -0,0 +1,31 @@
+#pragma once
+
+// Accumulates real elapsed time and hands it out as whole fixed-size simulation steps,
+// so server and client integrate with the same deltaTime regardless of scheduling noise.
+class FixedTimestep {
+public:
+    static const int DEFAULT_TICK_RATE = 30;
+    static const int DEFAULT_MAX_CATCH_UP_STEPS = 5;
+    
+    explicit FixedTimestep(int tickRate = DEFAULT_TICK_RATE, int maxCatchUpSteps = DEFAULT_MAX_CATCH_UP_STEPS);
+    
+    // Adds elapsed time and returns how many steps to simulate now. If more than
+    // maxCatchUpSteps are owed, the excess is dropped rather than spiralling.
+    int advance(float elapsedSeconds);
+    void reset();
+    
+    void setTickRate(int tickRate);
+    int getTickRate() const { return tickRate_; }
+    float getStepSeconds() const { return stepSeconds_; }
+    
+    // Fraction of a step left in the accumulator, for blending between ticks
+    float getAlpha() const { return accumulator_ / stepSeconds_; }
+    int getDroppedSteps() const { return droppedSteps_; }
+    
+private:
+    int tickRate_;
+    float stepSeconds_;
+    float accumulator_;
+    int maxCatchUpSteps_;
+    int droppedSteps_;
+};
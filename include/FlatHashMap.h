@@ -0,0 +1,154 @@
+#pragma once
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+// Open-addressing hash map for integer ids (players, bullets, clients). Entries sit
+// in one flat array probed linearly, so a lookup is a hash plus a short scan over
+// adjacent memory instead of a tree walk. Erase uses backward shifting (no
+// tombstones) and clear() keeps the capacity, so steady-state churn doesn't allocate.
+// Iterators and pointers are invalidated by insert and erase.
+template <typename K, typename V>
+class FlatHashMap {
+    static_assert(std::is_integral<K>::value, "FlatHashMap keys must be integers");
+    
+public:
+    typedef std::pair<K, V> value_type;
+    
+    template <typename Map, typename Value>
+    class Iterator {
+    public:
+        Iterator(Map* map, size_t index) : map_(map), index_(index) { skipEmpty(); }
+        
+        Value& operator*() const { return map_->slots_[index_]; }
+        Value* operator->() const { return &map_->slots_[index_]; }
+        Iterator& operator++() { index_++; skipEmpty(); return *this; }
+        bool operator==(const Iterator& other) const { return index_ == other.index_; }
+        bool operator!=(const Iterator& other) const { return index_ != other.index_; }
+        
+    private:
+        Map* map_;
+        size_t index_;
+        
+        void skipEmpty() {
+            while (index_ < map_->occupied_.size() && !map_->occupied_[index_]) index_++;
+        }
+    };
+    
+    typedef Iterator<FlatHashMap, value_type> iterator;
+    typedef Iterator<const FlatHashMap, const value_type> const_iterator;
+    
+    FlatHashMap() : size_(0), mask_(0) {}
+    
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, occupied_.size()); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, occupied_.size()); }
+    
+    iterator find(K key) { return iterator(this, findIndex(key)); }
+    const_iterator find(K key) const { return const_iterator(this, findIndex(key)); }
+    bool contains(K key) const { return findIndex(key) != occupied_.size(); }
+    
+    V& operator[](K key) {
+        size_t index = findIndex(key);
+        if (index != occupied_.size()) return slots_[index].second;
+        
+        if ((size_ + 1) * 4 > occupied_.size() * 3) {
+            rehash(occupied_.empty() ? 16 : occupied_.size() * 2);
+        }
+        index = bucketFor(key);
+        while (occupied_[index]) index = (index + 1) & mask_;
+        
+        slots_[index].first = key;
+        occupied_[index] = 1;
+        size_++;
+        return slots_[index].second;
+    }
+    
+    bool erase(K key) {
+        size_t index = findIndex(key);
+        if (index == occupied_.size()) return false;
+        
+        // Shift later members of the probe chain back into the hole
+        size_t hole = index;
+        size_t next = hole;
+        for (;;) {
+            next = (next + 1) & mask_;
+            if (!occupied_[next]) break;
+            
+            size_t home = bucketFor(slots_[next].first);
+            if (((next - home) & mask_) >= ((next - hole) & mask_)) {
+                slots_[hole] = std::move(slots_[next]);
+                hole = next;
+            }
+        }
+        
+        slots_[hole].second = V(); // Release whatever the value held
+        occupied_[hole] = 0;
+        size_--;
+        return true;
+    }
+    
+    void erase(iterator it) { erase(it->first); }
+    
+    void clear() {
+        for (size_t i = 0; i < occupied_.size(); i++) {
+            if (occupied_[i]) {
+                slots_[i].second = V();
+                occupied_[i] = 0;
+            }
+        }
+        size_ = 0;
+    }
+    
+    void reserve(size_t count) {
+        size_t capacity = 16;
+        while (capacity * 3 < count * 4) capacity *= 2;
+        if (capacity > occupied_.size()) rehash(capacity);
+    }
+    
+private:
+    std::vector<value_type> slots_;
+    std::vector<uint8_t> occupied_;
+    size_t size_;
+    size_t mask_;
+    
+    size_t bucketFor(K key) const {
+        // Fibonacci hashing spreads sequential ids across the table
+        uint64_t h = static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(h >> 32) & mask_;
+    }
+    
+    size_t findIndex(K key) const {
+        if (size_ == 0) return occupied_.size();
+        
+        size_t index = bucketFor(key);
+        while (occupied_[index]) {
+            if (slots_[index].first == key) return index;
+            index = (index + 1) & mask_;
+        }
+        return occupied_.size();
+    }
+    
+    void rehash(size_t capacity) {
+        std::vector<value_type> oldSlots(capacity);
+        std::vector<uint8_t> oldOccupied(capacity, 0);
+        oldSlots.swap(slots_);
+        oldOccupied.swap(occupied_);
+        mask_ = capacity - 1;
+        
+        for (size_t i = 0; i < oldOccupied.size(); i++) {
+            if (!oldOccupied[i]) continue;
+            
+            size_t index = bucketFor(oldSlots[i].first);
+            while (occupied_[index]) index = (index + 1) & mask_;
+            slots_[index] = std::move(oldSlots[i]);
+            occupied_[index] = 1;
+        }
+    }
+};
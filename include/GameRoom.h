@@ -0,0 +1,114 @@
+#pragma once
+#include "GameState.h"
+#include "NetworkManager.h"
+#include "BroadcastStage.h"
+#include "SnapshotCodec.h"
+#include "FixedTimestep.h"
+#include "InputCommand.h"
+#include "FlatHashMap.h"
+#include "ReliableChannel.h"
+#include "ConnectionManager.h"
+#include <deque>
+#include <string>
+#include <vector>
+
+struct RoomSettings {
+    int tickRate = 30;
+    int snapshotRate = 0; // Snapshots per second, 0 = every tick
+    SnapshotFormat snapshotFormat = SnapshotFormat::BINARY;
+    int maxRewindMs = 200;
+    int maxPlayers = 16;
+    bool interestFilter = true; // Per-client snapshots of the area around each player (binary only)
+    int clientRate = 0; // Cap on snapshot bytes per second per client, 0 = unlimited (needs interestFilter)
+    int clientTimeoutMs = 10000; // Clients silent this long are dropped, 0 = never
+    int maxRooms = 1024; // Rooms open at once; joins past that are auto-filled or dropped
+    int emptyRoomSeconds = 30; // Empty rooms close after this long
+};
+
+struct ClientConnection {
+    sockaddr_in address;
+    int ackedTick; // Last snapshot tick the client applied, -1 if none
+    std::deque<InputCommand> inputs; // Received but not yet simulated
+    uint32_t lastQueuedInput;
+    int byteBudget; // Snapshot bytes per broadcast, 0 = unlimited
+    bool reliable; // Joined through a RELIABLE envelope, so replies go through the channel
+    ReliableChannel channel;
+};
+
+// One independent match: its own world, clients, tick and snapshot history.
+// A room is only ever touched by the worker thread that owns it, so it doesn't lock.
+class GameRoom {
+public:
+    // Player ids carry their room index above these bits, so any worker can route
+    // a message to the right room without a shared lookup
+    static const int PLAYER_ID_BITS = 16;
+    static int roomOfPlayer(int playerId) { return playerId >> PLAYER_ID_BITS; }
+    
+    GameRoom(int index, const std::string& name, const RoomSettings& settings);
+    
+    int getIndex() const { return index_; }
+    const std::string& getName() const { return name_; }
+    size_t getPlayerCount() const { return clients_.size(); }
+    const GameState& getGameState() const { return gameState_; }
+    const ConnectionManager& getConnections() const { return connections_; }
+    
+    // Replies and snapshots go out through the owning worker's send stage
+    void setOutput(BroadcastStage* output) { output_ = output; }
+    
+    // Join data is "name", "name|room" or "name|room|rate" (rate: the most snapshot
+    // bytes per second the client wants; an empty room means auto-fill). Names are cut
+    // to MAX_NAME_LENGTH and rates capped at MAX_CLIENT_RATE; returns false for a
+    // malformed join, which is dropped.
+    static const int MAX_NAME_LENGTH = 31; // Player and room names
+    static const int MAX_CLIENT_RATE = 1000000; // Bytes per second
+    static bool parseJoin(const std::string& data, std::string& name, std::string& room, int& rate);
+    
+    // The PLAYER_JOIN inside a join message: either the message itself or, for
+    // clients using the reliable channel, the envelope around it
+    static bool unwrapJoin(const NetworkMessage& message, NetworkMessage& join);
+    
+    // Adds the player and replies with its id; returns the id. A join resent from
+    // an address that already has a player just gets that player's id again.
+    int join(const NetworkMessage& message, const sockaddr_in& address);
+    void handleMessage(const NetworkMessage& message);
+    
+    // Moves out the addresses (NetworkManager::addressKey) of players that left or
+    // timed out since the last call, so their places can be given back
+    void takeDeparted(std::vector<uint64_t>& addressKeys);
+    
+    // Advances the simulation in fixed steps and broadcasts when a snapshot is due.
+    // Returns the number of steps run.
+    int tick(float elapsedSeconds);
+    
+private:
+    int index_;
+    std::string name_;
+    RoomSettings settings_;
+    BroadcastStage* output_;
+    
+    GameState gameState_;
+    FlatHashMap<int, ClientConnection> clients_;
+    FlatHashMap<uint64_t, int> playersByAddress_; // NetworkManager::addressKey -> player id
+    ConnectionManager connections_;
+    std::vector<uint64_t> departed_;
+    int nextLocalId_;
+    int nextBulletId_;
+    FixedTimestep timestep_;
+    int ticksSinceBroadcast_;
+    std::vector<InputCommand> decodedInputs_; // Scratch for PLAYER_MOVE
+    std::vector<NetworkMessage> delivered_;   // Scratch for reliable envelopes
+    std::vector<NetworkMessage> reliableOut_; // Resends and acks due this tick
+    std::vector<int> timedOut_;
+    std::vector<NetworkMessage> pings_;
+    
+    int allocatePlayerId();
+    int broadcastInterval() const;
+    void sendAssignment(ClientConnection& connection, int playerId);
+    void sendToClient(ClientConnection& connection, const NetworkMessage& message);
+    void handleReliable(const NetworkMessage& envelope);
+    void removeClient(int playerId, const char* reason);
+    void checkConnections();
+    void flushReliable();
+    void applyQueuedInputs();
+    void broadcastGameState();
+};
@@ -1,15 +1,15 @@
 #pragma once
 #include "Player.h"
-#include "Bullet.h"
+#include "BulletSystem.h"
+#include "Snapshot.h"
+#include "InputCommand.h"
+#include "HitboxHistory.h"
+#include "CollisionMap.h"
+#include "SpatialHash.h"
+#include "FlatHashMap.h"
 #include <vector>
-#include <map>
 #include <string>
 
-struct Obstacle {
-    float x, y, width, height;
-    Obstacle(float _x, float _y, float _w, float _h) : x(_x), y(_y), width(_w), height(_h) {}
-};
-
 class GameState {
 public:
     GameState();
@@ -23,16 +23,32 @@ public:
     void respawnPlayer(int id);
     
     // Bullet management
-    void addBullet(int id, int ownerId, float x, float y, float angle, float speed);
+    void addBullet(int id, int ownerId, float x, float y, float angle, float speed, int rewindTicks = 0);
     void removeBullet(int id);
-    Bullet* getBullet(int id);
-    const std::vector<Bullet*>& getAllBullets() const { return bullets_; }
+    const std::vector<Bullet>& getAllBullets() const; // Copies of the active bullets
+    BulletSystem& getBullets() { return bullets_; }
+    const BulletSystem& getBullets() const { return bullets_; }
     
-    // Game logic
+    // Game logic (each update advances the simulation tick by one)
     void update(float deltaTime);
+    int getTick() const { return tick_; }
+    void setTick(int tick) { tick_ = tick; }
     void checkCollisions();
     void cleanupInactiveBullets();
     
+    // Per-player input and movement (shared by the server and client-side prediction)
+    void applyInput(Player* player, const InputCommand& command);
+    void simulatePlayerMovement(Player* player, float deltaTime);
+    
+    // Lag compensation: keep per-tick hitboxes so bullets can be tested against
+    // where targets were when the shooter fired (rewind capped at maxRewindTicks)
+    void setLagCompensation(bool enabled, int maxRewindTicks);
+    int getMaxRewindTicks() const { return lagCompensation_ ? maxRewindTicks_ : 0; }
+    
+    // Players from which bullet hits go through the spatial hash instead of the
+    // nested loop (default SPATIAL_HASH_MIN_PLAYERS); benchmarks pin either path
+    void setSpatialHashThreshold(size_t players) { spatialHashMinPlayers_ = players; }
+    
     // Game settings
     float getWorldWidth() const { return worldWidth_; }
     float getWorldHeight() const { return worldHeight_; }
@@ -46,22 +62,55 @@ public:
     std::string serialize() const;
     void deserialize(const std::string& data);
     
+    // Structured snapshots shared by all wire formats
+    void captureSnapshot(WorldSnapshot& snapshot) const;
+    void applySnapshot(const WorldSnapshot& snapshot, bool replaceBullets = true);
+    
 private:
+    // Players live in a pool; players_ is a pointer view into it that is refreshed
+    // whenever a player joins or leaves
+    SlotMap<Player> playerPool_;
     std::vector<Player*> players_;
-    std::vector<Bullet*> bullets_;
-    std::map<int, Player*> playerMap_;
-    std::map<int, Bullet*> bulletMap_;
+    FlatHashMap<int, SlotHandle> playerMap_;
+    BulletSystem bullets_;
+    mutable std::vector<Bullet> bulletView_;
     std::vector<Obstacle> obstacles_;
+    CollisionMap collisionMap_;
     
     float worldWidth_;
     float worldHeight_;
     int nextPlayerId_;
     int nextBulletId_;
+    int tick_;
+    
+    bool lagCompensation_;
+    int maxRewindTicks_;
+    HitboxHistory hitboxHistory_;
+    
+    // Bullet-vs-player broad phase. Below SPATIAL_HASH_MIN_PLAYERS live players the
+    // plain nested loop is cheaper than building the hash.
+    static const size_t SPATIAL_HASH_MIN_PLAYERS = 24;
+    size_t spatialHashMinPlayers_;
+    struct HitTarget {
+        Player* player;
+        float x, y;
+    };
+    struct TargetFrame {
+        int tick = -1;
+        std::vector<HitTarget> targets;
+        SpatialHash hash;
+    };
+    std::vector<TargetFrame> targetFrames_; // [0] current positions, [n] rewound n ticks
     
-    void checkPlayerBulletCollisions();
+    void checkBulletCollisions();
+    Player* findBulletTarget(size_t bullet, bool rewind, int historyTick, float maxTime);
+    Player* findBulletTarget(size_t bullet, const TargetFrame& frame, float maxTime) const;
+    const TargetFrame& buildTargetFrame(size_t rewindTicks, int historyTick);
     void checkPlayerBoundaries();
-    void checkBulletObstacleCollisions();
+    void movePlayer(Player* player, float deltaTime);
+    void clampPlayerToWorld(Player* player);
     void checkPlayerObstacleCollisions();
     void initializeObstacles();
     void findValidSpawnPosition(float& outX, float& outY) const;
+    void refreshPlayerList();
 };
\ No newline at end of file
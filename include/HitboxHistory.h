@@ -0,0 +1,37 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+
+class Player;
+
+struct HitboxEntry {
+    int playerId;
+    float x, y;
+    bool alive;
+};
+
+// Ring of per-tick player hitboxes used to rewind the world for lag compensation.
+// Storage is one flat array of capacity * stride entries, so recording a tick
+// doesn't allocate unless the player count outgrows the stride.
+class HitboxHistory {
+public:
+    explicit HitboxHistory(size_t capacity = 32, size_t initialStride = 64);
+    
+    void record(int tick, const std::vector<Player*>& players);
+    void clear();
+    
+    bool hasTick(int tick) const;
+    const HitboxEntry* find(int tick, int playerId) const;
+    const HitboxEntry* frame(int tick, size_t& count) const; // nullptr if not recorded
+    
+    size_t getCapacity() const { return capacity_; }
+    
+private:
+    size_t capacity_;
+    size_t stride_;
+    std::vector<HitboxEntry> entries_;
+    std::vector<int> frameTicks_;
+    std::vector<size_t> frameCounts_;
+    
+    void grow(size_t stride);
+};
@@ -0,0 +1,35 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// One tick worth of player input. Sequence numbers let the server report which
+// inputs it has applied so the client can replay the rest on top of its snapshot.
+struct InputCommand {
+    uint32_t sequence = 0;
+    bool left = false;
+    bool right = false;
+    bool up = false;
+    bool down = false;
+    float angle = 0;
+    
+    bool isMoving() const { return left || right || up || down; }
+    void getVelocity(float speed, float& velX, float& velY) const;
+    
+    // Text form used by PLAYER_MOVE: "SEQ:n,LEFT,RIGHT,UP,DOWN,ANGLE:value" or "SEQ:n,STOP,ANGLE:value"
+    std::string toText() const;
+    static bool fromText(const std::string& data, InputCommand& command);
+    
+    // Binary PLAYER_MOVE payload carrying the newest few commands, so a lost packet's
+    // input still arrives with the next one:
+    //   u8 magic, u8 count, varint newest sequence,
+    //   then newest first: u8 buttons (left|right<<1|up<<2|down<<3), u16 angle
+    // Sequences are consecutive, counting down from the newest.
+    static const uint8_t BATCH_MAGIC = 0xC1;
+    static const size_t MAX_BATCH = 8;
+    
+    // commands are oldest first, with consecutive sequence numbers
+    static void encodeBatch(const InputCommand* commands, size_t count, std::string& out);
+    static bool decodeBatch(const std::string& data, std::vector<InputCommand>& commands); // Oldest first
+    static bool isBatch(const std::string& data);
+};
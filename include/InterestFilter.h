@@ -0,0 +1,76 @@
+#pragma once
+#include "Snapshot.h"
+#include <vector>
+#include <cstdint>
+
+// What one client currently knows about the world: the entries of the last snapshot
+// built for it, plus how overdue each entry is for a refresh
+struct InterestState {
+    WorldSnapshot view;
+    std::vector<float> playerPriority; // Parallel to view.players
+    std::vector<float> bulletPriority; // Parallel to view.bullets
+};
+
+// Builds per-client snapshots. Players and bullets inside the viewer's screen
+// (plus a margin) are relevant; bullets outside it are left out. An entity that
+// isn't refreshed stays in the view with the values it was last sent with, so it
+// costs nothing in a delta, and accumulates priority for the next snapshot: faster
+// when it's relevant, the further the client's copy has drifted from the truth, and
+// when its velocity or health changed.
+//
+// Without a byte budget every relevant entity is refreshed and only the most
+// overdue few distant players are. With one, entities are refreshed in priority
+// order until the estimated snapshot size reaches the budget; the rest carry their
+// priority over, so starved entities win eventually.
+class InterestFilter {
+public:
+    static constexpr float VIEW_HALF_WIDTH = 400.0f;  // Client window is 800x600
+    static constexpr float VIEW_HALF_HEIGHT = 300.0f;
+    static constexpr float VIEW_MARGIN = 200.0f;      // Covers camera lead and fast movers
+    static const int DISTANT_UPDATES = 4;             // Distant players refreshed per snapshot (no budget)
+    
+    // Estimated delta cost of refreshing an entity, in bytes
+    static const int SNAPSHOT_HEADER_BYTES = 12;
+    static const int PLAYER_UPDATE_BYTES = 12;
+    static const int BULLET_UPDATE_BYTES = 8;
+    static const int NEW_BULLET_BYTES = 14;
+    static const int REMOVED_ENTITY_BYTES = 3;
+    
+    InterestFilter();
+    
+    void setView(float halfWidth, float halfHeight, float margin);
+    void setDistantUpdates(int perSnapshot) { distantUpdates_ = perSnapshot; }
+    
+    // Replaces state.view with the viewer's snapshot of full (players and bullets
+    // sorted by id, as captureSnapshot() leaves them). The viewer always gets its own
+    // player; if it isn't in full, everything is relevant. byteBudget 0 = unlimited.
+    void update(const WorldSnapshot& full, int viewerId, int byteBudget, InterestState& state);
+    
+private:
+    struct Candidate {
+        float priority;
+        int cost;
+        size_t index;  // Into next_.players or next_.bullets
+        size_t source; // Into full.players or full.bullets
+        bool bullet;
+        bool relevant; // On the viewer's screen, or new to it
+    };
+    
+    float halfWidth_;
+    float halfHeight_;
+    float margin_;
+    int distantUpdates_;
+    
+    // Scratch reused across calls
+    WorldSnapshot next_;
+    std::vector<float> nextPlayerPriority_;
+    std::vector<float> nextBulletPriority_;
+    std::vector<uint8_t> playerState_; // EntryState per entry of next_.players
+    std::vector<uint8_t> bulletState_;
+    std::vector<Candidate> candidates_;
+    
+    void selectAll(const WorldSnapshot& full);
+    void selectWithinBudget(const WorldSnapshot& full, int bytes);
+    void refresh(const Candidate& candidate, const WorldSnapshot& full);
+    void compact(InterestState& state);
+};
@@ -0,0 +1,85 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <netinet/in.h>
+
+// Impairments applied to outgoing datagrams, for testing on one machine
+struct LinkConditions {
+    int latencyMs = 0;          // One-way delay added to every datagram
+    int jitterMs = 0;           // Extra random delay, 0..jitterMs, without reordering
+    float lossPercent = 0;
+    float duplicatePercent = 0;
+    float reorderPercent = 0;   // Datagrams held back long enough for later ones to overtake them
+    int bandwidthKbps = 0;      // Link capacity, 0 = unlimited; excess queues, then drops
+    uint32_t seed = 1;          // Same seed and traffic, same drops and delays
+    
+    bool isActive() const {
+        return latencyMs > 0 || jitterMs > 0 || lossPercent > 0 || duplicatePercent > 0 ||
+               reorderPercent > 0 || bandwidthKbps > 0;
+    }
+};
+
+// Sits between NetworkManager and the socket and makes the link behave like a worse
+// one: datagrams are dropped, duplicated or delayed as configured and a background
+// thread sends each one when it is due. Only what this end sends is affected, so
+// condition both ends to impair both directions.
+class LinkConditioner {
+public:
+    typedef std::chrono::steady_clock Clock;
+    
+    static const int QUEUE_LIMIT_MS = 250; // Bandwidth backlog before datagrams are dropped
+    
+    // Spec is comma-separated key=value pairs, e.g. "latency=80,jitter=10,loss=2":
+    // latency, jitter (ms), loss, dup, reorder (percent), kbps, seed
+    static bool parseConditions(const std::string& spec, LinkConditions& conditions);
+    
+    LinkConditioner(int socket, const LinkConditions& conditions);
+    ~LinkConditioner(); // Datagrams still waiting are dropped
+    
+    // Thread-safe; the datagram is copied
+    void submit(const char* data, size_t length, const sockaddr_in& address);
+    
+    size_t getDropped() const;
+    size_t getDuplicated() const;
+    size_t getReordered() const;
+    
+private:
+    struct Delayed {
+        Clock::time_point due;
+        uint64_t order; // Keeps datagrams due at the same time in submission order
+        std::string data;
+        sockaddr_in address;
+        
+        bool operator>(const Delayed& other) const {
+            return due != other.due ? due > other.due : order > other.order;
+        }
+    };
+    
+    int socket_;
+    LinkConditions conditions_;
+    
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::priority_queue<Delayed, std::vector<Delayed>, std::greater<Delayed>> queue_;
+    std::mt19937 random_;
+    uint64_t nextOrder_;
+    Clock::time_point lastDue_;   // Jitter never lets a datagram overtake the previous one
+    Clock::time_point linkFreeAt_; // When the bandwidth-limited link finishes its backlog
+    bool stopping_;
+    size_t dropped_;
+    size_t duplicated_;
+    size_t reordered_;
+    std::thread thread_;
+    
+    bool chance(float percent);
+    Clock::duration randomDelay(int maxMs);
+    void schedule(const char* data, size_t length, const sockaddr_in& address, Clock::time_point due);
+    void run();
+};
@@ -1,7 +1,14 @@
 #pragma once
 #include <string>
+#include <vector>
+#include <cstdint>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
+#include "PacketFragmenter.h"
+#include "LinkConditioner.h"
+#include <memory>
+#include <atomic>
 
 enum class MessageType {
     PLAYER_JOIN,
@@ -11,7 +18,10 @@ enum class MessageType {
     PLAYER_RESPAWN,
     GAME_STATE_UPDATE,
     PING,
-    PONG
+    PONG,
+    SNAPSHOT_ACK, // Client -> server: tick of the last snapshot applied
+    RELIABLE,     // ReliableChannel envelope (sequenced message and/or acks)
+    SERVER_STATS  // Load query; the worker that receives it replies with its counters
 };
 
 struct NetworkMessage {
@@ -36,6 +46,7 @@ public:
     
     // Server specific
     bool bindToPort(int port);
+    bool setReusePort(bool enabled); // Call before bindToPort; lets several sockets share a port
     bool startListening();
     
     // Client specific  
@@ -43,9 +54,32 @@ public:
     void setServerAddress(const std::string& serverIP, int port);
     sockaddr_in getServerAddress() const { return serverAddr_; }
     
+    // Batched I/O: receive up to batchSize datagrams per syscall (recvmmsg) and
+    // flush queued sends with sendmmsg. Falls back to one call per datagram off Linux.
+    void setBatchedIO(bool enabled, size_t batchSize = 64);
+    bool isBatchedIO() const { return batchedIO_; }
+    void queueBroadcast(const NetworkMessage& message, const std::vector<sockaddr_in>& addresses);
+    bool flushQueued();
+    
+    // Testing: impair what this socket sends (latency, loss, reordering...). Call
+    // after initializeSocket; inactive conditions restore the direct path.
+    void setLinkConditions(const LinkConditions& conditions);
+    const LinkConditioner* getLinkConditioner() const { return conditioner_.get(); }
+    
+    // Syscall/traffic counters; safe to read while other threads send and receive
+    size_t getSendCalls() const { return sendCalls_; }
+    size_t getReceiveCalls() const { return receiveCalls_; }
+    size_t getDatagramsSent() const { return datagramsSent_; }
+    size_t getDatagramsReceived() const { return datagramsReceived_; }
+    size_t getBytesSent() const { return bytesSent_; }
+    size_t getBytesReceived() const { return bytesReceived_; }
+    void resetIOStats();
+    
     // Utility
     std::string getLastError() const { return lastError_; }
     bool isInitialized() const { return initialized_; }
+    int getSocketHandle() const { return socket_; } // For readiness polling (epoll/select)
+    static uint64_t addressKey(const sockaddr_in& address); // IPv4 address and port as one integer
     
 private:
     int socket_;
@@ -53,5 +87,43 @@ private:
     bool initialized_;
     std::string lastError_;
     
+    // Large messages are split into MTU-sized fragments and reassembled here
+    PacketFragmenter fragmenter_;
+    std::vector<char> receiveBuffer_;
+    std::vector<std::string> fragments_;
+    std::string reassembled_;
+    
+    // Batched receive ring: one fixed slot per datagram, refilled by a single recvmmsg
+    bool batchedIO_;
+    size_t batchSize_;
+    std::vector<char> batchBuffers_;
+    std::vector<sockaddr_in> batchAddresses_;
+    std::vector<size_t> batchLengths_;
+    size_t batchCount_;
+    size_t batchNext_;
+#ifdef __linux__
+    std::vector<mmsghdr> batchHeaders_;
+    std::vector<iovec> batchIovecs_;
+    std::vector<mmsghdr> sendHeaders_;
+    std::vector<iovec> sendIovecs_;
+#endif
+    
+    // Queued sends: each payload is serialized once and shared by its destinations
+    std::vector<std::string> queuedPayloads_;
+    std::vector<std::pair<size_t, sockaddr_in>> queuedSends_;
+    
+    std::unique_ptr<LinkConditioner> conditioner_;
+    
+    std::atomic<size_t> sendCalls_;
+    std::atomic<size_t> receiveCalls_;
+    std::atomic<size_t> datagramsSent_;
+    std::atomic<size_t> datagramsReceived_;
+    std::atomic<size_t> bytesSent_;
+    std::atomic<size_t> bytesReceived_;
+    
+    bool serializeDatagrams(const NetworkMessage& message, std::vector<std::string>& datagrams);
+    bool nextDatagram(const char*& data, size_t& length, sockaddr_in& fromAddress);
+    bool fillBatch();
+    bool sendDatagram(const std::string& datagram, const sockaddr_in& address);
     void setError(const std::string& error);
 };
\ No newline at end of file
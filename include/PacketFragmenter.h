@@ -0,0 +1,56 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <netinet/in.h>
+
+// Splits messages larger than one datagram into sequenced fragments and
+// reassembles them on the receiving side.
+//
+// Fragment datagram layout:
+//   u8 magic, u16 messageId, u8 fragmentIndex, u8 fragmentCount, payload
+// Regular (unfragmented) datagrams never start with the magic byte.
+class PacketFragmenter {
+public:
+    static const uint8_t FRAGMENT_MAGIC = 0xF7;
+    static const size_t MAX_DATAGRAM_PAYLOAD = 1200; // Stays below common path MTUs
+    static const size_t HEADER_SIZE = 5;
+    static const size_t MAX_FRAGMENTS = 255;
+    static const size_t MAX_PENDING_MESSAGES = 16;
+    
+    PacketFragmenter();
+    
+    // Sending: returns false if the message is too large even when fragmented
+    bool needsFragmentation(const std::string& data) const { return data.size() > MAX_DATAGRAM_PAYLOAD; }
+    bool split(const std::string& data, std::vector<std::string>& fragments);
+    
+    // Receiving: feed every fragment datagram in; returns true once a message is complete
+    static bool isFragment(const char* data, size_t length);
+    bool addFragment(const sockaddr_in& from, const char* data, size_t length, std::string& completeMessage);
+    
+    // Configuration
+    void setReassemblyTimeout(float seconds) { reassemblyTimeout_ = seconds; }
+    size_t getPendingCount() const { return pending_.size(); }
+    size_t getDroppedCount() const { return droppedMessages_; }
+    
+private:
+    struct PendingMessage {
+        uint32_t address;
+        uint16_t port;
+        uint16_t messageId;
+        uint8_t fragmentCount;
+        uint8_t receivedCount;
+        std::vector<std::string> fragments;
+        std::vector<bool> received;
+        std::chrono::steady_clock::time_point firstSeen;
+    };
+    
+    uint16_t nextMessageId_;
+    float reassemblyTimeout_;
+    std::vector<PendingMessage> pending_;
+    size_t droppedMessages_;
+    
+    void expireStale(std::chrono::steady_clock::time_point now);
+    void dropOlderFrom(uint32_t address, uint16_t port, uint16_t messageId);
+};
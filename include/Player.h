@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include <cstdint>
 
 class Player {
 public:
@@ -18,6 +19,8 @@ public:
     float getAngle() const { return angle_; }
     int getKills() const { return kills_; }
     int getDeaths() const { return deaths_; }
+    float getSpeed() const { return speed_; }
+    uint32_t getLastInputSequence() const { return lastInputSequence_; }
     
     // Setters
     void setPosition(float x, float y);
@@ -25,6 +28,7 @@ public:
     void setHealth(int health);
     void setAlive(bool alive);
     void setAngle(float angle);
+    void setLastInputSequence(uint32_t sequence) { lastInputSequence_ = sequence; }
     
     // Game logic
     void update(float deltaTime);
@@ -47,4 +51,5 @@ private:
     float speed_;
     int kills_;
     int deaths_;
+    uint32_t lastInputSequence_; // Last input command the server applied
 };
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+#include "InputCommand.h"
+#include <vector>
+#include <cstddef>
+
+class GameState;
+class Player;
+
+// Client-side history of inputs the server hasn't acknowledged yet.
+// On every snapshot the local player is reset to the authoritative position
+// and the pending inputs are replayed on top of it.
+class PredictionBuffer {
+public:
+    explicit PredictionBuffer(size_t capacity = 128);
+    
+    void record(const InputCommand& command);
+    void clear();
+    
+    // Drops inputs up to ackedSequence and replays the rest from the player's current
+    // (server) position. Returns the distance between the old prediction and the new one.
+    float reconcile(GameState& state, Player& player, uint32_t ackedSequence,
+                    float predictedX, float predictedY, float stepSeconds);
+    
+    size_t pendingCount() const { return count_; }
+    
+private:
+    std::vector<InputCommand> commands_;
+    size_t start_;
+    size_t count_;
+};
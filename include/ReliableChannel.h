@@ -0,0 +1,100 @@
+#pragma once
+#include "NetworkManager.h"
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+// Reliable, ordered delivery for the few messages that must arrive (join, leave,
+// respawn, shoot) over the same UDP socket as the unreliable snapshot and input
+// streams. One channel per peer on each side.
+//
+// Reliable messages travel inside a RELIABLE envelope with a 16-bit sequence number
+// and are resent until acknowledged. Every envelope also carries the first sequence
+// still missing from the peer (everything before it arrived) plus a 32-bit field of
+// the ones after it that are already buffered (selective acks), and unreliable
+// messages can be wrapped in an envelope just to carry those acks.
+// Only reliable messages wait for ordering; wrapped unreliable ones are delivered on
+// arrival, so a lost reliable message never holds up snapshots or input.
+//
+// Envelope data: u8 flags, [u16 sequence], [u16 ack, u32 ackBits], [inner message]
+class ReliableChannel {
+public:
+    typedef std::chrono::steady_clock Clock;
+    
+    static const size_t MAX_PENDING = 256;    // Unacknowledged messages kept for resending
+    static constexpr float INITIAL_RTO = 0.2f; // Resend timeout before any RTT sample
+    static constexpr float MIN_RTO = 0.05f;
+    static constexpr float MAX_RTO = 1.0f;
+    static constexpr float ACK_DELAY = 0.02f;  // How long an ack waits for traffic to ride on
+    
+    ReliableChannel();
+    
+    void reset();
+    void setPlayerId(int playerId) { playerId_ = playerId; } // Stamped on bare acks for routing
+    void setAckDelay(float seconds) { ackDelay_ = seconds; }    // 0 when nothing will carry acks anyway
+    
+    // Wraps message for reliable delivery; transmit envelope now (resends come from update())
+    bool send(const NetworkMessage& message, Clock::time_point now, NetworkMessage& envelope);
+    
+    // Piggybacks owed acks on an unreliable message, wrapping it in place. Does
+    // nothing (and returns false) when there is nothing to acknowledge.
+    bool wrapUnreliable(NetworkMessage& message);
+    
+    // Handles an envelope from the peer. Messages that are now deliverable are
+    // appended to delivered in order; returns false for malformed envelopes.
+    bool receive(const NetworkMessage& envelope, Clock::time_point now, std::vector<NetworkMessage>& delivered);
+    
+    // Appends resends that are due and, if an ack has waited too long, a bare ack
+    void update(Clock::time_point now, std::vector<NetworkMessage>& outgoing);
+    
+    // A bare ack for whatever has been received, e.g. just before the peer goes away
+    bool takeAck(NetworkMessage& envelope);
+    
+    // The inner message of an envelope, without touching any channel state
+    static bool peek(const NetworkMessage& envelope, NetworkMessage& inner);
+    
+    float getRtt() const { return smoothedRtt_; }
+    float getResendTimeout() const { return resendTimeout_; }
+    size_t getPendingCount() const { return pending_.size(); }
+    size_t getResendCount() const { return resends_; }
+    
+private:
+    struct Pending {
+        uint16_t sequence;
+        std::string payload; // Serialized inner message
+        int playerId;
+        Clock::time_point firstSent;
+        Clock::time_point lastSent;
+        int sends;
+    };
+    
+    // Sending
+    uint16_t nextSequence_;
+    std::deque<Pending> pending_;
+    float smoothedRtt_;
+    float rttVariance_;
+    float resendTimeout_;
+    bool hasRttSample_;
+    bool hasSkipped_;
+    uint16_t highestAcked_;      // Newest sequence acked ahead of a gap
+    size_t resends_;
+    
+    // Receiving
+    bool hasReceived_;
+    uint16_t nextDelivery_;      // Next sequence to hand out; everything before it arrived
+    uint32_t receivedBits_;      // Bit i: nextDelivery_ + 1 + i is buffered in outOfOrder_
+    std::map<uint16_t, NetworkMessage> outOfOrder_;
+    bool ackOwed_;
+    Clock::time_point ackOwedSince_;
+    float ackDelay_;
+    int playerId_;
+    
+    void buildEnvelope(uint8_t flags, uint16_t sequence, const std::string& payload, int playerId,
+                       NetworkMessage& envelope);
+    void advanceDelivery();
+    void processAck(uint16_t ack, uint32_t ackBits, Clock::time_point now);
+    void addRttSample(float seconds);
+};
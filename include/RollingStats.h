@@ -0,0 +1,23 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+
+// Keeps the most recent samples in a fixed ring and answers percentile queries over them.
+class RollingStats {
+public:
+    explicit RollingStats(size_t capacity = 1024);
+    
+    void add(float sample);
+    void clear();
+    
+    size_t count() const { return count_; }
+    float percentile(float p) const; // p in [0, 100]
+    float max() const;
+    float mean() const;
+    
+private:
+    std::vector<float> samples_;
+    size_t next_;
+    size_t count_;
+    mutable std::vector<float> scratch_;
+};
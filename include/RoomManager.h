@@ -0,0 +1,66 @@
+#pragma once
+#include "GameRoom.h"
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class ServerWorker;
+
+// Directory of rooms shared by all workers. Rooms are spread round-robin over the
+// workers (room index modulo worker count), so routing a message never needs the
+// lock; it is only taken on joins and leaves to place players and track occupancy.
+// Rooms that stay empty are closed and their indices handed to new rooms.
+class RoomManager {
+public:
+    typedef std::chrono::steady_clock Clock;
+    
+    // Player ids keep the room index above GameRoom::PLAYER_ID_BITS, below the sign bit
+    static const int MAX_ROOMS = 1 << (31 - GameRoom::PLAYER_ID_BITS);
+    
+    explicit RoomManager(const RoomSettings& settings);
+    
+    // Workers must all be registered before any of them start
+    void addWorker(ServerWorker* worker);
+    size_t getWorkerCount() const { return workers_.size(); }
+    ServerWorker* ownerOf(int roomIndex) const;
+    
+    // Picks the room for a joining player and reserves a place in it. A name joins
+    // (or creates) that room unless it is full; otherwise the fullest public room
+    // with space is used, and a new one is opened when all are full. A join resent
+    // from an address that already has a place goes back to the same room. Returns
+    // -1 when every room is full and no more may open (RoomSettings::maxRooms).
+    int placePlayer(const std::string& roomName, uint64_t addressKey);
+    void playerLeft(int roomIndex, uint64_t addressKey);
+    
+    // Called by the owning worker for a room it sees empty. True if the room has been
+    // empty for RoomSettings::emptyRoomSeconds with no join on its way; the index is
+    // then free and the worker must drop the room before it adopts another.
+    bool closeIfIdle(int roomIndex, Clock::time_point now);
+    
+    size_t getRoomCount() const;
+    
+private:
+    struct RoomInfo {
+        std::string name;
+        int players; // Including joins placed here but not yet handled by the room
+        bool autoFill;
+        bool open;
+        Clock::time_point emptySince;
+    };
+    
+    RoomSettings settings_;
+    std::vector<ServerWorker*> workers_;
+    
+    mutable std::mutex mutex_;
+    std::vector<RoomInfo> rooms_; // Indexed by room index
+    std::vector<int> freeIndices_; // Closed rooms, reused before rooms_ grows
+    size_t openRooms_;
+    std::map<std::string, int> roomsByName_;
+    std::unordered_map<uint64_t, int> placedAddresses_; // NetworkManager::addressKey -> room index
+    
+    bool canOpenRoom() const;
+    int createRoom(const std::string& name, bool autoFill);
+};
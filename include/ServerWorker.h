@@ -0,0 +1,129 @@
+#pragma once
+#include "GameRoom.h"
+#include "NetworkManager.h"
+#include "RollingStats.h"
+#include "BroadcastStage.h"
+#include "SpscQueue.h"
+#include "FlatHashMap.h"
+#include "TickProfiler.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class RoomManager;
+
+// A worker's counters as a SERVER_STATS reply carries them, all since it started;
+// the asker diffs two replies for rates
+struct WorkerStats {
+    int worker = 0;
+    int tickRate = 0;
+    uint64_t ticks = 0;
+    uint64_t overruns = 0;
+    uint64_t workMicros = 0;
+    int rooms = 0;
+    int players = 0;
+};
+
+// One server thread: its own socket (a SO_REUSEPORT shard of the game port), its
+// own tick timer and the rooms assigned to it. Datagrams for rooms owned by another
+// worker are forwarded through that worker's inbox.
+//
+// Pipelined, a worker spreads one tick over three threads: a receive thread decodes
+// datagrams into a lock-free queue, the simulation thread drains it and runs the
+// rooms, and the broadcast stage encodes and sends the snapshots they publish.
+class ServerWorker {
+public:
+    static const int STATS_REPORT_SECONDS = 10; // How often load and jitter are printed
+    static const size_t INBOUND_CAPACITY = 4096; // Decoded datagrams waiting for the next tick
+    
+    ServerWorker(int index, RoomManager& roomManager, int tickRate);
+    ~ServerWorker();
+    
+    bool initialize(int port, bool reusePort, bool batchedIO, size_t batchSize);
+    void setPipelined(bool enabled) { pipelined_ = enabled; } // Call before run()
+    void run(); // Blocks until stop()
+    void stop();
+    
+    // SERVER_STATS payload: "worker|tickRate|ticks|overruns|workMicros|rooms|players"
+    static std::string formatStats(const WorkerStats& stats);
+    static bool parseStats(const std::string& data, WorkerStats& stats);
+    
+    int getIndex() const { return index_; }
+    NetworkManager& getNetwork() { return network_; }
+    
+    // Thread-safe hand-offs from other workers
+    void adoptRoom(std::unique_ptr<GameRoom> room);
+    void post(const NetworkMessage& message, const sockaddr_in& fromAddress);
+    
+private:
+    struct InboundMessage {
+        NetworkMessage message;
+        sockaddr_in fromAddress;
+    };
+    
+    int index_;
+    RoomManager& roomManager_;
+    int tickRate_;
+    NetworkManager network_;
+    FlatHashMap<int, std::unique_ptr<GameRoom>> rooms_;
+    std::atomic<bool> running_;
+    
+    std::mutex inboxMutex_;
+    std::vector<InboundMessage> inbox_;
+    std::vector<InboundMessage> draining_;
+    std::vector<std::unique_ptr<GameRoom>> adoptedRooms_;
+    std::vector<uint64_t> departed_; // Scratch for releaseDeparted
+    std::vector<int> closedRooms_;   // Scratch for tickRooms
+    int wakeFd_; // eventfd that interrupts epoll_wait when the inbox fills
+    
+    // Pipeline stages
+    bool pipelined_;
+    BroadcastStage broadcast_;
+    SpscQueue<InboundMessage> inbound_; // Receive thread -> simulation thread
+    std::thread receiveThread_;
+    std::atomic<uint64_t> receiveNanos_;
+    std::atomic<uint64_t> droppedInbound_;
+    
+    // Load reporting
+    RollingStats tickJitter_;
+    double busySeconds_;
+    double simulateSeconds_;
+    int tickOverruns_;
+    int ticksSinceReport_;
+    uint64_t totalTicks_;     // Since start, for SERVER_STATS queries
+    uint64_t totalOverruns_;
+    double totalWorkSeconds_;
+    std::chrono::steady_clock::time_point reportStart_;
+    
+    // Profiling (--profile): section timings of this thread and of the receive thread
+    // (pipelined), and traffic counted at the last report
+    TickProfiler profiler_;
+    TickProfiler receiveProfiler_;
+    size_t reportedDatagramsIn_;
+    size_t reportedDatagramsOut_;
+    size_t reportedBytesIn_;
+    size_t reportedBytesOut_;
+    
+    bool runEventLoop();
+    void runPollingLoop();
+    bool startPipeline();
+    void stopPipeline();
+    void runReceiveLoop();
+    void processSocket();
+    void drainInbound();
+    void drainInbox();
+    void adoptPendingRooms();
+    void route(NetworkMessage& message, const sockaddr_in& fromAddress);
+    void deliverLocal(NetworkMessage& message, const sockaddr_in& fromAddress);
+    void handleLocal(const NetworkMessage& message, const sockaddr_in& fromAddress);
+    void tickRooms(float elapsedSeconds);
+    void releaseDeparted(GameRoom& room);
+    void replyStats(const sockaddr_in& address);
+    void recordTick(float deviationMicros, float workSeconds, int ticks);
+    void reportProfile(std::ostream& out, double wallSeconds, size_t players);
+    void pinToCore();
+};
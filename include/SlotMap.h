@@ -0,0 +1,115 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+
+// Stable reference to a pooled entity. The generation changes every time a slot
+// is reused, so a handle to a despawned entity never resolves to its successor.
+struct SlotHandle {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+    
+    bool isValid() const { return index != UINT32_MAX; }
+    bool operator==(const SlotHandle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const SlotHandle& other) const { return !(*this == other); }
+};
+
+// Bookkeeping half of a slot map: maps handles to positions in a dense array the
+// caller owns (one array for SlotMap<T>, several parallel ones for SoA storage).
+// Freed slots go on a free list, so steady-state spawn/despawn doesn't allocate.
+class SlotIndex {
+public:
+    SlotIndex();
+    
+    void reserve(size_t capacity);
+    void clear();
+    size_t size() const { return denseToSlot_.size(); }
+    
+    // Hands out a slot for a new element appended at dense position size()
+    SlotHandle acquire();
+    
+    // Swap-remove bookkeeping for the element at dense position i. Returns the dense
+    // position whose data must be moved into i before the caller pops its arrays
+    // (equal to i when it was the last element).
+    size_t eraseAt(size_t i);
+    
+    // Order-preserving variant for batch compaction: the element at 'from' now lives at 'to'
+    void release(size_t i);
+    void relocate(size_t from, size_t to);
+    void truncate(size_t size);
+    
+    int denseIndex(SlotHandle handle) const; // -1 if stale
+    SlotHandle handleAt(size_t i) const;
+    
+private:
+    struct Slot {
+        uint32_t denseIndex; // Next free slot while on the free list
+        uint32_t generation;
+    };
+    
+    std::vector<Slot> slots_;
+    std::vector<uint32_t> denseToSlot_;
+    uint32_t freeHead_;
+    
+    static const uint32_t NONE = UINT32_MAX;
+};
+
+// Pool of T stored contiguously for iteration, addressed through generation-checked
+// handles. Removal swaps the last element into the hole, so pointers into the pool
+// are only valid until the next emplace or erase.
+template <typename T>
+class SlotMap {
+public:
+    void reserve(size_t capacity) {
+        dense_.reserve(capacity);
+        index_.reserve(capacity);
+    }
+    
+    template <typename... Args>
+    SlotHandle emplace(Args&&... args) {
+        dense_.emplace_back(std::forward<Args>(args)...);
+        return index_.acquire();
+    }
+    
+    bool erase(SlotHandle handle) {
+        int i = index_.denseIndex(handle);
+        if (i < 0) return false;
+        
+        size_t last = index_.eraseAt(static_cast<size_t>(i));
+        if (last != static_cast<size_t>(i)) {
+            dense_[i] = std::move(dense_[last]);
+        }
+        dense_.pop_back();
+        return true;
+    }
+    
+    void clear() {
+        dense_.clear();
+        index_.clear();
+    }
+    
+    T* get(SlotHandle handle) {
+        int i = index_.denseIndex(handle);
+        return i >= 0 ? &dense_[i] : nullptr;
+    }
+    const T* get(SlotHandle handle) const {
+        int i = index_.denseIndex(handle);
+        return i >= 0 ? &dense_[i] : nullptr;
+    }
+    
+    size_t size() const { return dense_.size(); }
+    bool empty() const { return dense_.empty(); }
+    T& operator[](size_t i) { return dense_[i]; }
+    const T& operator[](size_t i) const { return dense_[i]; }
+    SlotHandle handleAt(size_t i) const { return index_.handleAt(i); }
+    
+    typename std::vector<T>::iterator begin() { return dense_.begin(); }
+    typename std::vector<T>::iterator end() { return dense_.end(); }
+    typename std::vector<T>::const_iterator begin() const { return dense_.begin(); }
+    typename std::vector<T>::const_iterator end() const { return dense_.end(); }
+    
+private:
+    std::vector<T> dense_;
+    SlotIndex index_;
+};
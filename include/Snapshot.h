@@ -0,0 +1,66 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+// Plain-data view of the world used by the network codecs.
+// GameState produces one with captureSnapshot() and consumes one with applySnapshot().
+
+struct PlayerSnapshot {
+    int id;
+    std::string name;
+    float x, y;
+    int health;
+    bool alive;
+    float angle;
+    uint32_t lastInputSequence; // Last input command applied by the server
+};
+
+struct BulletSnapshot {
+    int id;
+    int ownerId;
+    float x, y;
+    float velX, velY;
+};
+
+// Players and bullets are kept sorted by id so snapshots can be diffed with a merge
+struct WorldSnapshot {
+    int tick = 0;
+    std::vector<PlayerSnapshot> players;
+    std::vector<BulletSnapshot> bullets;
+    
+    void clear() {
+        tick = 0;
+        players.clear();
+        bullets.clear();
+    }
+};
+
+// Fixed-size ring of recent snapshots, looked up by tick.
+// The server keeps one to encode deltas, clients keep one to decode them.
+class SnapshotHistory {
+public:
+    explicit SnapshotHistory(size_t capacity = 32) : entries_(capacity), valid_(capacity, false) {}
+    
+    void store(const WorldSnapshot& snapshot) {
+        size_t slot = static_cast<size_t>(snapshot.tick) % entries_.size();
+        entries_[slot] = snapshot;
+        valid_[slot] = true;
+    }
+    
+    const WorldSnapshot* find(int tick) const {
+        if (tick < 0) return nullptr;
+        size_t slot = static_cast<size_t>(tick) % entries_.size();
+        if (!valid_[slot] || entries_[slot].tick != tick) return nullptr;
+        return &entries_[slot];
+    }
+    
+    void clear() {
+        std::fill(valid_.begin(), valid_.end(), false);
+    }
+    
+private:
+    std::vector<WorldSnapshot> entries_;
+    std::vector<bool> valid_;
+};
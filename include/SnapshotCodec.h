@@ -0,0 +1,52 @@
+#pragma once
+#include "Snapshot.h"
+#include <string>
+#include <cstdint>
+
+enum class SnapshotFormat {
+    TEXT,   // Legacy colon-delimited GameState::serialize() output
+    BINARY  // Versioned, quantized binary encoding
+};
+
+// Binary snapshot layout (version 3):
+//   u8 magic, u8 version, u8 kind (0 = full, 1 = delta), varint tick
+//   delta only: varint baselineTick
+//
+// Full snapshot:
+//   varint playerCount, then per player:
+//     varint id, varint nameLength, name bytes,
+//     i16 x, i16 y (fixed-point, 1/8 px), u16 angle, u8 health|alive<<7,
+//     varint lastInputSequence
+//   varint bulletCount, then per bullet:
+//     varint id, varint ownerId, i16 x, i16 y, i16 velX, i16 velY (1/8 units)
+//
+// Delta snapshot (against the baseline tick the client acknowledged):
+//   varint removedPlayerCount, varint ids
+//   varint changedPlayerCount, then per player: varint id, u8 field mask, masked fields
+//   varint removedBulletCount, varint ids
+//   varint changedBulletCount, then per bullet: varint id, u8 field mask, masked fields
+// Entities missing from the baseline are sent with every field bit set.
+// Multi-byte fixed fields are little-endian.
+class SnapshotCodec {
+public:
+    static const uint8_t MAGIC = 0xB5;
+    static const uint8_t VERSION = 3;
+    
+    static void encode(const WorldSnapshot& snapshot, std::string& out);
+    static void encodeDelta(const WorldSnapshot& baseline, const WorldSnapshot& snapshot, std::string& out);
+    
+    // Decodes full or delta snapshots; deltas need their baseline in history
+    static bool decode(const std::string& data, WorldSnapshot& snapshot,
+                       const SnapshotHistory* history = nullptr);
+    
+    // True if the payload starts with the binary snapshot header
+    static bool isBinary(const std::string& data);
+    
+    static bool parseFormat(const std::string& name, SnapshotFormat& format);
+    
+    // Quantization helpers (exposed so callers can compare values as they go on the wire)
+    static int16_t quantizePosition(float value);
+    static float dequantizePosition(int16_t value);
+    static uint16_t quantizeAngle(float angle);
+    static float dequantizeAngle(uint16_t value);
+};
@@ -0,0 +1,60 @@
+#pragma once
+#include <unordered_map>
+#include <cstddef>
+
+class GameState;
+
+// Client-side interpolation buffer for remote entities. Each snapshot's positions are
+// recorded against the server time they were taken at, and entities are drawn a fixed
+// delay behind the newest snapshot, blending between the two samples around that time.
+// If samples stop arriving the last motion is extrapolated briefly, then held.
+class SnapshotInterpolator {
+public:
+    SnapshotInterpolator();
+    
+    void setDelay(float seconds) { delay_ = seconds; }
+    float getDelay() const { return delay_; }
+    void setMaxExtrapolation(float seconds) { maxExtrapolation_ = seconds; }
+    float getRenderTime() const { return renderTime_; }
+    
+    // Record remote player and bullet positions right after a snapshot was applied
+    void addSnapshot(const GameState& state, float serverTime, int localPlayerId);
+    
+    // Advance the render clock and write interpolated positions into the state
+    void apply(GameState& state, float deltaTime, int localPlayerId);
+    
+    void clear();
+    
+private:
+    static const size_t SAMPLE_COUNT = 8;
+    
+    struct Sample {
+        float time;
+        float x, y;
+        float angle;
+    };
+    
+    // Small fixed ring of the most recent samples for one entity
+    struct Track {
+        Sample samples[SAMPLE_COUNT];
+        size_t start = 0;
+        size_t count = 0;
+        int lastSeenSnapshot = 0;
+        
+        void push(const Sample& sample);
+        const Sample& at(size_t index) const { return samples[(start + index) % SAMPLE_COUNT]; }
+    };
+    
+    std::unordered_map<int, Track> players_;
+    std::unordered_map<int, Track> bullets_;
+    
+    float delay_;
+    float maxExtrapolation_;
+    float renderTime_;
+    float latestServerTime_;
+    bool hasTime_;
+    int snapshotCount_;
+    
+    bool sample(const Track& track, float time, Sample& out) const;
+    void prune(std::unordered_map<int, Track>& tracks);
+};
@@ -0,0 +1,56 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+
+// Broad phase for moving objects: rectangles are hashed into the grid cells they
+// cover and the buckets are packed into one flat array on build(). Rebuilding
+// every tick reuses the same storage, so it doesn't allocate once warmed up.
+// Queries may report the same item twice or items from colliding cells, so
+// callers still do their exact overlap test.
+class SpatialHash {
+public:
+    explicit SpatialHash(float cellSize = 64.0f);
+    
+    void clear();
+    void insert(uint32_t item, float x, float y, float width, float height);
+    void build();
+    
+    size_t size() const { return staged_.size(); }
+    
+    template <typename Visitor>
+    void query(float x, float y, float width, float height, Visitor&& visit) const {
+        if (bucketStart_.size() < 2) return;
+        
+        int c0 = cellCoord(x), c1 = cellCoord(x + width);
+        int r0 = cellCoord(y), r1 = cellCoord(y + height);
+        for (int r = r0; r <= r1; r++) {
+            for (int c = c0; c <= c1; c++) {
+                size_t bucket = hashCell(c, r);
+                for (uint32_t i = bucketStart_[bucket]; i < bucketStart_[bucket + 1]; i++) {
+                    visit(entries_[i]);
+                }
+            }
+        }
+    }
+    
+private:
+    struct Staged {
+        uint32_t item;
+        int c0, r0, c1, r1;
+    };
+    
+    float cellSize_;
+    float inverseCellSize_;
+    size_t bucketMask_;
+    std::vector<Staged> staged_;
+    std::vector<uint32_t> bucketStart_;
+    std::vector<uint32_t> cursor_;
+    std::vector<uint32_t> entries_;
+    
+    int cellCoord(float v) const { return static_cast<int>(std::floor(v * inverseCellSize_)); }
+    size_t hashCell(int c, int r) const {
+        return ((static_cast<uint32_t>(c) * 73856093u) ^ (static_cast<uint32_t>(r) * 19349663u)) & bucketMask_;
+    }
+};
@@ -0,0 +1,60 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Bounded lock-free queue between exactly two threads: one calls push(), the other
+// pop(). Capacity is rounded up to a power of two and fixed at construction, so
+// neither side blocks or allocates. Each side caches the other's index and only
+// rereads the shared atomic when the cached value says the ring is full/empty.
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity) : head_(0), tail_(0), cachedHead_(0), cachedTail_(0) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        slots_.resize(size);
+        mask_ = size - 1;
+    }
+    
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+    
+    size_t capacity() const { return slots_.size(); }
+    
+    // Producer side; returns false when the queue is full
+    bool push(T value) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cachedHead_ > mask_) {
+            cachedHead_ = head_.load(std::memory_order_acquire);
+            if (tail - cachedHead_ > mask_) return false;
+        }
+        slots_[tail & mask_] = std::move(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+    
+    // Consumer side; returns false when the queue is empty
+    bool pop(T& value) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cachedTail_) {
+            cachedTail_ = tail_.load(std::memory_order_acquire);
+            if (head == cachedTail_) return false;
+        }
+        value = std::move(slots_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+    
+private:
+    std::vector<T> slots_;
+    size_t mask_;
+    
+    // Consumer and producer indices on separate cache lines so the two threads
+    // don't invalidate each other on every operation
+    alignas(64) std::atomic<size_t> head_;
+    alignas(64) std::atomic<size_t> tail_;
+    alignas(64) size_t cachedHead_; // Producer's copy of head_
+    alignas(64) size_t cachedTail_; // Consumer's copy of tail_
+};
@@ -0,0 +1,80 @@
+#pragma once
+#include "RollingStats.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+// Per-thread tick profiler. PROFILE_SCOPE("name") times the rest of the enclosing
+// block into the profiler installed on the calling thread; time a section spends
+// between two endTick() calls is one sample, and report() prints p50/p95/p99/max
+// per section over the samples since the last report.
+//
+// Built with ENABLE_PROFILING the scopes are compiled in but cost one relaxed load
+// and a branch until setEnabled(true); without it PROFILE_SCOPE expands to nothing.
+class TickProfiler {
+public:
+    static const int MAX_SECTIONS = 32;
+    static const size_t SAMPLE_CAPACITY = 1024; // Ticks kept per section between reports
+    
+    TickProfiler();
+    
+    // Section names are process-wide; returns -1 once MAX_SECTIONS are taken
+    static int registerSection(const char* name);
+    
+    static void setEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+    static bool isEnabled() { return enabled_.load(std::memory_order_relaxed); }
+    
+    // The profiler scopes on this thread record into, or null
+    static TickProfiler* current();
+    static void setCurrent(TickProfiler* profiler);
+    
+    void add(int section, uint64_t nanos);
+    void endTick(); // Turns the time recorded since the last call into one sample per section
+    
+    // One line per section with samples, in microseconds; clears them when done
+    void report(std::ostream& out, const char* prefix);
+    
+    class Scope {
+    public:
+        explicit Scope(int section)
+            : profiler_(isEnabled() && section >= 0 ? current() : nullptr), section_(section) {
+            if (profiler_) start_ = std::chrono::steady_clock::now();
+        }
+        ~Scope() {
+            if (profiler_) {
+                profiler_->add(section_, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start_).count());
+            }
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        
+    private:
+        TickProfiler* profiler_;
+        int section_;
+        std::chrono::steady_clock::time_point start_;
+    };
+    
+private:
+    static std::atomic<bool> enabled_;
+    
+    // Only the owning thread touches the running totals; samples are also read by report()
+    uint64_t tickNanos_[MAX_SECTIONS];
+    bool touched_[MAX_SECTIONS];
+    bool anyTouched_;
+    std::mutex samplesMutex_;
+    std::vector<RollingStats> samples_;
+};
+
+#ifdef ENABLE_PROFILING
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) \
+    static const int PROFILE_CONCAT(profileSection_, __LINE__) = TickProfiler::registerSection(name); \
+    TickProfiler::Scope PROFILE_CONCAT(profileScope_, __LINE__)(PROFILE_CONCAT(profileSection_, __LINE__))
+#else
+#define PROFILE_SCOPE(name)
+#endif
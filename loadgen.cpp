@@ -0,0 +1,486 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <cmath>
+#include <cstdlib>
+#include <poll.h>
+#include "NetworkManager.h"
+#include "ReliableChannel.h"
+#include "SnapshotCodec.h"
+#include "InputCommand.h"
+#include "RollingStats.h"
+#include "LinkConditioner.h"
+#include "ServerWorker.h"
+
+#define SERVER_PORT 8080
+#define INPUT_REDUNDANCY 3 // Commands per input packet, as the real client sends
+#define REPORT_SECONDS 5 // How often progress and server load are printed
+#define STATS_QUERY_SPACING 16 // Every Nth bot asks the server for load figures, to reach every worker
+#define LEAVE_LINGER_MS 300 // How long bots wait for their leaves to be acked at the end
+
+typedef std::chrono::steady_clock Clock;
+
+// Headless stand-in for hundreds of clients: each bot has its own socket and speaks
+// the same protocol as client.cpp (reliable join, batched input, snapshot acks,
+// PONGs), moves and shoots on a script, and measures the snapshots it gets back.
+class LoadGenerator {
+public:
+    struct Options {
+        std::string serverIP = "127.0.0.1";
+        int bots = 100;
+        int durationSeconds = 30;
+        int rampPerSecond = 50; // Bots joining per second
+        std::string room;       // Empty = auto-fill
+        int rate = 0;           // Requested snapshot bytes per second, 0 = no cap
+        float shotsPerSecond = 1.0f;
+        uint32_t seed = 1;
+        LinkConditions linkConditions;
+    };
+    
+    explicit LoadGenerator(const Options& options)
+        : options_(options), random_(options.seed), tickRate_(30), snapshotSizes_(65536),
+          snapshotIntervals_(65536), joinLatencies_(4096) {
+        bots_.reserve(options_.bots);
+    }
+    
+    bool run() {
+        Clock::time_point start = Clock::now();
+        Clock::time_point end = start + std::chrono::seconds(options_.durationSeconds);
+        Clock::time_point nextReport = start + std::chrono::seconds(REPORT_SECONDS);
+        reportStart_ = start;
+        
+        std::cout << "Load test: " << options_.bots << " bots against " << options_.serverIP << ":" << SERVER_PORT
+                  << " for " << options_.durationSeconds << " s" << std::endl;
+        
+        while (Clock::now() < end) {
+            // Ramp up so joins don't all land in the same tick
+            Clock::time_point now = Clock::now();
+            int due = static_cast<int>(std::chrono::duration<float>(now - start).count() * options_.rampPerSecond) + 1;
+            while (static_cast<int>(bots_.size()) < std::min(due, options_.bots)) {
+                if (!spawnBot()) return false;
+            }
+            
+            // Each bot steps on its own phase (set by when it joined), like real
+            // clients do; stepping them all at once floods the server's socket buffer
+            Clock::time_point nextStep = end;
+            for (const Bot& bot : bots_) {
+                nextStep = std::min(nextStep, bot.nextStep);
+            }
+            waitForTraffic(std::min(nextStep, now + std::chrono::milliseconds(10)));
+            
+            now = Clock::now();
+            std::chrono::microseconds stepPeriod(1000000 / tickRate_);
+            for (Bot& bot : bots_) {
+                if (now < bot.nextStep) continue;
+                stepBot(bot, now);
+                bot.nextStep += stepPeriod;
+                if (bot.nextStep < now) bot.nextStep = now + stepPeriod; // Fell behind; don't burst
+            }
+            
+            if (now >= nextReport) {
+                report(now, false);
+                queryServer();
+                nextReport += std::chrono::seconds(REPORT_SECONDS);
+            }
+        }
+        
+        leaveAll();
+        report(Clock::now(), true);
+        return true;
+    }
+
+private:
+    struct Bot {
+        int index;
+        std::unique_ptr<NetworkManager> network;
+        ReliableChannel reliable;
+        int playerId = -1;
+        Clock::time_point joinSent;
+        
+        WorldSnapshot snapshot;
+        SnapshotHistory history;
+        int latestTick = -1;
+        bool hasSnapshot = false;
+        Clock::time_point lastSnapshot;
+        float x = 0, y = 0;
+        bool alive = true;
+        
+        uint32_t inputSequence = 0;
+        InputCommand recentInputs[INPUT_REDUNDANCY];
+        size_t recentInputCount = 0;
+        InputCommand heading;
+        Clock::time_point nextStep, nextTurn, nextShot, nextRespawn;
+    };
+    
+    Options options_;
+    std::mt19937 random_;
+    int tickRate_; // Taken from the first join reply
+    std::vector<Bot> bots_;
+    std::vector<pollfd> pollFds_;
+    std::vector<NetworkMessage> scratch_;
+    std::string inputPacket_;
+    
+    // Measurements since the last report
+    Clock::time_point reportStart_;
+    size_t snapshots_ = 0, snapshotBytes_ = 0, undecodable_ = 0;
+    RollingStats snapshotSizes_;
+    RollingStats snapshotIntervals_; // ms between consecutive snapshots to the same bot
+    RollingStats joinLatencies_;     // ms from join to the reply, over the whole run
+    size_t totalSnapshots_ = 0, totalBytes_ = 0;
+    std::map<int, WorkerStats> workers_, reportedWorkers_;
+    
+    bool spawnBot() {
+        bots_.emplace_back();
+        Bot& bot = bots_.back();
+        bot.index = static_cast<int>(bots_.size()) - 1;
+        bot.network.reset(new NetworkManager());
+        if (!bot.network->initializeSocket()) {
+            std::cerr << "Bot " << bot.index << ": " << bot.network->getLastError() << std::endl;
+            return false;
+        }
+        bot.network->setServerAddress(options_.serverIP, SERVER_PORT);
+        LinkConditions conditions = options_.linkConditions;
+        conditions.seed += bot.index;
+        bot.network->setLinkConditions(conditions);
+        pollFds_.push_back(pollfd{bot.network->getSocketHandle(), POLLIN, 0});
+        
+        NetworkMessage join;
+        join.type = MessageType::PLAYER_JOIN;
+        join.playerId = 0;
+        join.data = "bot-" + std::to_string(bot.index) + "|" + options_.room + "|" + std::to_string(options_.rate);
+        bot.joinSent = Clock::now();
+        sendReliable(bot, join);
+        
+        bot.nextStep = bot.nextTurn = bot.nextShot = bot.nextRespawn = bot.joinSent;
+        return true;
+    }
+    
+    void waitForTraffic(Clock::time_point until) {
+        int timeoutMs = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(until - Clock::now()).count());
+        if (poll(pollFds_.data(), pollFds_.size(), std::max(timeoutMs, 0)) <= 0) return;
+        
+        for (size_t i = 0; i < pollFds_.size(); i++) {
+            if (pollFds_[i].revents & POLLIN) {
+                receive(bots_[i]);
+            }
+        }
+    }
+    
+    void receive(Bot& bot) {
+        NetworkMessage message;
+        sockaddr_in fromAddress;
+        while (bot.network->receiveMessage(message, fromAddress)) {
+            if (message.type != MessageType::RELIABLE) {
+                handleMessage(bot, message);
+                continue;
+            }
+            scratch_.clear();
+            bot.reliable.receive(message, Clock::now(), scratch_);
+            for (const NetworkMessage& delivered : scratch_) {
+                handleMessage(bot, delivered);
+            }
+        }
+    }
+    
+    void handleMessage(Bot& bot, const NetworkMessage& message) {
+        switch (message.type) {
+            case MessageType::PLAYER_JOIN:
+                if (bot.playerId == -1) {
+                    bot.playerId = message.playerId;
+                    bot.reliable.setPlayerId(bot.playerId);
+                    joinLatencies_.add(std::chrono::duration<float, std::milli>(Clock::now() - bot.joinSent).count());
+                    int tickRate = std::atoi(message.data.c_str());
+                    if (tickRate > 0) tickRate_ = tickRate;
+                }
+                break;
+            case MessageType::GAME_STATE_UPDATE:
+                handleSnapshot(bot, message.data);
+                break;
+            case MessageType::PING: {
+                NetworkMessage pong;
+                pong.type = MessageType::PONG;
+                pong.playerId = bot.playerId;
+                pong.data = message.data;
+                sendUnreliable(bot, pong);
+                break;
+            }
+            case MessageType::SERVER_STATS:
+                handleServerStats(message.data);
+                break;
+            default:
+                break;
+        }
+    }
+    
+    void handleSnapshot(Bot& bot, const std::string& data) {
+        Clock::time_point now = Clock::now();
+        snapshots_++;
+        snapshotBytes_ += data.size();
+        snapshotSizes_.add(static_cast<float>(data.size()));
+        if (bot.hasSnapshot) {
+            snapshotIntervals_.add(std::chrono::duration<float, std::milli>(now - bot.lastSnapshot).count());
+        }
+        bot.hasSnapshot = true;
+        bot.lastSnapshot = now;
+        
+        // Decoded like the client does, so deltas and acks exercise the same paths
+        if (!SnapshotCodec::decode(data, bot.snapshot, &bot.history)) {
+            undecodable_++;
+            return;
+        }
+        if (bot.snapshot.tick <= bot.latestTick) return;
+        bot.latestTick = bot.snapshot.tick;
+        bot.history.store(bot.snapshot);
+        
+        for (const PlayerSnapshot& player : bot.snapshot.players) {
+            if (player.id != bot.playerId) continue;
+            bot.x = player.x;
+            bot.y = player.y;
+            bot.alive = player.alive;
+        }
+        
+        NetworkMessage ack;
+        ack.type = MessageType::SNAPSHOT_ACK;
+        ack.playerId = bot.playerId;
+        ack.data = std::to_string(bot.snapshot.tick);
+        sendUnreliable(bot, ack);
+    }
+    
+    void handleServerStats(const std::string& data) {
+        WorkerStats stats;
+        if (ServerWorker::parseStats(data, stats)) {
+            workers_[stats.worker] = stats;
+        }
+    }
+    
+    // One input per server tick, plus scripted shooting and respawning
+    void stepBot(Bot& bot, Clock::time_point now) {
+        scratch_.clear();
+        bot.reliable.update(now, scratch_);
+        for (const NetworkMessage& message : scratch_) {
+            bot.network->sendMessage(message, bot.network->getServerAddress());
+        }
+        if (bot.playerId == -1) return;
+        
+        if (!bot.alive) {
+            if (now >= bot.nextRespawn) {
+                NetworkMessage respawn;
+                respawn.type = MessageType::PLAYER_RESPAWN;
+                respawn.playerId = bot.playerId;
+                sendReliable(bot, respawn);
+                bot.nextRespawn = now + std::chrono::seconds(1);
+            }
+            return;
+        }
+        
+        // Wander: a random direction held for 0.5-2 s, aim sweeping round
+        if (now >= bot.nextTurn) {
+            int buttons = std::uniform_int_distribution<int>(0, 15)(random_);
+            bot.heading.left = buttons & 1;
+            bot.heading.right = buttons & 2;
+            bot.heading.up = buttons & 4;
+            bot.heading.down = buttons & 8;
+            bot.nextTurn = now + std::chrono::milliseconds(std::uniform_int_distribution<int>(500, 2000)(random_));
+        }
+        bot.heading.angle = std::fmod(bot.heading.angle + 0.05f, 6.2831853f);
+        
+        InputCommand command = bot.heading;
+        command.sequence = ++bot.inputSequence;
+        if (bot.recentInputCount == INPUT_REDUNDANCY) {
+            for (size_t i = 1; i < INPUT_REDUNDANCY; i++) {
+                bot.recentInputs[i - 1] = bot.recentInputs[i];
+            }
+            bot.recentInputCount--;
+        }
+        bot.recentInputs[bot.recentInputCount++] = command;
+        InputCommand::encodeBatch(bot.recentInputs, bot.recentInputCount, inputPacket_);
+        
+        NetworkMessage move;
+        move.type = MessageType::PLAYER_MOVE;
+        move.playerId = bot.playerId;
+        move.data = inputPacket_;
+        sendUnreliable(bot, move);
+        
+        if (options_.shotsPerSecond > 0 && now >= bot.nextShot) {
+            std::ostringstream oss;
+            oss << bot.x + 10 << "," << bot.y + 10 << "," << command.angle << "," << bot.latestTick;
+            NetworkMessage shoot;
+            shoot.type = MessageType::PLAYER_SHOOT;
+            shoot.playerId = bot.playerId;
+            shoot.data = oss.str();
+            sendReliable(bot, shoot);
+            
+            // Exponential gaps, so shots from different bots don't line up
+            float gap = std::exponential_distribution<float>(options_.shotsPerSecond)(random_);
+            bot.nextShot = now + std::chrono::microseconds(static_cast<int64_t>(gap * 1e6f));
+        }
+    }
+    
+    void sendReliable(Bot& bot, const NetworkMessage& message) {
+        NetworkMessage envelope;
+        if (bot.reliable.send(message, Clock::now(), envelope)) {
+            bot.network->sendMessage(envelope, bot.network->getServerAddress());
+        }
+    }
+    
+    void sendUnreliable(Bot& bot, NetworkMessage& message) {
+        bot.reliable.wrapUnreliable(message);
+        bot.network->sendMessage(message, bot.network->getServerAddress());
+    }
+    
+    void queryServer() {
+        NetworkMessage query;
+        query.type = MessageType::SERVER_STATS;
+        query.playerId = 0;
+        for (size_t i = 0; i < bots_.size(); i += STATS_QUERY_SPACING) {
+            bots_[i].network->sendMessage(query, bots_[i].network->getServerAddress());
+        }
+    }
+    
+    void report(Clock::time_point now, bool final) {
+        float seconds = std::chrono::duration<float>(now - reportStart_).count();
+        int joined = 0;
+        for (const Bot& bot : bots_) {
+            if (bot.playerId != -1) joined++;
+        }
+        totalSnapshots_ += snapshots_;
+        totalBytes_ += snapshotBytes_;
+        
+        std::ostringstream out;
+        out.setf(std::ios::fixed);
+        out.precision(1);
+        out << joined << "/" << bots_.size() << " bots joined";
+        if (joined > 0 && seconds >= 1) { // The final stretch can be just the leave
+            out << ", per bot " << snapshots_ / seconds / joined << " snapshots/s "
+                << snapshotBytes_ / seconds / joined / 1024 << " KB/s"
+                << ", size (B) avg=" << snapshotSizes_.mean() << " p99=" << snapshotSizes_.percentile(99)
+                << " max=" << snapshotSizes_.max()
+                << ", interval (ms) p50=" << snapshotIntervals_.percentile(50)
+                << " p99=" << snapshotIntervals_.percentile(99) << " max=" << snapshotIntervals_.max();
+        }
+        if (undecodable_ > 0) {
+            out << ", " << undecodable_ << " undecodable";
+        }
+        
+        // Server load between the last two replies from each worker
+        for (const auto& entry : workers_) {
+            const WorkerStats& current = entry.second;
+            const WorkerStats& previous = reportedWorkers_[entry.first];
+            uint64_t ticks = current.ticks - previous.ticks;
+            if (ticks == 0) continue;
+            double busy = 100.0 * (current.workMicros - previous.workMicros) / (ticks * 1e6 / tickRate_);
+            out << "\n  server worker " << entry.first << ": " << busy << "% busy, "
+                << current.overruns - previous.overruns << " tick overruns in " << ticks << " ticks, "
+                << current.rooms << " rooms, " << current.players << " players";
+        }
+        reportedWorkers_ = workers_;
+        
+        std::cout << out.str() << std::endl;
+        if (final) {
+            std::cout << "Total: " << totalSnapshots_ << " snapshots, " << totalBytes_ / 1024 << " KB, join latency (ms) p50="
+                      << joinLatencies_.percentile(50) << " p99=" << joinLatencies_.percentile(99)
+                      << " max=" << joinLatencies_.max() << std::endl;
+        }
+        
+        snapshots_ = 0;
+        snapshotBytes_ = 0;
+        undecodable_ = 0;
+        snapshotSizes_.clear();
+        snapshotIntervals_.clear();
+        reportStart_ = now;
+    }
+    
+    void leaveAll() {
+        for (Bot& bot : bots_) {
+            if (bot.playerId == -1) continue;
+            NetworkMessage leave;
+            leave.type = MessageType::PLAYER_LEAVE;
+            leave.playerId = bot.playerId;
+            sendReliable(bot, leave);
+        }
+        
+        // Resend lost leaves for a moment so the server isn't left with ghosts
+        Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(LEAVE_LINGER_MS);
+        while (Clock::now() < deadline) {
+            waitForTraffic(Clock::now() + std::chrono::milliseconds(10));
+            for (Bot& bot : bots_) {
+                scratch_.clear();
+                bot.reliable.update(Clock::now(), scratch_);
+                for (const NetworkMessage& message : scratch_) {
+                    bot.network->sendMessage(message, bot.network->getServerAddress());
+                }
+            }
+        }
+    }
+};
+
+int main(int argc, char* argv[]) {
+    LoadGenerator::Options options;
+    
+    // Optional: --server=IP, --bots=N, --duration=SECONDS, --ramp=BOTS_PER_SEC, --room=NAME,
+    // --rate=BYTES_PER_SEC, --shots=PER_SEC, --seed=N, --net-sim=SPEC
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        const std::string serverFlag = "--server=";
+        if (arg.compare(0, serverFlag.size(), serverFlag) == 0) {
+            options.serverIP = arg.substr(serverFlag.size());
+            continue;
+        }
+        const std::string botsFlag = "--bots=";
+        if (arg.compare(0, botsFlag.size(), botsFlag) == 0) {
+            options.bots = std::max(std::atoi(arg.c_str() + botsFlag.size()), 1);
+            continue;
+        }
+        const std::string durationFlag = "--duration=";
+        if (arg.compare(0, durationFlag.size(), durationFlag) == 0) {
+            options.durationSeconds = std::max(std::atoi(arg.c_str() + durationFlag.size()), 1);
+            continue;
+        }
+        const std::string rampFlag = "--ramp=";
+        if (arg.compare(0, rampFlag.size(), rampFlag) == 0) {
+            options.rampPerSecond = std::max(std::atoi(arg.c_str() + rampFlag.size()), 1);
+            continue;
+        }
+        const std::string roomFlag = "--room=";
+        if (arg.compare(0, roomFlag.size(), roomFlag) == 0) {
+            options.room = arg.substr(roomFlag.size());
+            if (options.room.find('|') != std::string::npos) {
+                std::cerr << "Room names can't contain '|': " << options.room << std::endl;
+                return -1;
+            }
+            continue;
+        }
+        const std::string rateFlag = "--rate=";
+        if (arg.compare(0, rateFlag.size(), rateFlag) == 0) {
+            options.rate = std::max(std::atoi(arg.c_str() + rateFlag.size()), 0);
+            continue;
+        }
+        const std::string shotsFlag = "--shots=";
+        if (arg.compare(0, shotsFlag.size(), shotsFlag) == 0) {
+            options.shotsPerSecond = static_cast<float>(std::atof(arg.c_str() + shotsFlag.size()));
+            continue;
+        }
+        const std::string seedFlag = "--seed=";
+        if (arg.compare(0, seedFlag.size(), seedFlag) == 0) {
+            options.seed = static_cast<uint32_t>(std::strtoul(arg.c_str() + seedFlag.size(), nullptr, 10));
+            options.linkConditions.seed = options.seed;
+            continue;
+        }
+        const std::string netSimFlag = "--net-sim=";
+        if (arg.compare(0, netSimFlag.size(), netSimFlag) == 0) {
+            if (!LinkConditioner::parseConditions(arg.substr(netSimFlag.size()), options.linkConditions)) {
+                std::cerr << "Invalid link conditions: " << arg.substr(netSimFlag.size()) << std::endl;
+                return -1;
+            }
+        }
+    }
+    
+    LoadGenerator generator(options);
+    return generator.run() ? 0 : -1;
+}
@@ -0,0 +1,72 @@
+#!/usr/bin/env bash
+# Multi-room load test: starts a server with WORKERS workers, fills ROOMS rooms of
+# ROOM_SIZE loadgen bots each and checks every worker's periodic report. Fails if a
+# worker reports more than MAX_OVERRUNS tick overruns in one report after ramp-up,
+# if a worker never reports, or if the rooms didn't all open.
+#
+# Usage: scripts/room_load_test.sh [build dir, default build]
+# Environment: WORKERS (default: cores), ROOMS (48), ROOM_SIZE (8), DURATION (35 s),
+#              MAX_OVERRUNS (3 per 10 s report), SERVER_ARGS (extra server flags)
+#
+# Run loadgen on another machine for numbers that matter: here the bots share the
+# cores with the workers they are measuring.
+set -euo pipefail
+
+BUILD_DIR=${1:-build}
+WORKERS=${WORKERS:-$(nproc)}
+ROOMS=${ROOMS:-48}
+ROOM_SIZE=${ROOM_SIZE:-8}
+DURATION=${DURATION:-35}
+MAX_OVERRUNS=${MAX_OVERRUNS:-3}
+BOTS=$((ROOMS * ROOM_SIZE))
+
+SERVER_LOG=$(mktemp)
+LOADGEN_LOG=$(mktemp)
+trap 'kill "$SERVER_PID" 2>/dev/null || true; rm -f "$SERVER_LOG" "$LOADGEN_LOG"' EXIT
+
+echo "$WORKERS workers, $ROOMS rooms x $ROOM_SIZE bots, ${DURATION}s"
+"$BUILD_DIR/server" --workers="$WORKERS" --room-size="$ROOM_SIZE" ${SERVER_ARGS:-} >"$SERVER_LOG" 2>&1 &
+SERVER_PID=$!
+sleep 1
+
+"$BUILD_DIR/loadgen" --server=127.0.0.1 --bots="$BOTS" --ramp=100 --duration="$DURATION" >"$LOADGEN_LOG" 2>&1
+kill "$SERVER_PID"
+wait "$SERVER_PID" 2>/dev/null || true
+
+# Worker lines look like "Worker 3: 12% busy, 6 rooms, 48 players, 0 tick overruns, ...".
+# The first report of each worker covers the ramp-up and is skipped.
+awk -v workers="$WORKERS" -v rooms="$ROOMS" -v maxOverruns="$MAX_OVERRUNS" '
+    /^Worker [0-9]+: [0-9]+% busy/ {
+        worker = $2 + 0
+        seen[worker]++
+        if (seen[worker] == 1) next
+        busy = $3 + 0
+        reports[worker]++
+        busyTotal[worker] += busy
+        overruns[worker] += $9
+        if ($9 > worstOverruns[worker]) worstOverruns[worker] = $9
+        lastRooms[worker] = $5
+        lastPlayers[worker] = $7
+    }
+    END {
+        failed = 0
+        totalRooms = 0
+        printf "worker  reports  avg busy  rooms  players  overruns  worst report\n"
+        for (w = 0; w < workers; w++) {
+            if (reports[w] == 0) {
+                printf "%6d  no report after ramp-up\n", w
+                failed = 1
+                continue
+            }
+            printf "%6d  %7d  %7d%%  %5d  %7d  %8d  %12d\n", w, reports[w], busyTotal[w] / reports[w],
+                   lastRooms[w], lastPlayers[w], overruns[w], worstOverruns[w]
+            totalRooms += lastRooms[w]
+            if (worstOverruns[w] > maxOverruns) failed = 1
+        }
+        if (totalRooms < rooms) {
+            printf "only %d of %d rooms open\n", totalRooms, rooms
+            failed = 1
+        }
+        print failed ? "FAIL" : "PASS"
+        exit failed
+    }' "$SERVER_LOG"
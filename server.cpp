@@ -1,197 +1,212 @@
+#include <algorithm>
 #include <iostream>
-#include <map>
-#include <chrono>
+#include <memory>
 #include <thread>
-#include <sstream>
+#include <vector>
 #include <cstdlib>
-#include "GameState.h"
-#include "NetworkManager.h"
+#include "GameRoom.h"
+#include "RoomManager.h"
+#include "ServerWorker.h"
 
 #define PORT 8080
-#define TICK_RATE 30 // 30 FPS server tick rate
+#define TICK_RATE 30 // Default simulation tick rate (override with --tick-rate)
+#define BATCH_SIZE 64 // Datagrams received per recvmmsg call
+#define MAX_REWIND_MS 200 // Lag compensation rewind cap (override with --max-rewind-ms)
+#define ROOM_SIZE 16 // Players per room before auto-fill opens another (override with --room-size)
+#define ROOM_LIMIT 1024 // Rooms open at once (override with --max-rooms)
 
+// Runs every room in the process. Each worker thread owns a socket bound to the game
+// port with SO_REUSEPORT (the kernel spreads clients across them) and ticks the rooms
+// assigned to it; a player whose datagrams land on another worker's socket is
+// forwarded to the room's owner.
 class GameServer {
 public:
-    GameServer() : running_(false), nextPlayerId_(1) {}
+    GameServer() : batchedIO_(true), pipelined_(false), workerCount_(0) {
+        settings_.tickRate = TICK_RATE;
+        settings_.maxRewindMs = MAX_REWIND_MS;
+        settings_.maxPlayers = ROOM_SIZE;
+        settings_.maxRooms = ROOM_LIMIT;
+    }
+    
+    RoomSettings& getSettings() { return settings_; }
+    void setBatchedIO(bool enabled) { batchedIO_ = enabled; }
+    void setPipelined(bool enabled) { pipelined_ = enabled; }
+    void setWorkerCount(int workerCount) { workerCount_ = workerCount; }
+    void setLinkConditions(const LinkConditions& conditions) { linkConditions_ = conditions; }
     
     bool initialize() {
-        if (!networkManager_.initializeSocket()) {
-            std::cerr << "Failed to initialize socket: " << networkManager_.getLastError() << std::endl;
-            return false;
+        int workerCount = workerCount_;
+        if (workerCount <= 0) {
+            workerCount = static_cast<int>(std::thread::hardware_concurrency());
+            if (workerCount <= 0) workerCount = 1;
         }
         
-        if (!networkManager_.bindToPort(PORT)) {
-            std::cerr << "Failed to bind to port: " << networkManager_.getLastError() << std::endl;
-            return false;
+        if (!startWorkers(workerCount)) {
+            if (workerCount == 1) return false;
+            
+            // No SO_REUSEPORT here: serve every room from one thread instead
+            std::cerr << "Could not shard the port, running a single worker" << std::endl;
+            if (!startWorkers(1)) return false;
         }
         
-        gameState_.setWorldSize(2000, 1500);
-        
-        std::cout << "Game server initialized on port " << PORT << std::endl;
+        int broadcastInterval = 1;
+        if (settings_.snapshotRate > 0 && settings_.snapshotRate < settings_.tickRate) {
+            broadcastInterval = (settings_.tickRate + settings_.snapshotRate - 1) / settings_.snapshotRate;
+        }
+        std::cout << "Game server initialized on port " << PORT
+                  << " (" << workers_.size() << " workers, " << settings_.maxPlayers << " players per room, "
+                  << settings_.tickRate << " Hz tick, " << settings_.tickRate / broadcastInterval << " Hz snapshots, "
+                  << (pipelined_ ? "pipelined, " : "")
+                  << (linkConditions_.isActive() ? "simulated link, " : "")
+                  << (settings_.snapshotFormat == SnapshotFormat::BINARY ? "binary" : "text") << " format)"
+                  << std::endl;
         return true;
     }
     
     void run() {
-        running_ = true;
-        
-        const float tickTime = 1.0f / TICK_RATE;
-        auto lastTick = std::chrono::high_resolution_clock::now();
+        // Worker 0 runs on the main thread
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < workers_.size(); i++) {
+            threads.emplace_back(&ServerWorker::run, workers_[i].get());
+        }
+        workers_[0]->run();
         
-        while (running_) {
-            auto currentTime = std::chrono::high_resolution_clock::now();
-            float deltaTime = std::chrono::duration<float>(currentTime - lastTick).count();
-            
-            if (deltaTime >= tickTime) {
-                processMessages();
-                gameState_.update(deltaTime);
-                broadcastGameState();
-                
-                lastTick = currentTime;
-            }
-            
-            // Small sleep to prevent 100% CPU usage
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        for (std::thread& thread : threads) {
+            thread.join();
         }
     }
     
     void stop() {
-        running_ = false;
+        for (auto& worker : workers_) {
+            worker->stop();
+        }
     }
     
 private:
-    GameState gameState_;
-    NetworkManager networkManager_;
-    std::map<int, sockaddr_in> clientAddresses_;
-    bool running_;
-    int nextPlayerId_;
+    RoomSettings settings_;
+    bool batchedIO_;
+    bool pipelined_; // Receive, simulate and broadcast on separate threads per worker
+    int workerCount_; // 0 = one per hardware thread
+    LinkConditions linkConditions_; // Applied to every worker's sends (testing only)
+    std::unique_ptr<RoomManager> roomManager_;
+    std::vector<std::unique_ptr<ServerWorker>> workers_;
     
-    void processMessages() {
-        NetworkMessage message;
-        sockaddr_in fromAddress;
+    bool startWorkers(int workerCount) {
+        workers_.clear();
+        roomManager_.reset(new RoomManager(settings_));
         
-        while (networkManager_.receiveMessage(message, fromAddress)) {
-            handleMessage(message, fromAddress);
-        }
-    }
-    
-    void handleMessage(const NetworkMessage& message, const sockaddr_in& fromAddress) {
-        switch (message.type) {
-            case MessageType::PLAYER_JOIN: {
-                int playerId = nextPlayerId_++;
-                gameState_.addPlayer(playerId, message.data);
-                clientAddresses_[playerId] = fromAddress;
-                
-                // Send player ID assignment back to the client
-                NetworkMessage assignMessage;
-                assignMessage.type = MessageType::PLAYER_JOIN;
-                assignMessage.playerId = playerId;
-                assignMessage.data = message.data; // player name
-                networkManager_.sendMessage(assignMessage, fromAddress);
-                
-                std::cout << "Player " << message.data << " joined (ID: " << playerId << ")" << std::endl;
-                std::cout << "Total players: " << clientAddresses_.size() << std::endl;
-                break;
-            }
-            case MessageType::PLAYER_MOVE: {
-                Player* player = gameState_.getPlayer(message.playerId);
-                if (player && player->isAlive()) {
-                    // Parse movement data: "LEFT,RIGHT,UP,DOWN,ANGLE:value" or "STOP,ANGLE:value"
-                    std::string moveData = message.data;
-                    float velX = 0, velY = 0;
-                    float moveSpeed = 200.0f;
-                    float angle = 0;
-                    
-                    // Extract angle if present
-                    size_t anglePos = moveData.find("ANGLE:");
-                    if (anglePos != std::string::npos) {
-                        std::string angleStr = moveData.substr(anglePos + 6); // Skip "ANGLE:"
-                        angle = std::stof(angleStr);
-                        player->setAngle(angle);
-                    }
-                    
-                    if (moveData.find("STOP") != std::string::npos) {
-                        // Player stopped moving
-                        velX = 0;
-                        velY = 0;
-                    } else {
-                        if (moveData.find("LEFT") != std::string::npos) {
-                            velX = -moveSpeed;
-                        }
-                        if (moveData.find("RIGHT") != std::string::npos) {
-                            velX = moveSpeed;
-                        }
-                        if (moveData.find("UP") != std::string::npos) {
-                            velY = -moveSpeed;
-                        }
-                        if (moveData.find("DOWN") != std::string::npos) {
-                            velY = moveSpeed;
-                        }
-                    }
-                    
-                    player->setVelocity(velX, velY);
-                }
-                break;
-            }
-            case MessageType::PLAYER_SHOOT: {
-                // Handle shooting - only if player is alive
-                Player* player = gameState_.getPlayer(message.playerId);
-                if (player && player->isAlive()) {
-                    // Parse shooting data
-                    // Format: "x,y,angle"
-                    std::istringstream iss(message.data);
-                    std::string token;
-                    float x, y, angle;
-                    
-                    std::getline(iss, token, ',');
-                    x = std::stof(token);
-                    std::getline(iss, token, ',');
-                    y = std::stof(token);
-                    std::getline(iss, token, ',');
-                    angle = std::stof(token);
-                    
-                    static int bulletIdCounter = 1;
-                    gameState_.addBullet(bulletIdCounter++, message.playerId, x, y, angle, 400.0f);
-                }
-                break;
+        for (int i = 0; i < workerCount; i++) {
+            std::unique_ptr<ServerWorker> worker(new ServerWorker(i, *roomManager_, settings_.tickRate));
+            if (!worker->initialize(PORT, workerCount > 1, batchedIO_, BATCH_SIZE)) {
+                workers_.clear();
+                return false;
             }
-            case MessageType::PLAYER_RESPAWN: {
-                // Handle player respawn request
-                Player* player = gameState_.getPlayer(message.playerId);
-                if (player && !player->isAlive()) {
-                    // Respawn at a random valid position (not overlapping obstacles)
-                    gameState_.respawnPlayer(message.playerId);
-                    std::cout << "Player " << message.playerId << " (" << player->getName() << ") respawned" << std::endl;
-                }
-                break;
-            }
-            case MessageType::PLAYER_LEAVE: {
-                gameState_.removePlayer(message.playerId);
-                clientAddresses_.erase(message.playerId);
-                std::cout << "Player " << message.playerId << " left" << std::endl;
-                std::cout << "Total players: " << clientAddresses_.size() << std::endl;
-                break;
-            }
-            default:
-                break;
+            worker->setPipelined(pipelined_);
+            
+            // Each socket gets its own sequence of drops and delays, repeatable per seed
+            LinkConditions conditions = linkConditions_;
+            conditions.seed += i;
+            worker->getNetwork().setLinkConditions(conditions);
+            roomManager_->addWorker(worker.get());
+            workers_.push_back(std::move(worker));
         }
+        return true;
     }
+};
+
+int main(int argc, char* argv[]) {
+    GameServer server;
+    RoomSettings& settings = server.getSettings();
     
-    void broadcastGameState() {
-        std::string gameStateData = gameState_.serialize();
-        NetworkMessage message;
-        message.type = MessageType::GAME_STATE_UPDATE;
-        message.data = gameStateData;
-        message.playerId = 0; // Server message
+    // Optional: --snapshot-format=binary|text, --tick-rate=N, --snapshot-rate=N, --no-batched-io,
+    // --max-rewind-ms=N, --workers=N, --room-size=N, --max-rooms=N, --pipeline, --no-interest-filter,
+    // --client-rate=BYTES_PER_SEC, --client-timeout-ms=N, --net-sim=SPEC, --profile
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        const std::string workersFlag = "--workers=";
+        if (arg.compare(0, workersFlag.size(), workersFlag) == 0) {
+            server.setWorkerCount(std::atoi(arg.c_str() + workersFlag.size()));
+            continue;
+        }
+        const std::string roomSizeFlag = "--room-size=";
+        if (arg.compare(0, roomSizeFlag.size(), roomSizeFlag) == 0) {
+            int roomSize = std::atoi(arg.c_str() + roomSizeFlag.size());
+            settings.maxPlayers = roomSize > 0 ? roomSize : ROOM_SIZE;
+            continue;
+        }
+        const std::string maxRoomsFlag = "--max-rooms=";
+        if (arg.compare(0, maxRoomsFlag.size(), maxRoomsFlag) == 0) {
+            int maxRooms = std::atoi(arg.c_str() + maxRoomsFlag.size());
+            settings.maxRooms = maxRooms > 0 ? std::min(maxRooms, static_cast<int>(RoomManager::MAX_ROOMS)) : ROOM_LIMIT;
+            continue;
+        }
+        const std::string maxRewindFlag = "--max-rewind-ms=";
+        if (arg.compare(0, maxRewindFlag.size(), maxRewindFlag) == 0) {
+            settings.maxRewindMs = std::atoi(arg.c_str() + maxRewindFlag.size());
+            continue;
+        }
+        const std::string snapshotRateFlag = "--snapshot-rate=";
+        if (arg.compare(0, snapshotRateFlag.size(), snapshotRateFlag) == 0) {
+            settings.snapshotRate = std::atoi(arg.c_str() + snapshotRateFlag.size());
+            continue;
+        }
+        const std::string tickRateFlag = "--tick-rate=";
+        if (arg.compare(0, tickRateFlag.size(), tickRateFlag) == 0) {
+            int tickRate = std::atoi(arg.c_str() + tickRateFlag.size());
+            settings.tickRate = tickRate > 0 ? tickRate : TICK_RATE;
+            continue;
+        }
+        const std::string clientRateFlag = "--client-rate=";
+        if (arg.compare(0, clientRateFlag.size(), clientRateFlag) == 0) {
+            settings.clientRate = std::atoi(arg.c_str() + clientRateFlag.size());
+            continue;
+        }
+        const std::string clientTimeoutFlag = "--client-timeout-ms=";
+        if (arg.compare(0, clientTimeoutFlag.size(), clientTimeoutFlag) == 0) {
+            settings.clientTimeoutMs = std::atoi(arg.c_str() + clientTimeoutFlag.size());
+            continue;
+        }
         
-        // Send to all connected clients
-        for (const auto& client : clientAddresses_) {
-            networkManager_.sendMessage(message, client.second);
+        if (arg == "--no-interest-filter") {
+            settings.interestFilter = false;
+            continue;
+        }
+        if (arg == "--pipeline") {
+            server.setPipelined(true);
+            continue;
+        }
+        if (arg == "--no-batched-io") {
+            server.setBatchedIO(false);
+            continue;
+        }
+        if (arg == "--profile") {
+#ifdef ENABLE_PROFILING
+            TickProfiler::setEnabled(true);
+#else
+            std::cerr << "Profiling is not compiled in (configure with -DENABLE_PROFILING=ON)" << std::endl;
+#endif
+            continue;
+        }
+        const std::string netSimFlag = "--net-sim=";
+        if (arg.compare(0, netSimFlag.size(), netSimFlag) == 0) {
+            LinkConditions conditions;
+            if (!LinkConditioner::parseConditions(arg.substr(netSimFlag.size()), conditions)) {
+                std::cerr << "Invalid link conditions: " << arg.substr(netSimFlag.size()) << std::endl;
+                return -1;
+            }
+            server.setLinkConditions(conditions);
+            continue;
+        }
+        const std::string formatFlag = "--snapshot-format=";
+        if (arg.compare(0, formatFlag.size(), formatFlag) == 0) {
+            SnapshotFormat format;
+            if (!SnapshotCodec::parseFormat(arg.substr(formatFlag.size()), format)) {
+                std::cerr << "Unknown snapshot format: " << arg.substr(formatFlag.size()) << std::endl;
+                return -1;
+            }
+            settings.snapshotFormat = format;
         }
     }
-};
-
-int main() {
-    GameServer server;
     
     if (!server.initialize()) {
         return -1;
@@ -0,0 +1,216 @@
+#include "BroadcastStage.h"
+#include "SnapshotCodec.h"
+#include <chrono>
+
+#ifdef __linux__
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+BroadcastStage::BroadcastStage(NetworkManager& network)
+    : network_(network), pending_(QUEUE_CAPACITY), recycled_(QUEUE_CAPACITY), current_(nullptr),
+      unpublished_(false), running_(false), wakeFd_(-1), busyNanos_(0) {
+}
+
+BroadcastStage::~BroadcastStage() {
+    stop();
+}
+
+bool BroadcastStage::start() {
+#ifdef __linux__
+    if (isThreaded()) return true;
+    
+    wakeFd_ = eventfd(0, 0);
+    if (wakeFd_ < 0) return false;
+    
+    running_ = true;
+    thread_ = std::thread(&BroadcastStage::run, this);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void BroadcastStage::stop() {
+#ifdef __linux__
+    if (!isThreaded()) return;
+    
+    running_ = false;
+    uint64_t one = 1;
+    if (write(wakeFd_, &one, sizeof(one)) < 0) {
+        // The thread also exits on its next wakeup
+    }
+    thread_.join();
+    close(wakeFd_);
+    wakeFd_ = -1;
+    
+    // The thread can see running_ go false between its last pop and a final submit;
+    // what it left behind goes out here
+    BroadcastJob* job;
+    while (pending_.pop(job)) {
+        process(*job);
+        recycled_.push(job);
+    }
+    unpublished_ = false;
+#endif
+}
+
+BroadcastJob& BroadcastStage::beginJob(int roomIndex, BroadcastKind kind) {
+    current_ = nullptr;
+    if (isThreaded()) {
+        if (!recycled_.pop(current_) && jobs_.size() < QUEUE_CAPACITY) {
+            jobs_.emplace_back(new BroadcastJob());
+            current_ = jobs_.back().get();
+        }
+        // Every job is in flight: the send thread is a full queue behind, wait for it
+        while (!current_) {
+            publish();
+            std::this_thread::yield();
+            recycled_.pop(current_);
+        }
+    } else {
+        if (jobs_.empty()) jobs_.emplace_back(new BroadcastJob());
+        current_ = jobs_.front().get();
+    }
+    
+    current_->roomIndex = roomIndex;
+    current_->kind = kind;
+    current_->interestFilter = false;
+    current_->recipients.clear();
+    return *current_;
+}
+
+void BroadcastStage::submit() {
+    if (!current_) return;
+    
+    if (isThreaded()) {
+        // Can't fail: there are never more jobs than queue slots
+        pending_.push(current_);
+        unpublished_ = true;
+    } else {
+        process(*current_);
+    }
+    current_ = nullptr;
+}
+
+void BroadcastStage::sendMessage(int roomIndex, const NetworkMessage& message, const sockaddr_in& address) {
+    BroadcastJob& job = beginJob(roomIndex, BroadcastKind::MESSAGE);
+    job.message = message;
+    job.recipients.push_back(SnapshotRecipient{message.playerId, address, -1, 0});
+    submit();
+}
+
+void BroadcastStage::publish() {
+#ifdef __linux__
+    if (!unpublished_) return;
+    unpublished_ = false;
+    
+    uint64_t one = 1;
+    if (write(wakeFd_, &one, sizeof(one)) < 0) {
+        // Counter saturated; the send thread is already awake
+    }
+#endif
+}
+
+double BroadcastStage::takeBusySeconds() {
+    return busyNanos_.exchange(0) / 1e9;
+}
+
+void BroadcastStage::run() {
+#ifdef __linux__
+    TickProfiler::setCurrent(&profiler_);
+    
+    BroadcastJob* job;
+    while (running_) {
+        uint64_t value;
+        if (read(wakeFd_, &value, sizeof(value)) < 0) {
+            continue;
+        }
+        
+        while (pending_.pop(job)) {
+            process(*job);
+            recycled_.push(job);
+            profiler_.endTick();
+        }
+    }
+#endif
+}
+
+void BroadcastStage::process(BroadcastJob& job) {
+    auto start = std::chrono::steady_clock::now();
+    PROFILE_SCOPE("broadcast"); // Encode and send; broadcast.send is the sendmmsg part
+    
+    if (job.kind == BroadcastKind::MESSAGE) {
+        addresses_.clear();
+        for (const SnapshotRecipient& recipient : job.recipients) {
+            addresses_.push_back(recipient.address);
+        }
+        network_.queueBroadcast(job.message, addresses_);
+    } else if (job.kind == BroadcastKind::CLIENT_LEFT) {
+        for (const SnapshotRecipient& recipient : job.recipients) {
+            views_.erase(recipient.playerId);
+        }
+    } else if (job.kind == BroadcastKind::ROOM_CLOSED) {
+        histories_.erase(job.roomIndex);
+    } else if (job.interestFilter) {
+        sendFiltered(job);
+    } else {
+        SnapshotHistory& history = histories_[job.roomIndex];
+        history.store(job.snapshot);
+        
+        // Clients acked on the same baseline get the same bytes, so encode each baseline once
+        clientsByBaseline_.clear();
+        for (const SnapshotRecipient& recipient : job.recipients) {
+            const WorldSnapshot* baseline = history.find(recipient.ackedTick);
+            int baselineTick = baseline ? baseline->tick : -1; // -1: full snapshot
+            clientsByBaseline_[baselineTick].push_back(recipient.address);
+        }
+        
+        job.message.type = MessageType::GAME_STATE_UPDATE;
+        job.message.playerId = 0; // Server message
+        for (const auto& group : clientsByBaseline_) {
+            const WorldSnapshot* baseline = history.find(group.first);
+            if (baseline) {
+                SnapshotCodec::encodeDelta(*baseline, job.snapshot, job.message.data);
+            } else {
+                SnapshotCodec::encode(job.snapshot, job.message.data);
+            }
+            network_.queueBroadcast(job.message, group.second);
+        }
+    }
+    
+    // One sendmmsg (per 1024 datagrams) covers every client
+    {
+        PROFILE_SCOPE("broadcast.send");
+        network_.flushQueued();
+    }
+    
+    busyNanos_ += std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+void BroadcastStage::sendFiltered(BroadcastJob& job) {
+    job.message.type = MessageType::GAME_STATE_UPDATE;
+    job.message.playerId = 0; // Server message
+    
+    // Every client gets its own bytes, delta-encoded against its own acked view
+    for (const SnapshotRecipient& recipient : job.recipients) {
+        ClientView& client = views_[recipient.playerId];
+        
+        {
+            PROFILE_SCOPE("broadcast.interest");
+            interest_.update(job.snapshot, recipient.playerId, recipient.byteBudget, client.interest);
+        }
+        client.history.store(client.interest.view);
+        
+        const WorldSnapshot* baseline = client.history.find(recipient.ackedTick);
+        if (baseline) {
+            SnapshotCodec::encodeDelta(*baseline, client.interest.view, job.message.data);
+        } else {
+            SnapshotCodec::encode(client.interest.view, job.message.data);
+        }
+        
+        addresses_.assign(1, recipient.address);
+        network_.queueBroadcast(job.message, addresses_);
+    }
+}
@@ -3,12 +3,12 @@
 
 Bullet::Bullet()
     : id_(0), ownerId_(0), x_(0), y_(0), velX_(0), velY_(0),
-      active_(false), damage_(25), lifeTime_(0), maxLifeTime_(5.0f) {
+      active_(false), damage_(25), lifeTime_(0), maxLifeTime_(5.0f), rewindTicks_(0) {
 }
 
 Bullet::Bullet(int id, int ownerId, float x, float y, float angle, float speed)
     : id_(id), ownerId_(ownerId), x_(x), y_(y), active_(true),
-      damage_(25), lifeTime_(0), maxLifeTime_(5.0f) {
+      damage_(25), lifeTime_(0), maxLifeTime_(5.0f), rewindTicks_(0) {
     
     // Calculate velocity based on angle and speed
     velX_ = cos(angle) * speed;
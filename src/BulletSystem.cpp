@@ -0,0 +1,258 @@
+#include "BulletSystem.h"
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+struct IntegrateArgs {
+    float* x;
+    float* y;
+    float* prevX;
+    float* prevY;
+    const float* velX;
+    const float* velY;
+    float* lifeTime;
+    uint8_t* active;
+    float deltaTime;
+};
+
+static size_t integrateScalar(const IntegrateArgs& a, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+        a.prevX[i] = a.x[i];
+        a.prevY[i] = a.y[i];
+        a.x[i] += a.velX[i] * a.deltaTime;
+        a.y[i] += a.velY[i] * a.deltaTime;
+        a.lifeTime[i] += a.deltaTime;
+        
+        if (a.lifeTime[i] >= BulletSystem::MAX_LIFETIME) {
+            a.active[i] = 0;
+        }
+    }
+    return end;
+}
+
+#if defined(__AVX2__)
+static size_t integrateAVX2(const IntegrateArgs& a, size_t count) {
+    const __m256 dt = _mm256_set1_ps(a.deltaTime);
+    const __m256 maxLife = _mm256_set1_ps(BulletSystem::MAX_LIFETIME);
+    
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 x = _mm256_loadu_ps(a.x + i);
+        __m256 y = _mm256_loadu_ps(a.y + i);
+        _mm256_storeu_ps(a.prevX + i, x);
+        _mm256_storeu_ps(a.prevY + i, y);
+        
+        x = _mm256_add_ps(x, _mm256_mul_ps(_mm256_loadu_ps(a.velX + i), dt));
+        y = _mm256_add_ps(y, _mm256_mul_ps(_mm256_loadu_ps(a.velY + i), dt));
+        __m256 life = _mm256_add_ps(_mm256_loadu_ps(a.lifeTime + i), dt);
+        _mm256_storeu_ps(a.x + i, x);
+        _mm256_storeu_ps(a.y + i, y);
+        _mm256_storeu_ps(a.lifeTime + i, life);
+        
+        int alive = _mm256_movemask_ps(_mm256_cmp_ps(life, maxLife, _CMP_LT_OQ));
+        if (alive != 0xFF) {
+            for (int lane = 0; lane < 8; lane++) {
+                a.active[i + lane] &= (alive >> lane) & 1;
+            }
+        }
+    }
+    return i;
+}
+#elif defined(__SSE2__) || defined(_M_X64)
+static size_t integrateSSE(const IntegrateArgs& a, size_t count) {
+    const __m128 dt = _mm_set1_ps(a.deltaTime);
+    const __m128 maxLife = _mm_set1_ps(BulletSystem::MAX_LIFETIME);
+    
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(a.x + i);
+        __m128 y = _mm_loadu_ps(a.y + i);
+        _mm_storeu_ps(a.prevX + i, x);
+        _mm_storeu_ps(a.prevY + i, y);
+        
+        x = _mm_add_ps(x, _mm_mul_ps(_mm_loadu_ps(a.velX + i), dt));
+        y = _mm_add_ps(y, _mm_mul_ps(_mm_loadu_ps(a.velY + i), dt));
+        __m128 life = _mm_add_ps(_mm_loadu_ps(a.lifeTime + i), dt);
+        _mm_storeu_ps(a.x + i, x);
+        _mm_storeu_ps(a.y + i, y);
+        _mm_storeu_ps(a.lifeTime + i, life);
+        
+        int alive = _mm_movemask_ps(_mm_cmplt_ps(life, maxLife));
+        if (alive != 0xF) {
+            for (int lane = 0; lane < 4; lane++) {
+                a.active[i + lane] &= (alive >> lane) & 1;
+            }
+        }
+    }
+    return i;
+}
+#endif
+
+BulletSystem::BulletSystem() {
+}
+
+SlotHandle BulletSystem::add(int id, int ownerId, float x, float y, float velX, float velY, int rewindTicks) {
+    if (handleById_.find(id) != handleById_.end()) {
+        return SlotHandle();
+    }
+    
+    SlotHandle handle = slots_.acquire();
+    handleById_[id] = handle;
+    ids_.push_back(id);
+    ownerIds_.push_back(ownerId);
+    x_.push_back(x);
+    y_.push_back(y);
+    prevX_.push_back(x);
+    prevY_.push_back(y);
+    velX_.push_back(velX);
+    velY_.push_back(velY);
+    lifeTime_.push_back(0);
+    damage_.push_back(25);
+    rewindTicks_.push_back(rewindTicks);
+    active_.push_back(1);
+    return handle;
+}
+
+bool BulletSystem::remove(int id) {
+    auto it = handleById_.find(id);
+    return it != handleById_.end() && remove(it->second);
+}
+
+bool BulletSystem::remove(SlotHandle handle) {
+    int index = slots_.denseIndex(handle);
+    if (index < 0) return false;
+    
+    // Swap-remove: the last bullet takes this one's place
+    handleById_.erase(ids_[index]);
+    size_t last = slots_.eraseAt(static_cast<size_t>(index));
+    moveElement(last, static_cast<size_t>(index));
+    resizeArrays(last);
+    return true;
+}
+
+void BulletSystem::clear() {
+    slots_.clear();
+    handleById_.clear();
+    resizeArrays(0);
+}
+
+void BulletSystem::reserve(size_t capacity) {
+    slots_.reserve(capacity);
+    ids_.reserve(capacity);
+    ownerIds_.reserve(capacity);
+    x_.reserve(capacity);
+    y_.reserve(capacity);
+    prevX_.reserve(capacity);
+    prevY_.reserve(capacity);
+    velX_.reserve(capacity);
+    velY_.reserve(capacity);
+    lifeTime_.reserve(capacity);
+    damage_.reserve(capacity);
+    rewindTicks_.reserve(capacity);
+    active_.reserve(capacity);
+}
+
+void BulletSystem::integrate(float deltaTime) {
+    IntegrateArgs args{x_.data(), y_.data(), prevX_.data(), prevY_.data(), velX_.data(), velY_.data(),
+                       lifeTime_.data(), active_.data(), deltaTime};
+    size_t count = ids_.size();
+    size_t done = 0;
+    
+#if defined(__AVX2__)
+    done = integrateAVX2(args, count);
+#elif defined(__SSE2__) || defined(_M_X64)
+    done = integrateSSE(args, count);
+#endif
+    
+    integrateScalar(args, done, count);
+}
+
+size_t BulletSystem::removeInactive(float worldWidth, float worldHeight) {
+    // One compaction pass per tick rather than a swap per bullet: it's still O(1)
+    // per removal and keeps bullets in id order, which delta snapshots rely on
+    size_t count = ids_.size();
+    size_t write = 0;
+    
+    for (size_t read = 0; read < count; read++) {
+        bool inWorld = x_[read] >= 0 && x_[read] <= worldWidth && y_[read] >= 0 && y_[read] <= worldHeight;
+        if (!active_[read] || !inWorld) {
+            handleById_.erase(ids_[read]);
+            slots_.release(read);
+            continue;
+        }
+        if (write != read) {
+            slots_.relocate(read, write);
+            moveElement(read, write);
+        }
+        write++;
+    }
+    
+    if (write == count) return 0;
+    
+    slots_.truncate(write);
+    resizeArrays(write);
+    return count - write;
+}
+
+void BulletSystem::moveElement(size_t from, size_t to) {
+    if (from == to) return;
+    
+    ids_[to] = ids_[from];
+    ownerIds_[to] = ownerIds_[from];
+    x_[to] = x_[from];
+    y_[to] = y_[from];
+    prevX_[to] = prevX_[from];
+    prevY_[to] = prevY_[from];
+    velX_[to] = velX_[from];
+    velY_[to] = velY_[from];
+    lifeTime_[to] = lifeTime_[from];
+    damage_[to] = damage_[from];
+    rewindTicks_[to] = rewindTicks_[from];
+    active_[to] = active_[from];
+}
+
+void BulletSystem::resizeArrays(size_t size) {
+    ids_.resize(size);
+    ownerIds_.resize(size);
+    x_.resize(size);
+    y_.resize(size);
+    prevX_.resize(size);
+    prevY_.resize(size);
+    velX_.resize(size);
+    velY_.resize(size);
+    lifeTime_.resize(size);
+    damage_.resize(size);
+    rewindTicks_.resize(size);
+    active_.resize(size);
+}
+
+int BulletSystem::indexOf(int id) const {
+    auto it = handleById_.find(id);
+    return (it != handleById_.end()) ? slots_.denseIndex(it->second) : -1;
+}
+
+bool BulletSystem::overlaps(size_t i, float x, float y, float width, float height) const {
+    if (!active_[i]) return false;
+    
+    return (x_[i] < x + width &&
+            x_[i] + BULLET_SIZE > x &&
+            y_[i] < y + height &&
+            y_[i] + BULLET_SIZE > y);
+}
+
+bool BulletSystem::sweep(size_t i, float x, float y, float width, float height, float& hitTime) const {
+    if (!active_[i]) return false;
+    
+    // Bullet box is [bx, bx + BULLET_SIZE]; grow the target by it and sweep the corner
+    return CollisionMap::segmentHitsBox(prevX_[i], prevY_[i], x_[i] - prevX_[i], y_[i] - prevY_[i],
+                                        x - BULLET_SIZE, y - BULLET_SIZE, x + width, y + height, hitTime);
+}
+
+Bullet BulletSystem::toBullet(size_t i) const {
+    Bullet bullet(ids_[i], ownerIds_[i], x_[i], y_[i], 0, 0);
+    bullet.setVelocity(velX_[i], velY_[i]);
+    bullet.setActive(active_[i] != 0);
+    bullet.setRewindTicks(rewindTicks_[i]);
+    return bullet;
+}
@@ -0,0 +1,145 @@
+#include "CollisionMap.h"
+#include <algorithm>
+#include <cmath>
+
+CollisionMap::CollisionMap(float cellSize)
+    : cellSize_(cellSize > 0 ? cellSize : 64.0f), inverseCellSize_(1.0f / cellSize_),
+      columns_(0), rows_(0) {
+}
+
+void CollisionMap::build(const std::vector<Obstacle>& obstacles, float worldWidth, float worldHeight) {
+    obstacles_ = obstacles;
+    columns_ = std::max(1, static_cast<int>(std::ceil(worldWidth * inverseCellSize_)));
+    rows_ = std::max(1, static_cast<int>(std::ceil(worldHeight * inverseCellSize_)));
+    
+    const size_t cellCount = static_cast<size_t>(columns_) * rows_;
+    cellStart_.assign(cellCount + 1, 0);
+    
+    // Two passes: count obstacles per cell, then fill the flat index array
+    for (int pass = 0; pass < 2; pass++) {
+        std::vector<uint32_t> cursor;
+        if (pass == 1) {
+            for (size_t c = 0; c < cellCount; c++) {
+                cellStart_[c + 1] += cellStart_[c];
+            }
+            cellObstacles_.assign(cellStart_[cellCount], 0);
+            cursor.assign(cellStart_.begin(), cellStart_.end() - 1);
+        }
+        
+        for (size_t i = 0; i < obstacles_.size(); i++) {
+            const Obstacle& obs = obstacles_[i];
+            int c0 = cellColumn(obs.x), c1 = cellColumn(obs.x + obs.width);
+            int r0 = cellRow(obs.y), r1 = cellRow(obs.y + obs.height);
+            
+            for (int r = r0; r <= r1; r++) {
+                for (int c = c0; c <= c1; c++) {
+                    size_t cell = static_cast<size_t>(r) * columns_ + c;
+                    if (pass == 0) {
+                        cellStart_[cell + 1]++;
+                    } else {
+                        cellObstacles_[cursor[cell]++] = static_cast<uint16_t>(i);
+                    }
+                }
+            }
+        }
+    }
+}
+
+bool CollisionMap::overlaps(float x, float y, float width, float height) const {
+    if (cellStart_.empty()) return false;
+    
+    int c0 = cellColumn(x), c1 = cellColumn(x + width);
+    int r0 = cellRow(y), r1 = cellRow(y + height);
+    
+    for (int r = r0; r <= r1; r++) {
+        for (int c = c0; c <= c1; c++) {
+            size_t cell = static_cast<size_t>(r) * columns_ + c;
+            for (uint32_t i = cellStart_[cell]; i < cellStart_[cell + 1]; i++) {
+                const Obstacle& obs = obstacles_[cellObstacles_[i]];
+                
+                // AABB collision detection
+                if (x < obs.x + obs.width &&
+                    x + width > obs.x &&
+                    y < obs.y + obs.height &&
+                    y + height > obs.y) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+bool CollisionMap::sweep(float x0, float y0, float x1, float y1, float halfSize, float& hitTime) const {
+    if (cellStart_.empty()) return false;
+    
+    // Visit every cell under the swept bounds; moves per tick are short, so this
+    // is a handful of cells even at low tick rates
+    int c0 = cellColumn(std::min(x0, x1) - halfSize), c1 = cellColumn(std::max(x0, x1) + halfSize);
+    int r0 = cellRow(std::min(y0, y1) - halfSize), r1 = cellRow(std::max(y0, y1) + halfSize);
+    
+    bool hit = false;
+    hitTime = 1.0f;
+    for (int r = r0; r <= r1; r++) {
+        for (int c = c0; c <= c1; c++) {
+            size_t cell = static_cast<size_t>(r) * columns_ + c;
+            for (uint32_t i = cellStart_[cell]; i < cellStart_[cell + 1]; i++) {
+                const Obstacle& obs = obstacles_[cellObstacles_[i]];
+                
+                // Grow the obstacle by the moving square so it can be swept as a point
+                float time;
+                if (segmentHitsBox(x0, y0, x1 - x0, y1 - y0,
+                                   obs.x - halfSize, obs.y - halfSize,
+                                   obs.x + obs.width + halfSize, obs.y + obs.height + halfSize, time) &&
+                    time <= hitTime) {
+                    hitTime = time;
+                    hit = true;
+                }
+            }
+        }
+    }
+    return hit;
+}
+
+bool CollisionMap::segmentHitsBox(float x0, float y0, float dx, float dy,
+                                  float minX, float minY, float maxX, float maxY, float& hitTime) {
+    // Slab test; the box is open to match the strict AABB overlap checks
+    float enter = 0.0f;
+    float exit = 1.0f;
+    
+    const float start[2] = {x0, y0};
+    const float delta[2] = {dx, dy};
+    const float boxMin[2] = {minX, minY};
+    const float boxMax[2] = {maxX, maxY};
+    
+    for (int axis = 0; axis < 2; axis++) {
+        if (delta[axis] == 0.0f) {
+            if (start[axis] <= boxMin[axis] || start[axis] >= boxMax[axis]) return false;
+            continue;
+        }
+        
+        float inverse = 1.0f / delta[axis];
+        float t0 = (boxMin[axis] - start[axis]) * inverse;
+        float t1 = (boxMax[axis] - start[axis]) * inverse;
+        if (t0 > t1) std::swap(t0, t1);
+        
+        enter = std::max(enter, t0);
+        exit = std::min(exit, t1);
+        if (enter >= exit) return false;
+    }
+    
+    hitTime = enter;
+    return true;
+}
+
+// Coordinates outside the world clamp to the border cells, which also hold any
+// obstacle that sticks out of the world, so queries stay exact
+int CollisionMap::cellColumn(float x) const {
+    int column = static_cast<int>(std::floor(x * inverseCellSize_));
+    return std::min(std::max(column, 0), columns_ - 1);
+}
+
+int CollisionMap::cellRow(float y) const {
+    int row = static_cast<int>(std::floor(y * inverseCellSize_));
+    return std::min(std::max(row, 0), rows_ - 1);
+}
@@ -0,0 +1,96 @@
+#include "ConnectionManager.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+static float secondsBetween(ConnectionManager::Clock::time_point from, ConnectionManager::Clock::time_point to) {
+    return std::chrono::duration<float>(to - from).count();
+}
+
+void ConnectionManager::add(int playerId, Clock::time_point now, uint32_t firstPingId) {
+    Connection connection = Connection(); // No pings outstanding, no RTT yet
+    connection.lastHeard = now;
+    connection.lastPing = now - std::chrono::seconds(1); // First ping goes out right away
+    connection.nextPingId = firstPingId == 0 ? 1 : firstPingId;
+    connections_[playerId] = connection;
+}
+
+void ConnectionManager::heard(int playerId, Clock::time_point now) {
+    auto it = connections_.find(playerId);
+    if (it != connections_.end()) {
+        it->second.lastHeard = now;
+    }
+}
+
+bool ConnectionManager::handlePong(int playerId, const std::string& data, Clock::time_point now) {
+    auto it = connections_.find(playerId);
+    if (it == connections_.end()) return false;
+    
+    Connection& connection = it->second;
+    uint32_t pingId = static_cast<uint32_t>(std::strtoul(data.c_str(), nullptr, 10));
+    int slot = pingId % PING_HISTORY;
+    if (pingId == 0 || connection.pingIds[slot] != pingId) return false;
+    connection.pingIds[slot] = 0; // A duplicated PONG doesn't count twice
+    
+    float sample = secondsBetween(connection.pingTimes[slot], now);
+    if (!connection.hasRtt) {
+        connection.rtt = sample;
+        connection.jitter = 0;
+        connection.hasRtt = true;
+    } else {
+        // Same smoothing as TCP's RTT and RTP's interarrival jitter
+        connection.rtt += (sample - connection.rtt) / 8;
+        connection.jitter += (std::fabs(sample - connection.lastSample) - connection.jitter) / 16;
+    }
+    connection.lastSample = sample;
+    return true;
+}
+
+void ConnectionManager::update(Clock::time_point now, std::vector<int>& timedOut, std::vector<NetworkMessage>& pings) {
+    for (auto& entry : connections_) {
+        Connection& connection = entry.second;
+        if (timeoutSeconds_ > 0 && secondsBetween(connection.lastHeard, now) > timeoutSeconds_) {
+            timedOut.push_back(entry.first);
+            continue;
+        }
+        
+        if (secondsBetween(connection.lastPing, now) < PING_INTERVAL) continue;
+        
+        uint32_t pingId = connection.nextPingId++;
+        if (connection.nextPingId == 0) connection.nextPingId = 1;
+        connection.pingIds[pingId % PING_HISTORY] = pingId;
+        connection.pingTimes[pingId % PING_HISTORY] = now;
+        connection.lastPing = now;
+        
+        pings.emplace_back();
+        NetworkMessage& ping = pings.back();
+        ping.type = MessageType::PING;
+        ping.playerId = entry.first;
+        ping.data = std::to_string(pingId);
+    }
+}
+
+const ConnectionManager::Connection* ConnectionManager::find(int playerId) const {
+    auto it = connections_.find(playerId);
+    return it == connections_.end() ? nullptr : &it->second;
+}
+
+float ConnectionManager::getRtt(int playerId) const {
+    const Connection* connection = find(playerId);
+    return connection ? connection->rtt : 0;
+}
+
+float ConnectionManager::getJitter(int playerId) const {
+    const Connection* connection = find(playerId);
+    return connection ? connection->jitter : 0;
+}
+
+void ConnectionManager::accumulateRtt(float& total, float& maximum, size_t& count) const {
+    for (const auto& entry : connections_) {
+        const Connection& connection = entry.second;
+        if (!connection.hasRtt) continue;
+        total += connection.rtt;
+        maximum = std::max(maximum, connection.rtt);
+        count++;
+    }
+}
@@ -0,0 +1,34 @@
+#include "FixedTimestep.h"
+
+FixedTimestep::FixedTimestep(int tickRate, int maxCatchUpSteps)
+    : tickRate_(0), stepSeconds_(0), accumulator_(0),
+      maxCatchUpSteps_(maxCatchUpSteps > 0 ? maxCatchUpSteps : 1), droppedSteps_(0) {
+    setTickRate(tickRate);
+}
+
+int FixedTimestep::advance(float elapsedSeconds) {
+    if (elapsedSeconds > 0) {
+        accumulator_ += elapsedSeconds;
+    }
+    
+    // Small tolerance so exact multiples of the step don't lose a tick to rounding
+    int steps = static_cast<int>(accumulator_ / stepSeconds_ + 0.001f);
+    accumulator_ -= steps * stepSeconds_;
+    
+    if (steps > maxCatchUpSteps_) {
+        droppedSteps_ += steps - maxCatchUpSteps_;
+        steps = maxCatchUpSteps_;
+    }
+    
+    return steps;
+}
+
+void FixedTimestep::reset() {
+    accumulator_ = 0;
+    droppedSteps_ = 0;
+}
+
+void FixedTimestep::setTickRate(int tickRate) {
+    tickRate_ = tickRate > 0 ? tickRate : DEFAULT_TICK_RATE;
+    stepSeconds_ = 1.0f / tickRate_;
+}
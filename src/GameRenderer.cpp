@@ -80,10 +80,8 @@ void GameRenderer::render(const GameState& gameState, int localPlayerId) {
     
     // Render all bullets
     const auto& bullets = gameState.getAllBullets();
-    for (const Bullet* bullet : bullets) {
-        if (bullet && bullet->isActive()) {
-            renderBullet(*bullet);
-        }
+    for (const Bullet& bullet : bullets) {
+        renderBullet(bullet);
     }
     
     EndMode2D();
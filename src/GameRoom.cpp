@@ -0,0 +1,396 @@
+#include "GameRoom.h"
+#include "TickProfiler.h"
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <algorithm>
+
+static const int MAX_QUEUED_INPUTS = 4; // Input commands buffered per client
+static const int MIN_SNAPSHOT_BUDGET = 64; // Room for the header and the client's own player
+
+GameRoom::GameRoom(int index, const std::string& name, const RoomSettings& settings)
+    : index_(index), name_(name), settings_(settings), output_(nullptr),
+      nextLocalId_(1), nextBulletId_(1), timestep_(settings.tickRate), ticksSinceBroadcast_(0) {
+    gameState_.setWorldSize(2000, 1500);
+    
+    int maxRewindTicks = settings_.maxRewindMs * timestep_.getTickRate() / 1000;
+    gameState_.setLagCompensation(maxRewindTicks > 0, maxRewindTicks);
+    connections_.setTimeout(settings_.clientTimeoutMs / 1000.0f);
+}
+
+bool GameRoom::parseJoin(const std::string& data, std::string& name, std::string& room, int& rate) {
+    size_t roomStart = data.find('|');
+    name = data.substr(0, std::min(roomStart, static_cast<size_t>(MAX_NAME_LENGTH)));
+    room.clear();
+    rate = 0;
+    if (roomStart == std::string::npos) return true;
+    
+    size_t rateStart = data.find('|', roomStart + 1);
+    room = data.substr(roomStart + 1, rateStart == std::string::npos ? std::string::npos : rateStart - roomStart - 1);
+    if (room.size() > MAX_NAME_LENGTH) return false;
+    if (rateStart == std::string::npos) return true;
+    
+    // Digits only: a sign, a third '|' or trailing junk means a name that smuggled
+    // in fields the player never chose (clients strip '|' from names)
+    const char* digits = data.c_str() + rateStart + 1;
+    if (*digits == '\0') return false;
+    long value = 0;
+    for (const char* c = digits; *c != '\0'; c++) {
+        if (*c < '0' || *c > '9') return false;
+        value = std::min(value * 10 + (*c - '0'), static_cast<long>(MAX_CLIENT_RATE));
+    }
+    rate = static_cast<int>(value);
+    return true;
+}
+
+bool GameRoom::unwrapJoin(const NetworkMessage& message, NetworkMessage& join) {
+    if (message.type == MessageType::RELIABLE) {
+        if (!ReliableChannel::peek(message, join)) return false;
+    } else {
+        join = message;
+    }
+    return join.type == MessageType::PLAYER_JOIN;
+}
+
+int GameRoom::join(const NetworkMessage& message, const sockaddr_in& address) {
+    NetworkMessage joinMessage;
+    if (!unwrapJoin(message, joinMessage)) return -1;
+    
+    // A resent join (its reply was lost) must not add the player twice. Over the
+    // channel it is a duplicate that only needs acking, as the channel resends the
+    // reply itself; a plain join gets the reply again.
+    uint64_t addressKey = NetworkManager::addressKey(address);
+    auto existing = playersByAddress_.find(addressKey);
+    if (existing != playersByAddress_.end()) {
+        auto client = clients_.find(existing->second);
+        if (client == clients_.end()) return -1;
+        
+        ClientConnection& connection = client->second;
+        if (!connection.reliable) {
+            sendAssignment(connection, client->first);
+        } else if (message.type == MessageType::RELIABLE) {
+            NetworkMessage envelope = message;
+            envelope.playerId = client->first;
+            delivered_.clear();
+            connection.channel.receive(envelope, ReliableChannel::Clock::now(), delivered_);
+        }
+        return client->first;
+    }
+    
+    std::string playerName, roomName;
+    int rate;
+    if (!parseJoin(joinMessage.data, playerName, roomName, rate)) return -1;
+    
+    int playerId = allocatePlayerId();
+    gameState_.addPlayer(playerId, playerName);
+    
+    // The tighter of the server cap and what the client asked for, spread over the snapshots
+    if (settings_.clientRate > 0 && (rate <= 0 || settings_.clientRate < rate)) {
+        rate = settings_.clientRate;
+    }
+    int byteBudget = 0;
+    if (rate > 0) {
+        int snapshotsPerSecond = timestep_.getTickRate() / broadcastInterval();
+        byteBudget = std::max(rate / snapshotsPerSecond, MIN_SNAPSHOT_BUDGET);
+    }
+    ClientConnection& connection = clients_[playerId];
+    connection = ClientConnection{address, -1, {}, 0, byteBudget, message.type == MessageType::RELIABLE, {}};
+    playersByAddress_[addressKey] = playerId;
+    connections_.add(playerId, ConnectionManager::Clock::now());
+    
+    if (connection.reliable) {
+        // Only sequences the join; the JOIN itself was handled above
+        NetworkMessage envelope = message;
+        envelope.playerId = playerId;
+        connection.channel.setPlayerId(playerId);
+        connection.channel.setAckDelay(0); // Snapshots are shared, so acks never ride on them
+        connection.channel.receive(envelope, ReliableChannel::Clock::now(), delivered_);
+        delivered_.clear();
+    }
+    
+    sendAssignment(connection, playerId);
+    
+    std::cout << "Player " << playerName << " joined room " << name_ << " (ID: " << playerId << ", "
+              << clients_.size() << " players)" << std::endl;
+    return playerId;
+}
+
+void GameRoom::sendAssignment(ClientConnection& connection, int playerId) {
+    // Send player ID assignment back to the client; the client simulates at our
+    // rate and ignores the room name after it
+    NetworkMessage assignMessage;
+    assignMessage.type = MessageType::PLAYER_JOIN;
+    assignMessage.playerId = playerId;
+    assignMessage.data = std::to_string(timestep_.getTickRate()) + "|" + name_;
+    sendToClient(connection, assignMessage);
+}
+
+void GameRoom::sendToClient(ClientConnection& connection, const NetworkMessage& message) {
+    if (!connection.reliable) {
+        output_->sendMessage(index_, message, connection.address);
+        return;
+    }
+    
+    NetworkMessage envelope;
+    if (connection.channel.send(message, ReliableChannel::Clock::now(), envelope)) {
+        output_->sendMessage(index_, envelope, connection.address);
+    }
+}
+
+int GameRoom::allocatePlayerId() {
+    // Local ids wrap within the room's id range, skipping ones still in use
+    const int localMask = (1 << PLAYER_ID_BITS) - 1;
+    int playerId;
+    do {
+        int localId = nextLocalId_;
+        nextLocalId_ = (nextLocalId_ & localMask) + 1;
+        playerId = (index_ << PLAYER_ID_BITS) | (localId & localMask);
+    } while ((playerId & localMask) == 0 || clients_.contains(playerId));
+    return playerId;
+}
+
+void GameRoom::handleMessage(const NetworkMessage& message) {
+    connections_.heard(message.playerId, ConnectionManager::Clock::now());
+    
+    switch (message.type) {
+        case MessageType::RELIABLE:
+            handleReliable(message);
+            break;
+        case MessageType::PLAYER_MOVE: {
+            // Queue the commands; one is applied per simulation step so the
+            // acknowledged sequence matches what the client predicted
+            auto client = clients_.find(message.playerId);
+            if (client == clients_.end()) break;
+            
+            // Binary packets repeat the last few commands; only new ones are queued
+            if (InputCommand::isBatch(message.data)) {
+                if (!InputCommand::decodeBatch(message.data, decodedInputs_)) break;
+            } else {
+                decodedInputs_.resize(1);
+                if (!InputCommand::fromText(message.data, decodedInputs_[0])) break;
+            }
+            
+            ClientConnection& connection = client->second;
+            for (const InputCommand& command : decodedInputs_) {
+                if (command.sequence <= connection.lastQueuedInput) continue;
+                connection.inputs.push_back(command);
+                connection.lastQueuedInput = command.sequence;
+                
+                // A client running ahead of us would otherwise build up latency
+                if (connection.inputs.size() > MAX_QUEUED_INPUTS) {
+                    connection.inputs.pop_front();
+                }
+            }
+            break;
+        }
+        case MessageType::PLAYER_SHOOT: {
+            // Handle shooting - only if player is alive
+            Player* player = gameState_.getPlayer(message.playerId);
+            if (player && player->isAlive()) {
+                // Parse shooting data
+                // Format: "x,y,angle[,viewTick]"
+                std::istringstream iss(message.data);
+                std::string token;
+                float x, y, angle;
+                
+                std::getline(iss, token, ',');
+                x = std::stof(token);
+                std::getline(iss, token, ',');
+                y = std::stof(token);
+                std::getline(iss, token, ',');
+                angle = std::stof(token);
+                
+                // viewTick is the server tick the shooter was looking at; the
+                // game state clamps the rewind to the configured window. Without
+                // it, rewind by the one-way trip as a best guess.
+                int rewindTicks = 0;
+                if (std::getline(iss, token, ',') && !token.empty()) {
+                    rewindTicks = gameState_.getTick() - std::atoi(token.c_str());
+                } else {
+                    rewindTicks = static_cast<int>(connections_.getRtt(message.playerId) / 2 * timestep_.getTickRate() + 0.5f);
+                }
+                
+                gameState_.addBullet(nextBulletId_++, message.playerId, x, y, angle, 400.0f, rewindTicks);
+            }
+            break;
+        }
+        case MessageType::PLAYER_RESPAWN: {
+            // Handle player respawn request
+            Player* player = gameState_.getPlayer(message.playerId);
+            if (player && !player->isAlive()) {
+                // Respawn at a random valid position (not overlapping obstacles)
+                gameState_.respawnPlayer(message.playerId);
+                std::cout << "Player " << message.playerId << " (" << player->getName() << ") respawned" << std::endl;
+            }
+            break;
+        }
+        case MessageType::PLAYER_LEAVE:
+            removeClient(message.playerId, "left");
+            break;
+        case MessageType::PONG:
+            connections_.handlePong(message.playerId, message.data, ConnectionManager::Clock::now());
+            break;
+        case MessageType::SNAPSHOT_ACK: {
+            auto it = clients_.find(message.playerId);
+            if (it != clients_.end()) {
+                int tick = std::atoi(message.data.c_str());
+                // Acks can arrive out of order; only move the baseline forward
+                if (tick > it->second.ackedTick && tick <= gameState_.getTick()) {
+                    it->second.ackedTick = tick;
+                }
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void GameRoom::handleReliable(const NetworkMessage& envelope) {
+    auto client = clients_.find(envelope.playerId);
+    if (client == clients_.end() || !client->second.reliable) return;
+    
+    delivered_.clear();
+    client->second.channel.receive(envelope, ReliableChannel::Clock::now(), delivered_);
+    for (const NetworkMessage& message : delivered_) {
+        // Envelopes don't nest, and a join only counts as the first message
+        if (message.type == MessageType::RELIABLE || message.type == MessageType::PLAYER_JOIN) continue;
+        handleMessage(message);
+    }
+}
+
+void GameRoom::removeClient(int playerId, const char* reason) {
+    gameState_.removePlayer(playerId);
+    auto client = clients_.find(playerId);
+    if (client == clients_.end()) return;
+    
+    // Ack anything outstanding (a leave, usually) so the client can stop resending
+    NetworkMessage ack;
+    if (client->second.reliable && client->second.channel.takeAck(ack)) {
+        output_->sendMessage(index_, ack, client->second.address);
+    }
+    
+    // The send stage drops the client's filtered view; the id may go to a new player
+    BroadcastJob& job = output_->beginJob(index_, BroadcastKind::CLIENT_LEFT);
+    job.recipients.push_back(SnapshotRecipient{playerId, client->second.address, -1, 0});
+    output_->submit();
+    
+    uint64_t addressKey = NetworkManager::addressKey(client->second.address);
+    playersByAddress_.erase(addressKey);
+    departed_.push_back(addressKey);
+    connections_.remove(playerId);
+    clients_.erase(client);
+    std::cout << "Player " << playerId << " " << reason << " room " << name_ << " ("
+              << clients_.size() << " players)" << std::endl;
+}
+
+void GameRoom::takeDeparted(std::vector<uint64_t>& addressKeys) {
+    addressKeys.insert(addressKeys.end(), departed_.begin(), departed_.end());
+    departed_.clear();
+}
+
+void GameRoom::checkConnections() {
+    timedOut_.clear();
+    pings_.clear();
+    connections_.update(ConnectionManager::Clock::now(), timedOut_, pings_);
+    
+    // A lost leave, a crash or a closed laptop: stop simulating and sending to it
+    for (int playerId : timedOut_) {
+        removeClient(playerId, "timed out of");
+    }
+    
+    for (const NetworkMessage& ping : pings_) {
+        auto client = clients_.find(ping.playerId);
+        if (client != clients_.end()) {
+            output_->sendMessage(index_, ping, client->second.address);
+        }
+    }
+}
+
+void GameRoom::flushReliable() {
+    auto now = ReliableChannel::Clock::now();
+    for (auto& client : clients_) {
+        ClientConnection& connection = client.second;
+        if (!connection.reliable) continue;
+        
+        // Acks go out bare, right after the messages they ack were handled
+        reliableOut_.clear();
+        connection.channel.update(now, reliableOut_);
+        for (const NetworkMessage& message : reliableOut_) {
+            output_->sendMessage(index_, message, connection.address);
+        }
+    }
+}
+
+int GameRoom::tick(float elapsedSeconds) {
+    // Always integrate in fixed steps; catch-up is capped inside FixedTimestep
+    int steps = timestep_.advance(elapsedSeconds);
+    for (int i = 0; i < steps; i++) {
+        applyQueuedInputs();
+        gameState_.update(timestep_.getStepSeconds());
+    }
+    
+    // Snapshots can go out at a lower rate than the simulation runs;
+    // clients interpolate remote entities between them
+    ticksSinceBroadcast_ += steps;
+    if (steps > 0 && ticksSinceBroadcast_ >= broadcastInterval()) {
+        broadcastGameState();
+        ticksSinceBroadcast_ = 0;
+    }
+    checkConnections();
+    flushReliable();
+    return steps;
+}
+
+int GameRoom::broadcastInterval() const {
+    int tickRate = timestep_.getTickRate();
+    if (settings_.snapshotRate <= 0 || settings_.snapshotRate >= tickRate) return 1;
+    return (tickRate + settings_.snapshotRate - 1) / settings_.snapshotRate;
+}
+
+void GameRoom::applyQueuedInputs() {
+    for (auto& client : clients_) {
+        ClientConnection& connection = client.second;
+        if (connection.inputs.empty()) continue; // Keep the last input's velocity
+        
+        InputCommand command = connection.inputs.front();
+        connection.inputs.pop_front();
+        
+        Player* player = gameState_.getPlayer(client.first);
+        if (!player) continue;
+        
+        if (player->isAlive()) {
+            gameState_.applyInput(player, command);
+        }
+        player->setLastInputSequence(command.sequence);
+    }
+}
+
+void GameRoom::broadcastGameState() {
+    if (clients_.empty()) return;
+    PROFILE_SCOPE("snapshot.capture"); // Inline, this includes the broadcast stage
+    
+    if (settings_.snapshotFormat == SnapshotFormat::TEXT) {
+        BroadcastJob& job = output_->beginJob(index_, BroadcastKind::MESSAGE);
+        job.message.type = MessageType::GAME_STATE_UPDATE;
+        job.message.playerId = 0; // Server message
+        job.message.data = gameState_.serialize();
+        for (const auto& client : clients_) {
+            job.recipients.push_back(SnapshotRecipient{client.first, client.second.address, -1, 0});
+        }
+        output_->submit();
+        return;
+    }
+    
+    // Snapshots carry the simulation tick they were taken at; the send stage keeps
+    // the history, picks each client's delta baseline from its acked tick and, with
+    // interest filtering, cuts the snapshot down to what's around each client
+    BroadcastJob& job = output_->beginJob(index_, BroadcastKind::BINARY_SNAPSHOT);
+    gameState_.captureSnapshot(job.snapshot);
+    job.interestFilter = settings_.interestFilter;
+    for (const auto& client : clients_) {
+        job.recipients.push_back(SnapshotRecipient{client.first, client.second.address,
+                                                   client.second.ackedTick, client.second.byteBudget});
+    }
+    output_->submit();
+}
@@ -1,20 +1,16 @@
 #include "GameState.h"
+#include "TickProfiler.h"
 #include <sstream>
 #include <algorithm>
+#include <cmath>
 
 GameState::GameState() 
-    : worldWidth_(2000), worldHeight_(1500), nextPlayerId_(1), nextBulletId_(1) {
+    : worldWidth_(2000), worldHeight_(1500), nextPlayerId_(1), nextBulletId_(1), tick_(0),
+      lagCompensation_(false), maxRewindTicks_(0), spatialHashMinPlayers_(SPATIAL_HASH_MIN_PLAYERS) {
     initializeObstacles();
 }
 
 GameState::~GameState() {
-    // Clean up all players and bullets
-    for (Player* player : players_) {
-        delete player;
-    }
-    for (Bullet* bullet : bullets_) {
-        delete bullet;
-    }
 }
 
 void GameState::addPlayer(int id, const std::string& name) {
@@ -27,209 +23,353 @@ void GameState::addPlayer(int id, const std::string& name) {
     float spawnX, spawnY;
     findValidSpawnPosition(spawnX, spawnY);
     
-    Player* newPlayer = new Player(id, name, spawnX, spawnY);
-    players_.push_back(newPlayer);
-    playerMap_[id] = newPlayer;
+    playerMap_[id] = playerPool_.emplace(id, name, spawnX, spawnY);
+    refreshPlayerList();
 }
 
 void GameState::removePlayer(int id) {
     auto it = playerMap_.find(id);
     if (it != playerMap_.end()) {
-        Player* player = it->second;
-        
-        // Remove from vector
-        players_.erase(std::remove(players_.begin(), players_.end(), player), players_.end());
-        
-        // Remove from map
+        playerPool_.erase(it->second);
         playerMap_.erase(it);
-        
-        // Delete the player object
-        delete player;
+        refreshPlayerList();
     }
 }
 
 Player* GameState::getPlayer(int id) {
     auto it = playerMap_.find(id);
-    return (it != playerMap_.end()) ? it->second : nullptr;
+    return (it != playerMap_.end()) ? playerPool_.get(it->second) : nullptr;
 }
 
-void GameState::addBullet(int id, int ownerId, float x, float y, float angle, float speed) {
-    // Check if bullet already exists
-    if (bulletMap_.find(id) != bulletMap_.end()) {
-        return;
+void GameState::refreshPlayerList() {
+    // Pool storage moves on insert and swap-remove, so rebuild the pointer view
+    players_.clear();
+    for (Player& player : playerPool_) {
+        players_.push_back(&player);
+    }
+}
+
+void GameState::addBullet(int id, int ownerId, float x, float y, float angle, float speed, int rewindTicks) {
+    if (lagCompensation_) {
+        rewindTicks = std::min(std::max(rewindTicks, 0), maxRewindTicks_);
+    } else {
+        rewindTicks = 0;
     }
     
-    Bullet* newBullet = new Bullet(id, ownerId, x, y, angle, speed);
-    bullets_.push_back(newBullet);
-    bulletMap_[id] = newBullet;
+    // Duplicate ids are ignored
+    bullets_.add(id, ownerId, x, y, std::cos(angle) * speed, std::sin(angle) * speed, rewindTicks);
 }
 
 void GameState::removeBullet(int id) {
-    auto it = bulletMap_.find(id);
-    if (it != bulletMap_.end()) {
-        Bullet* bullet = it->second;
-        
-        // Remove from vector
-        bullets_.erase(std::remove(bullets_.begin(), bullets_.end(), bullet), bullets_.end());
-        
-        // Remove from map
-        bulletMap_.erase(it);
-        
-        // Delete the bullet object
-        delete bullet;
-    }
+    bullets_.remove(id);
 }
 
-Bullet* GameState::getBullet(int id) {
-    auto it = bulletMap_.find(id);
-    return (it != bulletMap_.end()) ? it->second : nullptr;
+const std::vector<Bullet>& GameState::getAllBullets() const {
+    bulletView_.clear();
+    for (size_t i = 0; i < bullets_.size(); i++) {
+        if (bullets_.isActive(i)) {
+            bulletView_.push_back(bullets_.toBullet(i));
+        }
+    }
+    return bulletView_;
 }
 
 void GameState::update(float deltaTime) {
+    tick_++;
+    
     // Apply movement to all players with collision checking
-    for (Player* player : players_) {
-        if (!player->isAlive()) continue;
-        
-        float velX = player->getVelX();
-        float velY = player->getVelY();
-        
-        if (velX == 0 && velY == 0) continue; // No movement
-        
-        float currentX = player->getX();
-        float currentY = player->getY();
-        float newX = currentX + velX * deltaTime;
-        float newY = currentY + velY * deltaTime;
-        
-        const float playerSize = 40.0f;
-        
-        // Check if new position would collide
-        if (checkObstacleCollision(newX, newY, playerSize, playerSize)) {
-            // Try sliding along X axis only
-            if (!checkObstacleCollision(newX, currentY, playerSize, playerSize)) {
-                player->setPosition(newX, currentY);
-            }
-            // Try sliding along Y axis only
-            else if (!checkObstacleCollision(currentX, newY, playerSize, playerSize)) {
-                player->setPosition(currentX, newY);
-            }
-            // Can't move, stay in place
-            // Position unchanged
-        } else {
-            // Safe to move to new position
-            player->setPosition(newX, newY);
+    {
+        PROFILE_SCOPE("update.movement");
+        for (Player* player : players_) {
+            movePlayer(player, deltaTime);
         }
     }
     
     // Update all bullets (they move freely)
-    for (Bullet* bullet : bullets_) {
-        bullet->update(deltaTime);
+    {
+        PROFILE_SCOPE("update.bullets");
+        bullets_.integrate(deltaTime);
     }
     
     // Check collisions
     checkCollisions();
     
     // Clean up inactive bullets
-    cleanupInactiveBullets();
+    {
+        PROFILE_SCOPE("update.cleanup");
+        cleanupInactiveBullets();
+    }
     
     // Check player boundaries
-    checkPlayerBoundaries();
+    {
+        PROFILE_SCOPE("update.boundaries");
+        checkPlayerBoundaries();
+    }
+    
+    if (lagCompensation_) {
+        PROFILE_SCOPE("update.history");
+        hitboxHistory_.record(tick_, players_);
+    }
+}
+
+void GameState::movePlayer(Player* player, float deltaTime) {
+    if (!player->isAlive()) return;
+    
+    float velX = player->getVelX();
+    float velY = player->getVelY();
+    
+    if (velX == 0 && velY == 0) return; // No movement
+    
+    float currentX = player->getX();
+    float currentY = player->getY();
+    float newX = currentX + velX * deltaTime;
+    float newY = currentY + velY * deltaTime;
+    
+    const float playerSize = 40.0f;
+    
+    // Check if new position would collide
+    if (checkObstacleCollision(newX, newY, playerSize, playerSize)) {
+        // Try sliding along X axis only
+        if (!checkObstacleCollision(newX, currentY, playerSize, playerSize)) {
+            player->setPosition(newX, currentY);
+        }
+        // Try sliding along Y axis only
+        else if (!checkObstacleCollision(currentX, newY, playerSize, playerSize)) {
+            player->setPosition(currentX, newY);
+        }
+        // Can't move, stay in place
+        // Position unchanged
+    } else {
+        // Safe to move to new position
+        player->setPosition(newX, newY);
+    }
+}
+
+void GameState::applyInput(Player* player, const InputCommand& command) {
+    float velX, velY;
+    command.getVelocity(player->getSpeed(), velX, velY);
+    player->setVelocity(velX, velY);
+    player->setAngle(command.angle);
+}
+
+void GameState::simulatePlayerMovement(Player* player, float deltaTime) {
+    // The per-player part of update(): used to replay predicted inputs
+    movePlayer(player, deltaTime);
+    clampPlayerToWorld(player);
 }
 
 void GameState::checkCollisions() {
-    checkPlayerBulletCollisions();
-    checkBulletObstacleCollisions();
-    checkPlayerObstacleCollisions();
+    {
+        PROFILE_SCOPE("collision.bullets");
+        checkBulletCollisions();
+    }
+    {
+        PROFILE_SCOPE("collision.obstacles");
+        checkPlayerObstacleCollisions();
+    }
 }
 
-void GameState::checkPlayerBulletCollisions() {
-    for (Bullet* bullet : bullets_) {
-        if (!bullet->isActive()) continue;
+void GameState::checkBulletCollisions() {
+    bool useHash = players_.size() >= spatialHashMinPlayers_;
+    if (useHash) {
+        targetFrames_.resize(std::max(targetFrames_.size(), static_cast<size_t>(maxRewindTicks_) + 1));
+        for (TargetFrame& frame : targetFrames_) {
+            frame.tick = -1;
+        }
+    }
+    
+    for (size_t bullet = 0; bullet < bullets_.size(); bullet++) {
+        if (!bullets_.isActive(bullet)) continue;
         
-        for (Player* player : players_) {
-            if (!player->isAlive()) continue;
-            if (player->getId() == bullet->getOwnerId()) continue; // Don't hit yourself
-            
-            // Updated hitbox size to match new player size (40x40)
-            if (bullet->checkCollision(player->getX(), player->getY(), 40, 40)) {
-                // Hit detected
-                bool wasAlive = player->isAlive();
-                player->takeDamage(bullet->getDamage());
-                bullet->setActive(false);
-                
-                // Award kill if player died from this hit
-                if (wasAlive && !player->isAlive()) {
-                    Player* shooter = getPlayer(bullet->getOwnerId());
-                    if (shooter) {
-                        shooter->addKill();
-                    }
-                }
-                break;
+        // Bullets are swept along this tick's move so fast ones can't skip thin
+        // walls or players; whichever is hit first stops the bullet. Obstacles use
+        // a 5x5 box centered on the bullet.
+        float wallTime = 1.0f;
+        bool hitsWall = collisionMap_.sweep(bullets_.getPrevX(bullet), bullets_.getPrevY(bullet),
+                                            bullets_.getX(bullet), bullets_.getY(bullet), 2.5f, wallTime);
+        
+        // Lag-compensated bullets hit targets where the shooter saw them
+        int rewindTicks = bullets_.getRewindTicks(bullet);
+        int historyTick = tick_ - 1 - rewindTicks;
+        bool rewind = rewindTicks > 0 && hitboxHistory_.hasTick(historyTick);
+        
+        Player* player = nullptr;
+        if (useHash) {
+            size_t depth = rewind ? static_cast<size_t>(rewindTicks) : 0;
+            player = findBulletTarget(bullet, buildTargetFrame(depth, rewind ? historyTick : tick_), wallTime);
+        } else {
+            player = findBulletTarget(bullet, rewind, historyTick, wallTime);
+        }
+        
+        if (!player) {
+            if (hitsWall) {
+                bullets_.setActive(bullet, false);
+            }
+            continue;
+        }
+        
+        // Hit detected
+        bool wasAlive = player->isAlive();
+        player->takeDamage(bullets_.getDamage(bullet));
+        bullets_.setActive(bullet, false);
+        
+        // Award kill if player died from this hit
+        if (wasAlive && !player->isAlive()) {
+            Player* shooter = getPlayer(bullets_.getOwnerId(bullet));
+            if (shooter) {
+                shooter->addKill();
             }
         }
     }
 }
 
-void GameState::checkPlayerBoundaries() {
+Player* GameState::findBulletTarget(size_t bullet, bool rewind, int historyTick, float maxTime) {
+    Player* target = nullptr;
+    float earliest = maxTime;
+    
     for (Player* player : players_) {
-        float x = player->getX();
-        float y = player->getY();
-        float velX = player->getVelX();
-        float velY = player->getVelY();
-        bool positionChanged = false;
+        if (!player->isAlive()) continue;
+        if (player->getId() == bullets_.getOwnerId(bullet)) continue; // Don't hit yourself
         
-        // Keep players within world bounds (updated for 40x40 player size)
-        if (x < 0) {
-            x = 0;
-            velX = 0;
-            positionChanged = true;
+        float targetX = player->getX();
+        float targetY = player->getY();
+        if (rewind) {
+            const HitboxEntry* past = hitboxHistory_.find(historyTick, player->getId());
+            if (!past || !past->alive) continue;
+            targetX = past->x;
+            targetY = past->y;
         }
-        if (x > worldWidth_ - 40) {
-            x = worldWidth_ - 40;
-            velX = 0;
-            positionChanged = true;
+        
+        // Updated hitbox size to match new player size (40x40)
+        float time;
+        if (bullets_.sweep(bullet, targetX, targetY, 40, 40, time) && time < earliest) {
+            earliest = time;
+            target = player;
         }
-        if (y < 0) {
-            y = 0;
-            velY = 0;
-            positionChanged = true;
+    }
+    return target;
+}
+
+Player* GameState::findBulletTarget(size_t bullet, const TargetFrame& frame, float maxTime) const {
+    // Earliest hit wins, ties go to the lowest index to match the nested loop
+    uint32_t best = UINT32_MAX;
+    float earliest = maxTime;
+    int ownerId = bullets_.getOwnerId(bullet);
+    
+    float minX = std::min(bullets_.getPrevX(bullet), bullets_.getX(bullet));
+    float minY = std::min(bullets_.getPrevY(bullet), bullets_.getY(bullet));
+    float maxX = std::max(bullets_.getPrevX(bullet), bullets_.getX(bullet)) + BulletSystem::BULLET_SIZE;
+    float maxY = std::max(bullets_.getPrevY(bullet), bullets_.getY(bullet)) + BulletSystem::BULLET_SIZE;
+    
+    frame.hash.query(minX, minY, maxX - minX, maxY - minY, [&](uint32_t index) {
+        const HitTarget& target = frame.targets[index];
+        if (target.player->getId() == ownerId || !target.player->isAlive()) return;
+        
+        float time;
+        if (bullets_.sweep(bullet, target.x, target.y, 40, 40, time) && time < maxTime &&
+            (time < earliest || (time == earliest && index < best))) {
+            earliest = time;
+            best = index;
         }
-        if (y > worldHeight_ - 40) {
-            y = worldHeight_ - 40;
-            velY = 0;
-            positionChanged = true;
+    });
+    return best != UINT32_MAX ? frame.targets[best].player : nullptr;
+}
+
+const GameState::TargetFrame& GameState::buildTargetFrame(size_t rewindTicks, int historyTick) {
+    TargetFrame& frame = targetFrames_[rewindTicks];
+    if (frame.tick == historyTick) return frame;
+    
+    frame.tick = historyTick;
+    frame.targets.clear();
+    frame.hash.clear();
+    
+    if (rewindTicks == 0) {
+        for (Player* player : players_) {
+            if (!player->isAlive()) continue;
+            frame.targets.push_back(HitTarget{player, player->getX(), player->getY()});
         }
-        
-        if (positionChanged) {
-            player->setPosition(x, y);
-            player->setVelocity(velX, velY);
+    } else {
+        size_t count = 0;
+        const HitboxEntry* entries = hitboxHistory_.frame(historyTick, count);
+        for (size_t i = 0; i < count; i++) {
+            if (!entries[i].alive) continue;
+            Player* player = getPlayer(entries[i].playerId);
+            if (!player || !player->isAlive()) continue;
+            frame.targets.push_back(HitTarget{player, entries[i].x, entries[i].y});
         }
     }
+    
+    for (size_t i = 0; i < frame.targets.size(); i++) {
+        frame.hash.insert(static_cast<uint32_t>(i), frame.targets[i].x, frame.targets[i].y, 40, 40);
+    }
+    frame.hash.build();
+    return frame;
 }
 
-void GameState::cleanupInactiveBullets() {
-    for (auto it = bullets_.begin(); it != bullets_.end();) {
-        Bullet* bullet = *it;
-        if (!bullet->isActive() || bullet->isOutOfBounds(worldWidth_, worldHeight_)) {
-            // Remove from map
-            bulletMap_.erase(bullet->getId());
-            
-            // Delete and remove from vector
-            delete bullet;
-            it = bullets_.erase(it);
-        } else {
-            ++it;
-        }
+void GameState::setLagCompensation(bool enabled, int maxRewindTicks) {
+    lagCompensation_ = enabled;
+    maxRewindTicks_ = std::max(maxRewindTicks, 0);
+    
+    // Keep a little more history than the rewind window
+    hitboxHistory_ = HitboxHistory(static_cast<size_t>(maxRewindTicks_ + 2));
+}
+
+void GameState::checkPlayerBoundaries() {
+    for (Player* player : players_) {
+        clampPlayerToWorld(player);
+    }
+}
+
+void GameState::clampPlayerToWorld(Player* player) {
+    float x = player->getX();
+    float y = player->getY();
+    float velX = player->getVelX();
+    float velY = player->getVelY();
+    bool positionChanged = false;
+    
+    // Keep players within world bounds (updated for 40x40 player size)
+    if (x < 0) {
+        x = 0;
+        velX = 0;
+        positionChanged = true;
+    }
+    if (x > worldWidth_ - 40) {
+        x = worldWidth_ - 40;
+        velX = 0;
+        positionChanged = true;
+    }
+    if (y < 0) {
+        y = 0;
+        velY = 0;
+        positionChanged = true;
+    }
+    if (y > worldHeight_ - 40) {
+        y = worldHeight_ - 40;
+        velY = 0;
+        positionChanged = true;
+    }
+    
+    if (positionChanged) {
+        player->setPosition(x, y);
+        player->setVelocity(velX, velY);
     }
 }
 
+void GameState::cleanupInactiveBullets() {
+    bullets_.removeInactive(worldWidth_, worldHeight_);
+}
+
 void GameState::setWorldSize(float width, float height) {
     worldWidth_ = width;
     worldHeight_ = height;
+    collisionMap_.build(obstacles_, worldWidth_, worldHeight_);
 }
 
 std::string GameState::serialize() const {
     std::ostringstream oss;
     
+    oss << "TICK:" << tick_ << "|";
+    
     // Serialize players
     oss << "PLAYERS:" << players_.size();
     for (const Player* player : players_) {
@@ -239,19 +379,20 @@ std::string GameState::serialize() const {
             << ":" << player->getY()
             << ":" << player->getHealth()
             << ":" << (player->isAlive() ? 1 : 0)
-            << ":" << player->getAngle();
+            << ":" << player->getAngle()
+            << ":" << player->getLastInputSequence();
     }
     
     // Serialize bullets
     oss << "|BULLETS:" << bullets_.size();
-    for (const Bullet* bullet : bullets_) {
-        if (bullet->isActive()) {
-            oss << ":" << bullet->getId()
-                << ":" << bullet->getOwnerId()
-                << ":" << bullet->getX()
-                << ":" << bullet->getY()
-                << ":" << bullet->getVelX()
-                << ":" << bullet->getVelY();
+    for (size_t i = 0; i < bullets_.size(); i++) {
+        if (bullets_.isActive(i)) {
+            oss << ":" << bullets_.getId(i)
+                << ":" << bullets_.getOwnerId(i)
+                << ":" << bullets_.getX(i)
+                << ":" << bullets_.getY(i)
+                << ":" << bullets_.getVelX(i)
+                << ":" << bullets_.getVelY(i);
         }
     }
     
@@ -260,10 +401,19 @@ std::string GameState::serialize() const {
 
 void GameState::deserialize(const std::string& data) {
     // Parse the serialized game state
-    // Format: "PLAYERS:count:id:name:x:y:health:alive:angle:...|BULLETS:count:id:ownerId:x:y:..."
+    // Format: "TICK:n|PLAYERS:count:id:name:x:y:health:alive:angle:inputSeq:...|BULLETS:count:id:ownerId:x:y:..."
+    
+    WorldSnapshot snapshot;
     
-    size_t pipePos = data.find('|');
-    std::string playerData = data.substr(0, pipePos);
+    size_t bodyStart = 0;
+    if (data.compare(0, 5, "TICK:") == 0) {
+        bodyStart = data.find('|');
+        snapshot.tick = std::stoi(data.substr(5, bodyStart - 5));
+        bodyStart = (bodyStart != std::string::npos) ? bodyStart + 1 : data.size();
+    }
+    
+    size_t pipePos = data.find('|', bodyStart);
+    std::string playerData = data.substr(bodyStart, pipePos == std::string::npos ? std::string::npos : pipePos - bodyStart);
     std::string bulletData = (pipePos != std::string::npos) ? data.substr(pipePos + 1) : "";
     
     // Parse players
@@ -275,62 +425,39 @@ void GameState::deserialize(const std::string& data) {
     std::getline(playerStream, token, ':'); // count
     int playerCount = std::stoi(token);
     
-    // Clear existing players that aren't in the update
-    std::map<int, bool> updatedPlayers;
-    
     for (int i = 0; i < playerCount; i++) {
+        PlayerSnapshot player;
+        
         std::getline(playerStream, token, ':'); // id
-        int id = std::stoi(token);
+        player.id = std::stoi(token);
         
         std::getline(playerStream, token, ':'); // name
-        std::string name = token;
+        player.name = token;
         
         std::getline(playerStream, token, ':'); // x
-        float x = std::stof(token);
+        player.x = std::stof(token);
         
         std::getline(playerStream, token, ':'); // y
-        float y = std::stof(token);
+        player.y = std::stof(token);
         
         std::getline(playerStream, token, ':'); // health
-        int health = std::stoi(token);
+        player.health = std::stoi(token);
         
         std::getline(playerStream, token, ':'); // alive
-        bool alive = std::stoi(token) == 1;
+        player.alive = std::stoi(token) == 1;
         
         std::getline(playerStream, token, ':'); // angle
-        float angle = std::stof(token);
+        player.angle = std::stof(token);
         
-        // Update or add player
-        Player* player = getPlayer(id);
-        if (player == nullptr) {
-            addPlayer(id, name);
-            player = getPlayer(id);
-        }
+        std::getline(playerStream, token, ':'); // last input sequence
+        player.lastInputSequence = static_cast<uint32_t>(std::stoul(token));
         
-        if (player) {
-            player->setPosition(x, y);
-            player->setHealth(health);
-            player->setAlive(alive);
-            player->setAngle(angle);
-            updatedPlayers[id] = true;
-        }
-    }
-    
-    // Remove players that weren't in the update (disconnected players)
-    for (auto it = players_.begin(); it != players_.end();) {
-        Player* player = *it;
-        if (updatedPlayers.find(player->getId()) == updatedPlayers.end()) {
-            // Player not in update, remove them
-            playerMap_.erase(player->getId());
-            delete player;
-            it = players_.erase(it);
-        } else {
-            ++it;
-        }
+        snapshot.players.push_back(player);
     }
     
     // Parse bullets if present
-    if (!bulletData.empty()) {
+    bool hasBullets = !bulletData.empty();
+    if (hasBullets) {
         std::istringstream bulletStream(bulletData);
         
         // Skip "BULLETS:" prefix and get count
@@ -338,41 +465,117 @@ void GameState::deserialize(const std::string& data) {
         std::getline(bulletStream, token, ':'); // count
         int bulletCount = std::stoi(token);
         
-        // Clear existing bullets
-        for (auto it = bullets_.begin(); it != bullets_.end();) {
-            Bullet* bullet = *it;
-            bulletMap_.erase(bullet->getId());
-            delete bullet;
-            it = bullets_.erase(it);
-        }
-        
         for (int i = 0; i < bulletCount; i++) {
+            BulletSnapshot bullet;
+            
             std::getline(bulletStream, token, ':'); // id
-            int id = std::stoi(token);
+            bullet.id = std::stoi(token);
             
             std::getline(bulletStream, token, ':'); // ownerId
-            int ownerId = std::stoi(token);
+            bullet.ownerId = std::stoi(token);
             
             std::getline(bulletStream, token, ':'); // x
-            float x = std::stof(token);
+            bullet.x = std::stof(token);
             
             std::getline(bulletStream, token, ':'); // y
-            float y = std::stof(token);
+            bullet.y = std::stof(token);
             
             std::getline(bulletStream, token, ':'); // velX
-            float velX = std::stof(token);
+            bullet.velX = std::stof(token);
             
             std::getline(bulletStream, token, ':'); // velY
-            float velY = std::stof(token);
+            bullet.velY = std::stof(token);
             
-            // Add bullet with placeholder values, then set correct velocity
-            addBullet(id, ownerId, x, y, 0, 0);
-            Bullet* bullet = getBullet(id);
-            if (bullet) {
-                bullet->setVelocity(velX, velY);
-            }
+            snapshot.bullets.push_back(bullet);
+        }
+    }
+    
+    applySnapshot(snapshot, hasBullets);
+}
+
+void GameState::captureSnapshot(WorldSnapshot& snapshot) const {
+    snapshot.tick = tick_;
+    
+    snapshot.players.resize(players_.size());
+    for (size_t i = 0; i < players_.size(); i++) {
+        const Player* player = players_[i];
+        PlayerSnapshot& entry = snapshot.players[i];
+        entry.id = player->getId();
+        entry.name = player->getName();
+        entry.x = player->getX();
+        entry.y = player->getY();
+        entry.health = player->getHealth();
+        entry.alive = player->isAlive();
+        entry.angle = player->getAngle();
+        entry.lastInputSequence = player->getLastInputSequence();
+    }
+    
+    snapshot.bullets.clear();
+    for (size_t i = 0; i < bullets_.size(); i++) {
+        if (!bullets_.isActive(i)) continue;
+        
+        BulletSnapshot entry;
+        entry.id = bullets_.getId(i);
+        entry.ownerId = bullets_.getOwnerId(i);
+        entry.x = bullets_.getX(i);
+        entry.y = bullets_.getY(i);
+        entry.velX = bullets_.getVelX(i);
+        entry.velY = bullets_.getVelY(i);
+        snapshot.bullets.push_back(entry);
+    }
+    
+    // Delta encoding merges snapshots by id, so keep both lists ordered
+    auto byId = [](const auto& a, const auto& b) { return a.id < b.id; };
+    if (!std::is_sorted(snapshot.players.begin(), snapshot.players.end(), byId)) {
+        std::sort(snapshot.players.begin(), snapshot.players.end(), byId);
+    }
+    if (!std::is_sorted(snapshot.bullets.begin(), snapshot.bullets.end(), byId)) {
+        std::sort(snapshot.bullets.begin(), snapshot.bullets.end(), byId);
+    }
+}
+
+void GameState::applySnapshot(const WorldSnapshot& snapshot, bool replaceBullets) {
+    // Adopt the authoritative tick
+    tick_ = snapshot.tick;
+    
+    // Track which players are present in the update
+    FlatHashMap<int, bool> updatedPlayers;
+    updatedPlayers.reserve(snapshot.players.size());
+    
+    for (const PlayerSnapshot& entry : snapshot.players) {
+        // Update or add player
+        Player* player = getPlayer(entry.id);
+        if (player == nullptr) {
+            addPlayer(entry.id, entry.name);
+            player = getPlayer(entry.id);
+        }
+        
+        if (player) {
+            player->setPosition(entry.x, entry.y);
+            player->setHealth(entry.health);
+            player->setAlive(entry.alive);
+            player->setAngle(entry.angle);
+            player->setLastInputSequence(entry.lastInputSequence);
+            updatedPlayers[entry.id] = true;
+        }
+    }
+    
+    // Remove players that weren't in the update (disconnected players)
+    for (size_t i = players_.size(); i-- > 0;) {
+        int id = players_[i]->getId();
+        if (updatedPlayers.find(id) == updatedPlayers.end()) {
+            removePlayer(id);
         }
     }
+    
+    if (!replaceBullets) return;
+    
+    // Replace existing bullets
+    bullets_.clear();
+    
+    for (const BulletSnapshot& entry : snapshot.bullets) {
+        bullets_.add(entry.id, entry.ownerId, entry.x, entry.y, entry.velX, entry.velY);
+    }
 }
 
 void GameState::initializeObstacles() {
@@ -492,30 +695,12 @@ void GameState::initializeObstacles() {
     // More tactical crates
     obstacles_.push_back(Obstacle(900, 1150, 70, 70));
     obstacles_.push_back(Obstacle(1030, 1150, 70, 70));
+    
+    collisionMap_.build(obstacles_, worldWidth_, worldHeight_);
 }
 
 bool GameState::checkObstacleCollision(float x, float y, float width, float height) const {
-    for (const Obstacle& obs : obstacles_) {
-        // AABB collision detection
-        if (x < obs.x + obs.width &&
-            x + width > obs.x &&
-            y < obs.y + obs.height &&
-            y + height > obs.y) {
-            return true;
-        }
-    }
-    return false;
-}
-
-void GameState::checkBulletObstacleCollisions() {
-    for (Bullet* bullet : bullets_) {
-        if (!bullet->isActive()) continue;
-        
-        // Check if bullet hits any obstacle (bullets are small, use 5x5 hitbox)
-        if (checkObstacleCollision(bullet->getX() - 2.5f, bullet->getY() - 2.5f, 5, 5)) {
-            bullet->setActive(false);
-        }
-    }
+    return collisionMap_.overlaps(x, y, width, height);
 }
 
 void GameState::checkPlayerObstacleCollisions() {
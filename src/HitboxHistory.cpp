@@ -0,0 +1,74 @@
+#include "HitboxHistory.h"
+#include "Player.h"
+#include <algorithm>
+
+HitboxHistory::HitboxHistory(size_t capacity, size_t initialStride)
+    : capacity_(capacity > 0 ? capacity : 1), stride_(initialStride > 0 ? initialStride : 1),
+      entries_(capacity_ * stride_), frameTicks_(capacity_, -1), frameCounts_(capacity_, 0) {
+}
+
+void HitboxHistory::record(int tick, const std::vector<Player*>& players) {
+    if (tick < 0) return;
+    if (players.size() > stride_) {
+        grow(std::max(players.size(), stride_ * 2));
+    }
+    
+    size_t frame = static_cast<size_t>(tick) % capacity_;
+    HitboxEntry* entries = &entries_[frame * stride_];
+    
+    for (size_t i = 0; i < players.size(); i++) {
+        const Player* player = players[i];
+        entries[i] = HitboxEntry{player->getId(), player->getX(), player->getY(), player->isAlive()};
+    }
+    
+    // Lookups binary-search by id; players are normally already in id order
+    auto byId = [](const HitboxEntry& a, const HitboxEntry& b) { return a.playerId < b.playerId; };
+    if (!std::is_sorted(entries, entries + players.size(), byId)) {
+        std::sort(entries, entries + players.size(), byId);
+    }
+    
+    frameTicks_[frame] = tick;
+    frameCounts_[frame] = players.size();
+}
+
+void HitboxHistory::clear() {
+    std::fill(frameTicks_.begin(), frameTicks_.end(), -1);
+    std::fill(frameCounts_.begin(), frameCounts_.end(), 0);
+}
+
+bool HitboxHistory::hasTick(int tick) const {
+    return tick >= 0 && frameTicks_[static_cast<size_t>(tick) % capacity_] == tick;
+}
+
+const HitboxEntry* HitboxHistory::find(int tick, int playerId) const {
+    if (!hasTick(tick)) return nullptr;
+    
+    size_t frame = static_cast<size_t>(tick) % capacity_;
+    const HitboxEntry* begin = &entries_[frame * stride_];
+    const HitboxEntry* end = begin + frameCounts_[frame];
+    
+    const HitboxEntry* it = std::lower_bound(begin, end, playerId,
+        [](const HitboxEntry& entry, int id) { return entry.playerId < id; });
+    return (it != end && it->playerId == playerId) ? it : nullptr;
+}
+
+const HitboxEntry* HitboxHistory::frame(int tick, size_t& count) const {
+    count = 0;
+    if (!hasTick(tick)) return nullptr;
+    
+    size_t frame = static_cast<size_t>(tick) % capacity_;
+    count = frameCounts_[frame];
+    return &entries_[frame * stride_];
+}
+
+void HitboxHistory::grow(size_t stride) {
+    // Re-lay existing frames out at the wider stride
+    std::vector<HitboxEntry> entries(capacity_ * stride);
+    for (size_t frame = 0; frame < capacity_; frame++) {
+        std::copy(entries_.begin() + frame * stride_,
+                  entries_.begin() + frame * stride_ + frameCounts_[frame],
+                  entries.begin() + frame * stride);
+    }
+    entries_.swap(entries);
+    stride_ = stride;
+}
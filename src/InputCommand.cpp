@@ -0,0 +1,128 @@
+#include "InputCommand.h"
+#include "SnapshotCodec.h"
+#include <sstream>
+#include <cstdlib>
+
+enum InputButton : uint8_t {
+    BUTTON_LEFT = 1 << 0,
+    BUTTON_RIGHT = 1 << 1,
+    BUTTON_UP = 1 << 2,
+    BUTTON_DOWN = 1 << 3
+};
+
+void InputCommand::getVelocity(float speed, float& velX, float& velY) const {
+    velX = 0;
+    velY = 0;
+    
+    // Same precedence as the original key handling: right/down win ties
+    if (left) velX = -speed;
+    if (right) velX = speed;
+    if (up) velY = -speed;
+    if (down) velY = speed;
+}
+
+std::string InputCommand::toText() const {
+    std::ostringstream oss;
+    oss << "SEQ:" << sequence << ",";
+    if (isMoving()) {
+        if (left) oss << "LEFT,";
+        if (right) oss << "RIGHT,";
+        if (up) oss << "UP,";
+        if (down) oss << "DOWN,";
+    } else {
+        oss << "STOP,";
+    }
+    oss << "ANGLE:" << angle;
+    return oss.str();
+}
+
+bool InputCommand::fromText(const std::string& data, InputCommand& command) {
+    command = InputCommand();
+    
+    size_t seqPos = data.find("SEQ:");
+    if (seqPos != std::string::npos) {
+        command.sequence = static_cast<uint32_t>(std::strtoul(data.c_str() + seqPos + 4, nullptr, 10));
+    }
+    
+    // Extract angle if present
+    size_t anglePos = data.find("ANGLE:");
+    if (anglePos != std::string::npos) {
+        command.angle = std::strtof(data.c_str() + anglePos + 6, nullptr);
+    }
+    
+    if (data.find("STOP") == std::string::npos) {
+        command.left = data.find("LEFT") != std::string::npos;
+        command.right = data.find("RIGHT") != std::string::npos;
+        command.up = data.find("UP") != std::string::npos;
+        command.down = data.find("DOWN") != std::string::npos;
+    }
+    
+    return seqPos != std::string::npos || anglePos != std::string::npos;
+}
+
+void InputCommand::encodeBatch(const InputCommand* commands, size_t count, std::string& out) {
+    out.clear();
+    if (count > MAX_BATCH) {
+        commands += count - MAX_BATCH; // Keep the newest
+        count = MAX_BATCH;
+    }
+    
+    out.push_back(static_cast<char>(BATCH_MAGIC));
+    out.push_back(static_cast<char>(count));
+    
+    uint32_t newest = count > 0 ? commands[count - 1].sequence : 0;
+    while (newest >= 0x80) {
+        out.push_back(static_cast<char>((newest & 0x7F) | 0x80));
+        newest >>= 7;
+    }
+    out.push_back(static_cast<char>(newest));
+    
+    for (size_t i = count; i-- > 0;) {
+        const InputCommand& command = commands[i];
+        uint8_t buttons = (command.left ? BUTTON_LEFT : 0) | (command.right ? BUTTON_RIGHT : 0) |
+                          (command.up ? BUTTON_UP : 0) | (command.down ? BUTTON_DOWN : 0);
+        uint16_t angle = SnapshotCodec::quantizeAngle(command.angle);
+        out.push_back(static_cast<char>(buttons));
+        out.push_back(static_cast<char>(angle & 0xFF));
+        out.push_back(static_cast<char>(angle >> 8));
+    }
+}
+
+bool InputCommand::decodeBatch(const std::string& data, std::vector<InputCommand>& commands) {
+    commands.clear();
+    if (!isBatch(data) || data.size() < 3) return false;
+    
+    size_t count = static_cast<uint8_t>(data[1]);
+    size_t pos = 2;
+    uint32_t newest = 0;
+    for (int shift = 0;; shift += 7) {
+        if (pos >= data.size() || shift >= 35) return false;
+        uint8_t byte = static_cast<uint8_t>(data[pos++]);
+        newest |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) break;
+    }
+    
+    if (count == 0 || count > MAX_BATCH || count > newest || data.size() - pos != count * 3) return false;
+    
+    // Stored newest first; hand them back oldest first
+    commands.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        const char* entry = data.data() + pos + i * 3;
+        uint8_t buttons = static_cast<uint8_t>(entry[0]);
+        uint16_t angle = static_cast<uint16_t>(static_cast<uint8_t>(entry[1]) |
+                                               (static_cast<uint8_t>(entry[2]) << 8));
+        
+        InputCommand& command = commands[count - 1 - i];
+        command.sequence = newest - static_cast<uint32_t>(i);
+        command.left = (buttons & BUTTON_LEFT) != 0;
+        command.right = (buttons & BUTTON_RIGHT) != 0;
+        command.up = (buttons & BUTTON_UP) != 0;
+        command.down = (buttons & BUTTON_DOWN) != 0;
+        command.angle = SnapshotCodec::dequantizeAngle(angle);
+    }
+    return true;
+}
+
+bool InputCommand::isBatch(const std::string& data) {
+    return !data.empty() && static_cast<uint8_t>(data[0]) == BATCH_MAGIC;
+}
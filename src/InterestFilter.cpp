@@ -0,0 +1,223 @@
+#include "InterestFilter.h"
+#include <algorithm>
+#include <cmath>
+
+// Per-entry state while a view is being built
+enum EntryState : uint8_t {
+    HELD,    // Keep the values the client already has
+    REFRESH, // Send current values
+    UNSENT   // Not in the client's view yet and not chosen this time; left out
+};
+
+static const float DISTANT_WEIGHT = 0.25f;        // Priority gain off screen relative to on screen
+static const float ERROR_SCALE = 32.0f;           // Drift (px) that doubles an entity's priority gain
+static const float CHANGE_BONUS = 4.0f;           // Extra gain when velocity, health or alive changed
+static const float NEW_ENTITY_PRIORITY = 1000.0f; // Entities the client hasn't seen go first
+
+InterestFilter::InterestFilter()
+    : halfWidth_(VIEW_HALF_WIDTH), halfHeight_(VIEW_HALF_HEIGHT), margin_(VIEW_MARGIN),
+      distantUpdates_(DISTANT_UPDATES) {
+}
+
+void InterestFilter::setView(float halfWidth, float halfHeight, float margin) {
+    halfWidth_ = halfWidth;
+    halfHeight_ = halfHeight;
+    margin_ = margin;
+}
+
+void InterestFilter::update(const WorldSnapshot& full, int viewerId, int byteBudget, InterestState& state) {
+    // Players are sorted by id, so the viewer is a binary search away
+    auto viewer = std::lower_bound(full.players.begin(), full.players.end(), viewerId,
+                                   [](const PlayerSnapshot& entry, int id) { return entry.id < id; });
+    bool hasViewer = viewer != full.players.end() && viewer->id == viewerId;
+    
+    float centerX = hasViewer ? viewer->x : 0.0f;
+    float centerY = hasViewer ? viewer->y : 0.0f;
+    float reachX = halfWidth_ + margin_;
+    float reachY = halfHeight_ + margin_;
+    
+    // 1 on screen, falling off with distance beyond it
+    auto relevanceWeight = [&](float x, float y) {
+        if (!hasViewer) return 1.0f;
+        float dx = std::max(std::fabs(x - centerX) - reachX, 0.0f);
+        float dy = std::max(std::fabs(y - centerY) - reachY, 0.0f);
+        if (dx == 0.0f && dy == 0.0f) return 1.0f;
+        return DISTANT_WEIGHT * reachX / (reachX + std::sqrt(dx * dx + dy * dy));
+    };
+    
+    next_.tick = full.tick;
+    next_.players.clear();
+    next_.bullets.clear();
+    nextPlayerPriority_.clear();
+    nextBulletPriority_.clear();
+    playerState_.clear();
+    bulletState_.clear();
+    candidates_.clear();
+    
+    int remaining = byteBudget - SNAPSHOT_HEADER_BYTES;
+    
+    // Both lists are sorted by id: walk the previous view alongside the full snapshot.
+    // Every player gets an entry, so next_.players lines up with full.players.
+    const std::vector<PlayerSnapshot>& previousPlayers = state.view.players;
+    size_t held = 0;
+    size_t kept = 0; // Previous entries still in the view; the rest cost a removal
+    for (size_t i = 0; i < full.players.size(); i++) {
+        const PlayerSnapshot& entry = full.players[i];
+        while (held < previousPlayers.size() && previousPlayers[held].id < entry.id) held++;
+        bool known = held < previousPlayers.size() && previousPlayers[held].id == entry.id;
+        float weight = relevanceWeight(entry.x, entry.y);
+        
+        Candidate candidate;
+        candidate.index = i;
+        candidate.source = i;
+        candidate.bullet = false;
+        candidate.relevant = weight >= 1.0f || !known;
+        candidate.cost = PLAYER_UPDATE_BYTES;
+        
+        if (known) {
+            const PlayerSnapshot& sent = previousPlayers[held];
+            float gain = weight * (1.0f + std::hypot(entry.x - sent.x, entry.y - sent.y) / ERROR_SCALE);
+            if (entry.health != sent.health || entry.alive != sent.alive) gain += CHANGE_BONUS;
+            candidate.priority = state.playerPriority[held] + gain;
+            next_.players.push_back(sent);
+            kept++;
+            playerState_.push_back(HELD);
+        } else {
+            candidate.cost += static_cast<int>(entry.name.size()) + 2;
+            candidate.priority = NEW_ENTITY_PRIORITY + weight;
+            next_.players.push_back(entry);
+            playerState_.push_back(UNSENT);
+        }
+        nextPlayerPriority_.push_back(candidate.priority);
+        
+        if (entry.id == viewerId) {
+            // Reconciliation needs the viewer's own state every time, budget or not
+            refresh(candidate, full);
+            remaining -= candidate.cost;
+        } else {
+            candidates_.push_back(candidate);
+        }
+    }
+    
+    remaining -= static_cast<int>(previousPlayers.size() - kept) * REMOVED_ENTITY_BYTES;
+    
+    // Bullets only matter on screen, except the viewer's own
+    const std::vector<BulletSnapshot>& previousBullets = state.view.bullets;
+    held = 0;
+    kept = 0;
+    for (size_t i = 0; i < full.bullets.size(); i++) {
+        const BulletSnapshot& entry = full.bullets[i];
+        float weight = relevanceWeight(entry.x, entry.y);
+        if (weight < 1.0f && entry.ownerId != viewerId) continue;
+        
+        while (held < previousBullets.size() && previousBullets[held].id < entry.id) held++;
+        bool known = held < previousBullets.size() && previousBullets[held].id == entry.id;
+        
+        Candidate candidate;
+        candidate.index = next_.bullets.size();
+        candidate.source = i;
+        candidate.bullet = true;
+        candidate.relevant = true;
+        
+        if (known) {
+            const BulletSnapshot& sent = previousBullets[held];
+            float gain = weight * (1.0f + std::hypot(entry.x - sent.x, entry.y - sent.y) / ERROR_SCALE);
+            if (entry.velX != sent.velX || entry.velY != sent.velY) gain += CHANGE_BONUS;
+            candidate.priority = state.bulletPriority[held] + gain;
+            candidate.cost = BULLET_UPDATE_BYTES;
+            next_.bullets.push_back(sent);
+            kept++;
+            bulletState_.push_back(HELD);
+        } else {
+            candidate.priority = NEW_ENTITY_PRIORITY + weight;
+            candidate.cost = NEW_BULLET_BYTES;
+            next_.bullets.push_back(entry);
+            bulletState_.push_back(UNSENT);
+        }
+        nextBulletPriority_.push_back(candidate.priority);
+        candidates_.push_back(candidate);
+    }
+    
+    remaining -= static_cast<int>(previousBullets.size() - kept) * REMOVED_ENTITY_BYTES;
+    
+    if (byteBudget > 0) {
+        selectWithinBudget(full, remaining);
+    } else {
+        selectAll(full);
+    }
+    compact(state);
+}
+
+void InterestFilter::selectAll(const WorldSnapshot& full) {
+    // Everything on screen or new, plus the most overdue few distant players
+    size_t distant = 0;
+    for (size_t i = 0; i < candidates_.size(); i++) {
+        Candidate& candidate = candidates_[i];
+        if (candidate.relevant) {
+            refresh(candidate, full);
+        } else {
+            candidates_[distant++] = candidate; // Distant players gather at the front
+        }
+    }
+    
+    size_t refreshCount = std::min(distant, static_cast<size_t>(std::max(distantUpdates_, 0)));
+    std::partial_sort(candidates_.begin(), candidates_.begin() + refreshCount, candidates_.begin() + distant,
+                      [](const Candidate& a, const Candidate& b) { return a.priority > b.priority; });
+    for (size_t i = 0; i < refreshCount; i++) {
+        refresh(candidates_[i], full);
+    }
+}
+
+void InterestFilter::selectWithinBudget(const WorldSnapshot& full, int bytes) {
+    // Highest priority first; anything that doesn't fit waits with its priority intact
+    std::sort(candidates_.begin(), candidates_.end(),
+              [](const Candidate& a, const Candidate& b) { return a.priority > b.priority; });
+    for (const Candidate& candidate : candidates_) {
+        if (bytes < PLAYER_UPDATE_BYTES && bytes < BULLET_UPDATE_BYTES) break;
+        if (candidate.cost > bytes) continue;
+        
+        refresh(candidate, full);
+        bytes -= candidate.cost;
+    }
+}
+
+void InterestFilter::refresh(const Candidate& candidate, const WorldSnapshot& full) {
+    if (candidate.bullet) {
+        next_.bullets[candidate.index] = full.bullets[candidate.source];
+        nextBulletPriority_[candidate.index] = 0.0f;
+        bulletState_[candidate.index] = REFRESH;
+    } else {
+        next_.players[candidate.index] = full.players[candidate.source];
+        nextPlayerPriority_[candidate.index] = 0.0f;
+        playerState_[candidate.index] = REFRESH;
+    }
+}
+
+void InterestFilter::compact(InterestState& state) {
+    // Drop entries the client hasn't been sent yet; order (by id) is preserved
+    size_t kept = 0;
+    for (size_t i = 0; i < next_.players.size(); i++) {
+        if (playerState_[i] == UNSENT) continue;
+        if (kept != i) {
+            next_.players[kept] = std::move(next_.players[i]);
+            nextPlayerPriority_[kept] = nextPlayerPriority_[i];
+        }
+        kept++;
+    }
+    next_.players.resize(kept);
+    nextPlayerPriority_.resize(kept);
+    
+    kept = 0;
+    for (size_t i = 0; i < next_.bullets.size(); i++) {
+        if (bulletState_[i] == UNSENT) continue;
+        next_.bullets[kept] = next_.bullets[i];
+        nextBulletPriority_[kept] = nextBulletPriority_[i];
+        kept++;
+    }
+    next_.bullets.resize(kept);
+    nextBulletPriority_.resize(kept);
+    
+    std::swap(state.view, next_);
+    std::swap(state.playerPriority, nextPlayerPriority_);
+    std::swap(state.bulletPriority, nextBulletPriority_);
+}
@@ -0,0 +1,159 @@
+#include "LinkConditioner.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+#include <sys/socket.h>
+
+const int LinkConditioner::QUEUE_LIMIT_MS;
+
+bool LinkConditioner::parseConditions(const std::string& spec, LinkConditions& conditions) {
+    std::istringstream iss(spec);
+    std::string pair;
+    while (std::getline(iss, pair, ',')) {
+        size_t separator = pair.find('=');
+        if (separator == std::string::npos) return false;
+        
+        std::string key = pair.substr(0, separator);
+        const char* value = pair.c_str() + separator + 1;
+        char* end;
+        double number = std::strtod(value, &end);
+        if (end == value || *end != '\0' || !(number >= 0)) return false;
+        
+        // Percentages can't go past 100; the rest must fit the fields they're cast to
+        bool percent = key == "loss" || key == "dup" || key == "reorder";
+        double maximum = percent ? 100.0 : key == "seed" ? UINT32_MAX : INT_MAX;
+        if (number > maximum) return false;
+        
+        if (key == "latency") {
+            conditions.latencyMs = static_cast<int>(number);
+        } else if (key == "jitter") {
+            conditions.jitterMs = static_cast<int>(number);
+        } else if (key == "loss") {
+            conditions.lossPercent = static_cast<float>(number);
+        } else if (key == "dup") {
+            conditions.duplicatePercent = static_cast<float>(number);
+        } else if (key == "reorder") {
+            conditions.reorderPercent = static_cast<float>(number);
+        } else if (key == "kbps") {
+            conditions.bandwidthKbps = static_cast<int>(number);
+        } else if (key == "seed") {
+            if (number != std::floor(number)) return false; // 1.5 would silently be 1
+            conditions.seed = static_cast<uint32_t>(number);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+LinkConditioner::LinkConditioner(int socket, const LinkConditions& conditions)
+    : socket_(socket), conditions_(conditions), random_(conditions.seed), nextOrder_(0),
+      lastDue_(Clock::now()), linkFreeAt_(lastDue_), stopping_(false), dropped_(0), duplicated_(0), reordered_(0) {
+    thread_ = std::thread(&LinkConditioner::run, this);
+}
+
+LinkConditioner::~LinkConditioner() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    thread_.join();
+}
+
+void LinkConditioner::submit(const char* data, size_t length, const sockaddr_in& address) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (chance(conditions_.lossPercent)) {
+        dropped_++;
+        return;
+    }
+    
+    // Bandwidth: the datagram waits for the ones ahead of it to go out, and a
+    // backlog beyond the queue limit is dropped like a full router buffer would
+    Clock::time_point now = Clock::now();
+    Clock::time_point departs = now;
+    if (conditions_.bandwidthKbps > 0) {
+        auto transmit = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(length * 8.0 / (conditions_.bandwidthKbps * 1000.0)));
+        linkFreeAt_ = std::max(linkFreeAt_, now);
+        if (linkFreeAt_ - now > std::chrono::milliseconds(QUEUE_LIMIT_MS)) {
+            dropped_++;
+            return;
+        }
+        linkFreeAt_ += transmit;
+        departs = linkFreeAt_;
+    }
+    
+    Clock::time_point due = departs + std::chrono::milliseconds(conditions_.latencyMs) + randomDelay(conditions_.jitterMs);
+    if (chance(conditions_.reorderPercent)) {
+        // Held back by up to a latency (at least 20 ms) so later datagrams pass it
+        due += std::chrono::milliseconds(1) + randomDelay(std::max(conditions_.latencyMs, 20));
+        reordered_++;
+    } else {
+        due = std::max(due, lastDue_);
+        lastDue_ = due;
+    }
+    schedule(data, length, address, due);
+    
+    if (chance(conditions_.duplicatePercent)) {
+        schedule(data, length, address, due + randomDelay(std::max(conditions_.jitterMs, 1)));
+        duplicated_++;
+    }
+    wake_.notify_one();
+}
+
+size_t LinkConditioner::getDropped() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dropped_;
+}
+
+size_t LinkConditioner::getDuplicated() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return duplicated_;
+}
+
+size_t LinkConditioner::getReordered() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return reordered_;
+}
+
+bool LinkConditioner::chance(float percent) {
+    if (percent <= 0) return false;
+    return std::uniform_real_distribution<float>(0, 100)(random_) < percent;
+}
+
+LinkConditioner::Clock::duration LinkConditioner::randomDelay(int maxMs) {
+    if (maxMs <= 0) return Clock::duration::zero();
+    return std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double, std::milli>(std::uniform_real_distribution<double>(0, maxMs)(random_)));
+}
+
+void LinkConditioner::schedule(const char* data, size_t length, const sockaddr_in& address, Clock::time_point due) {
+    queue_.push(Delayed{due, nextOrder_++, std::string(data, length), address});
+}
+
+void LinkConditioner::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        if (queue_.empty()) {
+            wake_.wait(lock);
+            continue;
+        }
+        
+        Clock::time_point due = queue_.top().due;
+        if (Clock::now() < due) {
+            wake_.wait_until(lock, due);
+            continue;
+        }
+        
+        // Send outside the lock so submit() isn't held up by the syscall
+        Delayed datagram = queue_.top();
+        queue_.pop();
+        lock.unlock();
+        sendto(socket_, datagram.data.data(), datagram.data.size(), 0,
+               reinterpret_cast<const sockaddr*>(&datagram.address), sizeof(datagram.address));
+        lock.lock();
+    }
+}
@@ -3,8 +3,22 @@
 #include <arpa/inet.h>
 #include <cstring>
 #include <sstream>
+#include <algorithm>
 
-NetworkManager::NetworkManager() : socket_(-1), initialized_(false) {
+// Large enough for any UDP datagram, so nothing is silently truncated
+static const size_t RECEIVE_BUFFER_SIZE = 65536;
+
+// Batched receive slots only need to hold what our senders emit (fragments are smaller)
+static const size_t BATCH_SLOT_SIZE = 2048;
+
+// sendmmsg accepts at most this many messages per call
+static const size_t MAX_SEND_BATCH = 1024;
+
+NetworkManager::NetworkManager()
+    : socket_(-1), initialized_(false), receiveBuffer_(RECEIVE_BUFFER_SIZE),
+      batchedIO_(false), batchSize_(0), batchCount_(0), batchNext_(0),
+      sendCalls_(0), receiveCalls_(0), datagramsSent_(0), datagramsReceived_(0),
+      bytesSent_(0), bytesReceived_(0) {
     memset(&serverAddr_, 0, sizeof(serverAddr_));
 }
 
@@ -24,6 +38,7 @@ bool NetworkManager::initializeSocket() {
 }
 
 void NetworkManager::cleanup() {
+    conditioner_.reset(); // Its thread sends on the socket
     if (socket_ >= 0) {
         close(socket_);
         socket_ = -1;
@@ -37,8 +52,51 @@ bool NetworkManager::sendMessage(const NetworkMessage& message, const sockaddr_i
         return false;
     }
     
+    if (!serializeDatagrams(message, fragments_)) {
+        return false;
+    }
+    
+    for (const std::string& datagram : fragments_) {
+        if (!sendDatagram(datagram, address)) {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+bool NetworkManager::serializeDatagrams(const NetworkMessage& message, std::vector<std::string>& datagrams) {
     std::string serialized = message.serialize();
-    ssize_t bytesSent = sendto(socket_, serialized.c_str(), serialized.length(), 0,
+    if (!fragmenter_.needsFragmentation(serialized)) {
+        datagrams.resize(1);
+        datagrams[0].swap(serialized);
+        return true;
+    }
+    
+    if (!fragmenter_.split(serialized, datagrams)) {
+        setError("Message too large to fragment");
+        return false;
+    }
+    return true;
+}
+
+void NetworkManager::setLinkConditions(const LinkConditions& conditions) {
+    conditioner_.reset();
+    if (initialized_ && conditions.isActive()) {
+        conditioner_.reset(new LinkConditioner(socket_, conditions));
+    }
+}
+
+bool NetworkManager::sendDatagram(const std::string& datagram, const sockaddr_in& address) {
+    if (conditioner_) {
+        conditioner_->submit(datagram.data(), datagram.size(), address);
+        datagramsSent_++;
+        bytesSent_ += datagram.size();
+        return true;
+    }
+    
+    sendCalls_++;
+    ssize_t bytesSent = sendto(socket_, datagram.data(), datagram.length(), 0,
                               (const sockaddr*)&address, sizeof(address));
     
     if (bytesSent < 0) {
@@ -46,19 +104,175 @@ bool NetworkManager::sendMessage(const NetworkMessage& message, const sockaddr_i
         return false;
     }
     
+    datagramsSent_++;
+    bytesSent_ += static_cast<size_t>(bytesSent);
     return true;
 }
 
-bool NetworkManager::receiveMessage(NetworkMessage& message, sockaddr_in& fromAddress) {
+void NetworkManager::queueBroadcast(const NetworkMessage& message, const std::vector<sockaddr_in>& addresses) {
+    if (addresses.empty()) return;
+    if (!serializeDatagrams(message, fragments_)) return;
+    
+    for (std::string& datagram : fragments_) {
+        size_t payloadIndex = queuedPayloads_.size();
+        queuedPayloads_.push_back(std::move(datagram));
+        for (const sockaddr_in& address : addresses) {
+            queuedSends_.push_back(std::make_pair(payloadIndex, address));
+        }
+    }
+}
+
+bool NetworkManager::flushQueued() {
     if (!initialized_) {
         setError("Network manager not initialized");
         return false;
     }
     
-    char buffer[1024];
-    socklen_t fromLen = sizeof(fromAddress);
+    bool ok = true;
     
-    ssize_t bytesReceived = recvfrom(socket_, buffer, sizeof(buffer) - 1, MSG_DONTWAIT,
+#ifdef __linux__
+    if (batchedIO_ && !conditioner_) {
+        size_t capacity = std::min(queuedSends_.size(), MAX_SEND_BATCH);
+        if (sendHeaders_.size() < capacity) {
+            sendHeaders_.resize(capacity);
+            sendIovecs_.resize(capacity);
+        }
+        
+        size_t sent = 0;
+        while (sent < queuedSends_.size()) {
+            size_t count = std::min(queuedSends_.size() - sent, MAX_SEND_BATCH);
+            for (size_t i = 0; i < count; i++) {
+                auto& entry = queuedSends_[sent + i];
+                std::string& payload = queuedPayloads_[entry.first];
+                sendIovecs_[i].iov_base = &payload[0];
+                sendIovecs_[i].iov_len = payload.size();
+                memset(&sendHeaders_[i], 0, sizeof(mmsghdr));
+                sendHeaders_[i].msg_hdr.msg_name = &entry.second;
+                sendHeaders_[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+                sendHeaders_[i].msg_hdr.msg_iov = &sendIovecs_[i];
+                sendHeaders_[i].msg_hdr.msg_iovlen = 1;
+            }
+            
+            sendCalls_++;
+            int result = sendmmsg(socket_, sendHeaders_.data(), count, 0);
+            if (result <= 0) {
+                // Skip the datagram that failed so one bad peer can't stall the rest
+                setError("Failed to send message");
+                ok = false;
+                sent++;
+                continue;
+            }
+            datagramsSent_ += result;
+            for (int i = 0; i < result; i++) {
+                bytesSent_ += sendHeaders_[i].msg_len;
+            }
+            sent += result;
+        }
+        
+        queuedPayloads_.clear();
+        queuedSends_.clear();
+        return ok;
+    }
+#endif
+    
+    for (const auto& entry : queuedSends_) {
+        if (!sendDatagram(queuedPayloads_[entry.first], entry.second)) {
+            ok = false;
+        }
+    }
+    
+    queuedPayloads_.clear();
+    queuedSends_.clear();
+    return ok;
+}
+
+void NetworkManager::setBatchedIO(bool enabled, size_t batchSize) {
+#ifdef __linux__
+    batchedIO_ = enabled;
+#else
+    // No recvmmsg/sendmmsg: stay on one recvfrom/sendto per datagram
+    (void)enabled;
+    batchedIO_ = false;
+#endif
+    batchSize_ = batchedIO_ ? std::max<size_t>(batchSize, 1) : 0;
+    batchBuffers_.assign(batchSize_ * BATCH_SLOT_SIZE, 0);
+    batchAddresses_.assign(batchSize_, sockaddr_in());
+    batchLengths_.assign(batchSize_, 0);
+    batchCount_ = 0;
+    batchNext_ = 0;
+    
+#ifdef __linux__
+    // Point each header at its fixed slot once; fillBatch() only resets the fields the kernel writes
+    batchHeaders_.assign(batchSize_, mmsghdr());
+    batchIovecs_.assign(batchSize_, iovec());
+    for (size_t i = 0; i < batchSize_; i++) {
+        batchIovecs_[i].iov_base = &batchBuffers_[i * BATCH_SLOT_SIZE];
+        batchIovecs_[i].iov_len = BATCH_SLOT_SIZE;
+        batchHeaders_[i].msg_hdr.msg_name = &batchAddresses_[i];
+        batchHeaders_[i].msg_hdr.msg_iov = &batchIovecs_[i];
+        batchHeaders_[i].msg_hdr.msg_iovlen = 1;
+    }
+#endif
+}
+
+void NetworkManager::resetIOStats() {
+    sendCalls_ = 0;
+    receiveCalls_ = 0;
+    datagramsSent_ = 0;
+    datagramsReceived_ = 0;
+    bytesSent_ = 0;
+    bytesReceived_ = 0;
+}
+
+bool NetworkManager::fillBatch() {
+    batchCount_ = 0;
+    batchNext_ = 0;
+    
+#ifdef __linux__
+    for (size_t i = 0; i < batchSize_; i++) {
+        batchHeaders_[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        batchHeaders_[i].msg_hdr.msg_flags = 0;
+    }
+    
+    receiveCalls_++;
+    int result = recvmmsg(socket_, batchHeaders_.data(), batchSize_, MSG_DONTWAIT, nullptr);
+    if (result <= 0) {
+        return false;
+    }
+    
+    for (int i = 0; i < result; i++) {
+        // Oversized datagrams don't fit a slot; mark them empty so they get skipped
+        bool truncated = (batchHeaders_[i].msg_hdr.msg_flags & MSG_TRUNC) != 0;
+        batchLengths_[i] = truncated ? 0 : batchHeaders_[i].msg_len;
+        bytesReceived_ += batchHeaders_[i].msg_len;
+    }
+    batchCount_ = static_cast<size_t>(result);
+    datagramsReceived_ += batchCount_;
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool NetworkManager::nextDatagram(const char*& data, size_t& length, sockaddr_in& fromAddress) {
+    if (batchedIO_) {
+        while (true) {
+            if (batchNext_ >= batchCount_ && !fillBatch()) {
+                return false;
+            }
+            size_t slot = batchNext_++;
+            if (batchLengths_[slot] == 0) continue;
+            
+            data = &batchBuffers_[slot * BATCH_SLOT_SIZE];
+            length = batchLengths_[slot];
+            fromAddress = batchAddresses_[slot];
+            return true;
+        }
+    }
+    
+    socklen_t fromLen = sizeof(fromAddress);
+    receiveCalls_++;
+    ssize_t bytesReceived = recvfrom(socket_, receiveBuffer_.data(), receiveBuffer_.size(), MSG_DONTWAIT,
                                     (sockaddr*)&fromAddress, &fromLen);
     
     if (bytesReceived < 0) {
@@ -66,12 +280,40 @@ bool NetworkManager::receiveMessage(NetworkMessage& message, sockaddr_in& fromAd
         return false;
     }
     
-    buffer[bytesReceived] = '\0';
-    message = NetworkMessage::deserialize(std::string(buffer));
-    
+    datagramsReceived_++;
+    bytesReceived_ += static_cast<size_t>(bytesReceived);
+    data = receiveBuffer_.data();
+    length = static_cast<size_t>(bytesReceived);
     return true;
 }
 
+bool NetworkManager::receiveMessage(NetworkMessage& message, sockaddr_in& fromAddress) {
+    if (!initialized_) {
+        setError("Network manager not initialized");
+        return false;
+    }
+    
+    // Keep reading until a whole message is available or the socket is drained
+    const char* datagram;
+    size_t length;
+    while (nextDatagram(datagram, length, fromAddress)) {
+        if (PacketFragmenter::isFragment(datagram, length)) {
+            // Incomplete or stale fragments are held (or dropped) by the reassembler
+            if (!fragmenter_.addFragment(fromAddress, datagram, length, reassembled_)) {
+                continue;
+            }
+            message = NetworkMessage::deserialize(reassembled_);
+            return true;
+        }
+        
+        // Payloads may be binary, so keep the received length instead of relying on a terminator
+        message = NetworkMessage::deserialize(std::string(datagram, length));
+        return true;
+    }
+    
+    return false;
+}
+
 bool NetworkManager::bindToPort(int port) {
     if (!initialized_) {
         setError("Network manager not initialized");
@@ -92,6 +334,28 @@ bool NetworkManager::bindToPort(int port) {
     return true;
 }
 
+bool NetworkManager::setReusePort(bool enabled) {
+    if (!initialized_) {
+        setError("Network manager not initialized");
+        return false;
+    }
+    
+#ifdef SO_REUSEPORT
+    // The kernel spreads incoming datagrams across all sockets bound with this set,
+    // keeping each client address on the same socket
+    int value = enabled ? 1 : 0;
+    if (setsockopt(socket_, SOL_SOCKET, SO_REUSEPORT, &value, sizeof(value)) < 0) {
+        setError("Failed to set SO_REUSEPORT");
+        return false;
+    }
+    return true;
+#else
+    (void)enabled;
+    setError("SO_REUSEPORT not supported on this platform");
+    return false;
+#endif
+}
+
 bool NetworkManager::startListening() {
     // For UDP, no explicit listen needed
     return initialized_;
@@ -109,6 +373,10 @@ void NetworkManager::setServerAddress(const std::string& serverIP, int port) {
     serverAddr_.sin_addr.s_addr = inet_addr(serverIP.c_str());
 }
 
+uint64_t NetworkManager::addressKey(const sockaddr_in& address) {
+    return (static_cast<uint64_t>(ntohl(address.sin_addr.s_addr)) << 16) | ntohs(address.sin_port);
+}
+
 void NetworkManager::setError(const std::string& error) {
     lastError_ = error;
 }
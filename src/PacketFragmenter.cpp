@@ -0,0 +1,132 @@
+#include "PacketFragmenter.h"
+#include <algorithm>
+
+PacketFragmenter::PacketFragmenter()
+    : nextMessageId_(0), reassemblyTimeout_(1.0f), droppedMessages_(0) {
+}
+
+bool PacketFragmenter::split(const std::string& data, std::vector<std::string>& fragments) {
+    const size_t chunkSize = MAX_DATAGRAM_PAYLOAD - HEADER_SIZE;
+    size_t count = (data.size() + chunkSize - 1) / chunkSize;
+    if (count == 0 || count > MAX_FRAGMENTS) {
+        return false;
+    }
+    
+    uint16_t messageId = nextMessageId_++;
+    fragments.resize(count);
+    
+    for (size_t i = 0; i < count; i++) {
+        size_t offset = i * chunkSize;
+        size_t length = std::min(chunkSize, data.size() - offset);
+        
+        std::string& fragment = fragments[i];
+        fragment.clear();
+        fragment.reserve(HEADER_SIZE + length);
+        fragment.push_back(static_cast<char>(FRAGMENT_MAGIC));
+        fragment.push_back(static_cast<char>(messageId & 0xFF));
+        fragment.push_back(static_cast<char>(messageId >> 8));
+        fragment.push_back(static_cast<char>(i));
+        fragment.push_back(static_cast<char>(count));
+        fragment.append(data, offset, length);
+    }
+    
+    return true;
+}
+
+bool PacketFragmenter::isFragment(const char* data, size_t length) {
+    return length >= HEADER_SIZE && static_cast<uint8_t>(data[0]) == FRAGMENT_MAGIC;
+}
+
+bool PacketFragmenter::addFragment(const sockaddr_in& from, const char* data, size_t length,
+                                   std::string& completeMessage) {
+    if (!isFragment(data, length)) return false;
+    
+    uint16_t messageId = static_cast<uint16_t>(static_cast<uint8_t>(data[1]) |
+                                               (static_cast<uint8_t>(data[2]) << 8));
+    uint8_t index = static_cast<uint8_t>(data[3]);
+    uint8_t count = static_cast<uint8_t>(data[4]);
+    if (count == 0 || index >= count) return false;
+    
+    auto now = std::chrono::steady_clock::now();
+    expireStale(now);
+    
+    uint32_t address = from.sin_addr.s_addr;
+    uint16_t port = from.sin_port;
+    
+    // Find the reassembly slot for this message
+    auto it = std::find_if(pending_.begin(), pending_.end(), [&](const PendingMessage& entry) {
+        return entry.address == address && entry.port == port && entry.messageId == messageId;
+    });
+    
+    if (it != pending_.end() && it->fragmentCount != count) {
+        // Inconsistent header, start over with this fragment
+        pending_.erase(it);
+        it = pending_.end();
+        droppedMessages_++;
+    }
+    
+    if (it == pending_.end()) {
+        // Bounded table: evict the oldest partial message to make room
+        if (pending_.size() >= MAX_PENDING_MESSAGES) {
+            auto oldest = std::min_element(pending_.begin(), pending_.end(),
+                [](const PendingMessage& a, const PendingMessage& b) { return a.firstSeen < b.firstSeen; });
+            pending_.erase(oldest);
+            droppedMessages_++;
+        }
+        
+        PendingMessage entry;
+        entry.address = address;
+        entry.port = port;
+        entry.messageId = messageId;
+        entry.fragmentCount = count;
+        entry.receivedCount = 0;
+        entry.fragments.resize(count);
+        entry.received.assign(count, false);
+        entry.firstSeen = now;
+        pending_.push_back(std::move(entry));
+        it = pending_.end() - 1;
+    }
+    
+    if (it->received[index]) return false; // Duplicate
+    
+    it->fragments[index].assign(data + HEADER_SIZE, length - HEADER_SIZE);
+    it->received[index] = true;
+    it->receivedCount++;
+    
+    if (it->receivedCount < it->fragmentCount) return false;
+    
+    completeMessage.clear();
+    for (const std::string& fragment : it->fragments) {
+        completeMessage += fragment;
+    }
+    pending_.erase(it);
+    
+    // Anything older from this sender is superseded
+    dropOlderFrom(address, port, messageId);
+    return true;
+}
+
+void PacketFragmenter::expireStale(std::chrono::steady_clock::time_point now) {
+    for (auto it = pending_.begin(); it != pending_.end();) {
+        float age = std::chrono::duration<float>(now - it->firstSeen).count();
+        if (age > reassemblyTimeout_) {
+            it = pending_.erase(it);
+            droppedMessages_++;
+        } else {
+            ++it;
+        }
+    }
+}
+
+void PacketFragmenter::dropOlderFrom(uint32_t address, uint16_t port, uint16_t messageId) {
+    for (auto it = pending_.begin(); it != pending_.end();) {
+        // Wrap-around aware "older than" on the 16-bit id
+        bool older = static_cast<int16_t>(it->messageId - messageId) < 0;
+        if (it->address == address && it->port == port && older) {
+            it = pending_.erase(it);
+            droppedMessages_++;
+        } else {
+            ++it;
+        }
+    }
+}
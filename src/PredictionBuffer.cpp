@@ -0,0 +1,42 @@
+#include "PredictionBuffer.h"
+#include "GameState.h"
+#include <cmath>
+
+PredictionBuffer::PredictionBuffer(size_t capacity)
+    : commands_(capacity > 0 ? capacity : 1), start_(0), count_(0) {
+}
+
+void PredictionBuffer::record(const InputCommand& command) {
+    if (count_ == commands_.size()) {
+        // Full: the oldest input can no longer be replayed, drop it
+        start_ = (start_ + 1) % commands_.size();
+        count_--;
+    }
+    commands_[(start_ + count_) % commands_.size()] = command;
+    count_++;
+}
+
+void PredictionBuffer::clear() {
+    start_ = 0;
+    count_ = 0;
+}
+
+float PredictionBuffer::reconcile(GameState& state, Player& player, uint32_t ackedSequence,
+                                  float predictedX, float predictedY, float stepSeconds) {
+    // Forget everything the server has already applied
+    while (count_ > 0 && commands_[start_].sequence <= ackedSequence) {
+        start_ = (start_ + 1) % commands_.size();
+        count_--;
+    }
+    
+    // Replay the remaining inputs, one simulation step each
+    for (size_t i = 0; i < count_; i++) {
+        const InputCommand& command = commands_[(start_ + i) % commands_.size()];
+        state.applyInput(&player, command);
+        state.simulatePlayerMovement(&player, stepSeconds);
+    }
+    
+    float dx = player.getX() - predictedX;
+    float dy = player.getY() - predictedY;
+    return std::sqrt(dx * dx + dy * dy);
+}
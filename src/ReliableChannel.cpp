@@ -0,0 +1,251 @@
+#include "ReliableChannel.h"
+#include <algorithm>
+#include <cmath>
+
+enum EnvelopeFlags : uint8_t {
+    FLAG_RELIABLE = 1 << 0,   // Sequenced payload, delivered in order
+    FLAG_UNRELIABLE = 1 << 1, // Payload delivered on arrival
+    FLAG_ACK = 1 << 2         // ack and ackBits present
+};
+
+static void writeU16(std::string& out, uint16_t value) {
+    out.push_back(static_cast<char>(value & 0xFF));
+    out.push_back(static_cast<char>(value >> 8));
+}
+
+static void writeU32(std::string& out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+static bool readU16(const std::string& data, size_t& pos, uint16_t& value) {
+    if (pos + 2 > data.size()) return false;
+    value = static_cast<uint16_t>(static_cast<uint8_t>(data[pos]) | (static_cast<uint8_t>(data[pos + 1]) << 8));
+    pos += 2;
+    return true;
+}
+
+static bool readU32(const std::string& data, size_t& pos, uint32_t& value) {
+    if (pos + 4 > data.size()) return false;
+    value = 0;
+    for (int i = 0; i < 4; i++) {
+        value |= static_cast<uint32_t>(static_cast<uint8_t>(data[pos + i])) << (8 * i);
+    }
+    pos += 4;
+    return true;
+}
+
+// True if sequence a comes after b, allowing for wraparound
+static bool sequenceNewer(uint16_t a, uint16_t b) {
+    return static_cast<int16_t>(a - b) > 0;
+}
+
+static float secondsBetween(ReliableChannel::Clock::time_point from, ReliableChannel::Clock::time_point to) {
+    return std::chrono::duration<float>(to - from).count();
+}
+
+ReliableChannel::ReliableChannel() : ackDelay_(ACK_DELAY), playerId_(0) {
+    reset();
+}
+
+void ReliableChannel::reset() {
+    nextSequence_ = 0;
+    pending_.clear();
+    smoothedRtt_ = 0;
+    rttVariance_ = 0;
+    resendTimeout_ = INITIAL_RTO;
+    hasRttSample_ = false;
+    hasSkipped_ = false;
+    highestAcked_ = 0;
+    resends_ = 0;
+    
+    hasReceived_ = false;
+    nextDelivery_ = 0;
+    receivedBits_ = 0;
+    outOfOrder_.clear();
+    ackOwed_ = false;
+}
+
+bool ReliableChannel::send(const NetworkMessage& message, Clock::time_point now, NetworkMessage& envelope) {
+    // A peer that stopped acknowledging would otherwise grow this without bound
+    if (pending_.size() >= MAX_PENDING) return false;
+    
+    pending_.push_back(Pending{nextSequence_++, message.serialize(), message.playerId, now, now, 1});
+    const Pending& entry = pending_.back();
+    buildEnvelope(FLAG_RELIABLE, entry.sequence, entry.payload, entry.playerId, envelope);
+    return true;
+}
+
+bool ReliableChannel::wrapUnreliable(NetworkMessage& message) {
+    if (!ackOwed_) return false;
+    
+    NetworkMessage envelope;
+    buildEnvelope(FLAG_UNRELIABLE, 0, message.serialize(), message.playerId, envelope);
+    message = std::move(envelope);
+    return true;
+}
+
+bool ReliableChannel::takeAck(NetworkMessage& envelope) {
+    if (!hasReceived_) return false;
+    buildEnvelope(0, 0, std::string(), playerId_, envelope);
+    return true;
+}
+
+bool ReliableChannel::receive(const NetworkMessage& envelope, Clock::time_point now,
+                              std::vector<NetworkMessage>& delivered) {
+    const std::string& data = envelope.data;
+    if (data.empty()) return false;
+    
+    uint8_t flags = static_cast<uint8_t>(data[0]);
+    size_t pos = 1;
+    uint16_t sequence = 0;
+    if ((flags & FLAG_RELIABLE) && !readU16(data, pos, sequence)) return false;
+    
+    if (flags & FLAG_ACK) {
+        uint16_t ack;
+        uint32_t ackBits;
+        if (!readU16(data, pos, ack) || !readU32(data, pos, ackBits)) return false;
+        processAck(ack, ackBits, now);
+    }
+    
+    if (!(flags & (FLAG_RELIABLE | FLAG_UNRELIABLE))) return true; // Bare ack
+    
+    NetworkMessage inner = NetworkMessage::deserialize(data.substr(pos));
+    inner.playerId = envelope.playerId; // A peer can only speak for itself
+    
+    if (flags & FLAG_UNRELIABLE) {
+        delivered.push_back(std::move(inner));
+        return true;
+    }
+    
+    // Too far ahead to buffer: drop without acking, the peer will resend it
+    if (static_cast<uint16_t>(sequence - nextDelivery_) >= MAX_PENDING &&
+        !sequenceNewer(nextDelivery_, sequence)) {
+        return true;
+    }
+    
+    // Owe an ack even for duplicates, since the ack for the original may have been lost
+    hasReceived_ = true;
+    if (!ackOwed_) {
+        ackOwed_ = true;
+        ackOwedSince_ = now;
+    }
+    
+    // Already delivered, or already waiting for its turn
+    if (sequenceNewer(nextDelivery_, sequence) || outOfOrder_.count(sequence)) return true;
+    
+    if (sequence != nextDelivery_) {
+        uint16_t offset = static_cast<uint16_t>(sequence - nextDelivery_);
+        if (offset <= 32) receivedBits_ |= 1u << (offset - 1);
+        outOfOrder_[sequence] = std::move(inner);
+        return true;
+    }
+    
+    delivered.push_back(std::move(inner));
+    advanceDelivery();
+    for (auto it = outOfOrder_.find(nextDelivery_); it != outOfOrder_.end(); it = outOfOrder_.find(nextDelivery_)) {
+        delivered.push_back(std::move(it->second));
+        outOfOrder_.erase(it);
+        advanceDelivery();
+    }
+    return true;
+}
+
+void ReliableChannel::update(Clock::time_point now, std::vector<NetworkMessage>& outgoing) {
+    for (Pending& entry : pending_) {
+        // Back off exponentially while a message keeps getting lost, unless the peer
+        // has acked something sent after it: then it was lost rather than delayed
+        float timeout = resendTimeout_;
+        if (!hasSkipped_ || !sequenceNewer(highestAcked_, entry.sequence)) {
+            timeout = std::min(resendTimeout_ * static_cast<float>(1 << std::min(entry.sends - 1, 5)), MAX_RTO);
+        }
+        if (secondsBetween(entry.lastSent, now) < timeout) continue;
+        
+        outgoing.emplace_back();
+        buildEnvelope(FLAG_RELIABLE, entry.sequence, entry.payload, entry.playerId, outgoing.back());
+        entry.lastSent = now;
+        entry.sends++;
+        resends_++;
+    }
+    
+    if (ackOwed_ && secondsBetween(ackOwedSince_, now) >= ackDelay_) {
+        outgoing.emplace_back();
+        takeAck(outgoing.back());
+    }
+}
+
+bool ReliableChannel::peek(const NetworkMessage& envelope, NetworkMessage& inner) {
+    const std::string& data = envelope.data;
+    if (data.empty()) return false;
+    
+    uint8_t flags = static_cast<uint8_t>(data[0]);
+    size_t pos = 1 + ((flags & FLAG_RELIABLE) ? 2 : 0) + ((flags & FLAG_ACK) ? 6 : 0);
+    if (!(flags & (FLAG_RELIABLE | FLAG_UNRELIABLE)) || pos > data.size()) return false;
+    
+    inner = NetworkMessage::deserialize(data.substr(pos));
+    return true;
+}
+
+void ReliableChannel::buildEnvelope(uint8_t flags, uint16_t sequence, const std::string& payload, int playerId,
+                                    NetworkMessage& envelope) {
+    if (hasReceived_) flags |= FLAG_ACK;
+    
+    envelope.type = MessageType::RELIABLE;
+    envelope.playerId = playerId;
+    envelope.data.clear();
+    envelope.data.push_back(static_cast<char>(flags));
+    if (flags & FLAG_RELIABLE) writeU16(envelope.data, sequence);
+    if (flags & FLAG_ACK) {
+        writeU16(envelope.data, nextDelivery_);
+        writeU32(envelope.data, receivedBits_);
+        ackOwed_ = false; // Whatever this carries counts as the ack
+    }
+    envelope.data += payload;
+}
+
+void ReliableChannel::advanceDelivery() {
+    nextDelivery_++;
+    receivedBits_ >>= 1;
+    // Something buffered further ahead may have just come into range of the bitfield
+    if (!outOfOrder_.empty() && outOfOrder_.count(static_cast<uint16_t>(nextDelivery_ + 32))) {
+        receivedBits_ |= 1u << 31;
+    }
+}
+
+void ReliableChannel::processAck(uint16_t ack, uint32_t ackBits, Clock::time_point now) {
+    auto acked = [&](const Pending& entry) {
+        if (sequenceNewer(ack, entry.sequence)) return true; // Cumulative
+        uint16_t offset = static_cast<uint16_t>(entry.sequence - ack);
+        return offset >= 1 && offset <= 32 && (ackBits & (1u << (offset - 1)));
+    };
+    
+    for (auto it = pending_.begin(); it != pending_.end();) {
+        if (!acked(*it)) {
+            ++it;
+            continue;
+        }
+        if (sequenceNewer(it->sequence, ack) && (!hasSkipped_ || sequenceNewer(it->sequence, highestAcked_))) {
+            highestAcked_ = it->sequence; // Selectively acked past a gap
+            hasSkipped_ = true;
+        }
+        // Only first transmissions give an unambiguous round trip (Karn's rule)
+        if (it->sends == 1) {
+            addRttSample(secondsBetween(it->firstSent, now));
+        }
+        it = pending_.erase(it);
+    }
+}
+
+void ReliableChannel::addRttSample(float seconds) {
+    // Smoothed RTT and variance as in TCP (RFC 6298)
+    if (!hasRttSample_) {
+        smoothedRtt_ = seconds;
+        rttVariance_ = seconds / 2;
+        hasRttSample_ = true;
+    } else {
+        rttVariance_ = 0.75f * rttVariance_ + 0.25f * std::fabs(smoothedRtt_ - seconds);
+        smoothedRtt_ = 0.875f * smoothedRtt_ + 0.125f * seconds;
+    }
+    resendTimeout_ = std::max(MIN_RTO, std::min(MAX_RTO, smoothedRtt_ + 4 * rttVariance_));
+}
@@ -0,0 +1,46 @@
+#include "RollingStats.h"
+#include <algorithm>
+
+RollingStats::RollingStats(size_t capacity)
+    : samples_(capacity > 0 ? capacity : 1), next_(0), count_(0) {
+}
+
+void RollingStats::add(float sample) {
+    samples_[next_] = sample;
+    next_ = (next_ + 1) % samples_.size();
+    if (count_ < samples_.size()) {
+        count_++;
+    }
+}
+
+void RollingStats::clear() {
+    next_ = 0;
+    count_ = 0;
+}
+
+float RollingStats::percentile(float p) const {
+    if (count_ == 0) return 0.0f;
+    
+    scratch_.assign(samples_.begin(), samples_.begin() + count_);
+    if (p < 0.0f) p = 0.0f;
+    if (p > 100.0f) p = 100.0f;
+    
+    size_t index = static_cast<size_t>((p / 100.0f) * (count_ - 1) + 0.5f);
+    std::nth_element(scratch_.begin(), scratch_.begin() + index, scratch_.end());
+    return scratch_[index];
+}
+
+float RollingStats::max() const {
+    if (count_ == 0) return 0.0f;
+    return *std::max_element(samples_.begin(), samples_.begin() + count_);
+}
+
+float RollingStats::mean() const {
+    if (count_ == 0) return 0.0f;
+    
+    double total = 0.0;
+    for (size_t i = 0; i < count_; i++) {
+        total += samples_[i];
+    }
+    return static_cast<float>(total / count_);
+}
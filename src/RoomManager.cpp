@@ -0,0 +1,118 @@
+#include "RoomManager.h"
+#include "ServerWorker.h"
+#include <algorithm>
+#include <iostream>
+#include <memory>
+
+RoomManager::RoomManager(const RoomSettings& settings) : settings_(settings), openRooms_(0) {
+}
+
+void RoomManager::addWorker(ServerWorker* worker) {
+    workers_.push_back(worker);
+}
+
+ServerWorker* RoomManager::ownerOf(int roomIndex) const {
+    if (roomIndex < 0 || workers_.empty()) return nullptr;
+    return workers_[roomIndex % workers_.size()];
+}
+
+int RoomManager::placePlayer(const std::string& roomName, uint64_t addressKey) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    auto placed = placedAddresses_.find(addressKey);
+    if (placed != placedAddresses_.end()) return placed->second;
+    
+    int roomIndex = -1;
+    if (!roomName.empty()) {
+        auto it = roomsByName_.find(roomName);
+        if (it == roomsByName_.end()) {
+            if (canOpenRoom()) roomIndex = createRoom(roomName, false);
+        } else if (rooms_[it->second].players < settings_.maxPlayers) {
+            roomIndex = it->second;
+        }
+    }
+    
+    if (roomIndex < 0) {
+        // Auto-fill: pack players into the fullest public room that still has space
+        for (size_t i = 0; i < rooms_.size(); i++) {
+            const RoomInfo& room = rooms_[i];
+            if (!room.open || !room.autoFill || room.players >= settings_.maxPlayers) continue;
+            if (roomIndex < 0 || room.players > rooms_[roomIndex].players) {
+                roomIndex = static_cast<int>(i);
+            }
+        }
+    }
+    
+    if (roomIndex < 0) {
+        if (!canOpenRoom()) return -1;
+        roomIndex = createRoom("", true);
+    }
+    
+    rooms_[roomIndex].players++;
+    placedAddresses_[addressKey] = roomIndex;
+    return roomIndex;
+}
+
+void RoomManager::playerLeft(int roomIndex, uint64_t addressKey) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    placedAddresses_.erase(addressKey);
+    if (roomIndex >= 0 && roomIndex < static_cast<int>(rooms_.size()) && rooms_[roomIndex].players > 0) {
+        if (--rooms_[roomIndex].players == 0) {
+            rooms_[roomIndex].emptySince = Clock::now();
+        }
+    }
+}
+
+bool RoomManager::closeIfIdle(int roomIndex, Clock::time_point now) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (roomIndex < 0 || roomIndex >= static_cast<int>(rooms_.size())) return false;
+    
+    // A reserved place means a join is still on its way to the room
+    RoomInfo& room = rooms_[roomIndex];
+    if (!room.open || room.players > 0 || now - room.emptySince < std::chrono::seconds(settings_.emptyRoomSeconds)) {
+        return false;
+    }
+    
+    auto named = roomsByName_.find(room.name);
+    if (named != roomsByName_.end() && named->second == roomIndex) {
+        roomsByName_.erase(named);
+    }
+    room.open = false;
+    freeIndices_.push_back(roomIndex);
+    openRooms_--;
+    
+    std::cout << "Closed empty room " << room.name << std::endl;
+    return true;
+}
+
+size_t RoomManager::getRoomCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return openRooms_;
+}
+
+bool RoomManager::canOpenRoom() const {
+    return openRooms_ < static_cast<size_t>(std::min(settings_.maxRooms, static_cast<int>(MAX_ROOMS)));
+}
+
+int RoomManager::createRoom(const std::string& name, bool autoFill) {
+    int roomIndex;
+    if (!freeIndices_.empty()) {
+        roomIndex = freeIndices_.back();
+        freeIndices_.pop_back();
+    } else {
+        roomIndex = static_cast<int>(rooms_.size());
+        rooms_.push_back(RoomInfo());
+    }
+    
+    std::string roomName = autoFill ? "room-" + std::to_string(roomIndex) : name;
+    rooms_[roomIndex] = RoomInfo{roomName, 0, autoFill, true, Clock::now()};
+    roomsByName_[roomName] = roomIndex;
+    openRooms_++;
+    
+    // The owning worker adopts the room before it sees the join that follows
+    ServerWorker* owner = ownerOf(roomIndex);
+    owner->adoptRoom(std::unique_ptr<GameRoom>(new GameRoom(roomIndex, roomName, settings_)));
+    
+    std::cout << "Opened room " << roomName << " on worker " << owner->getIndex() << std::endl;
+    return roomIndex;
+}
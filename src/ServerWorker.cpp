@@ -0,0 +1,602 @@
+#include "ServerWorker.h"
+#include "RoomManager.h"
+#include <iostream>
+#include <sstream>
+#include <cctype>
+#include <climits>
+#include <cstdlib>
+#include <thread>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+const int ServerWorker::STATS_REPORT_SECONDS;
+
+// Joins arrive before the client has an id: a PLAYER_JOIN, or a reliable envelope
+// (carrying one) sent with no local player id
+static bool isJoin(const NetworkMessage& message) {
+    const int localMask = (1 << GameRoom::PLAYER_ID_BITS) - 1;
+    return message.type == MessageType::PLAYER_JOIN ||
+           (message.type == MessageType::RELIABLE && (message.playerId & localMask) == 0);
+}
+
+ServerWorker::ServerWorker(int index, RoomManager& roomManager, int tickRate)
+    : index_(index), roomManager_(roomManager), tickRate_(tickRate > 0 ? tickRate : 30),
+      running_(false), wakeFd_(-1), pipelined_(false), broadcast_(network_), inbound_(INBOUND_CAPACITY),
+      receiveNanos_(0), droppedInbound_(0), tickJitter_(static_cast<size_t>(tickRate_) * STATS_REPORT_SECONDS),
+      busySeconds_(0), simulateSeconds_(0), tickOverruns_(0), ticksSinceReport_(0),
+      totalTicks_(0), totalOverruns_(0), totalWorkSeconds_(0), reportedDatagramsIn_(0),
+      reportedDatagramsOut_(0), reportedBytesIn_(0), reportedBytesOut_(0) {
+#ifdef __linux__
+    wakeFd_ = eventfd(0, EFD_NONBLOCK);
+#endif
+}
+
+ServerWorker::~ServerWorker() {
+#ifdef __linux__
+    if (wakeFd_ >= 0) close(wakeFd_);
+#endif
+}
+
+bool ServerWorker::initialize(int port, bool reusePort, bool batchedIO, size_t batchSize) {
+    if (!network_.initializeSocket()) {
+        std::cerr << "Worker " << index_ << ": failed to initialize socket: " << network_.getLastError() << std::endl;
+        return false;
+    }
+    
+    if (reusePort && !network_.setReusePort(true)) {
+        std::cerr << "Worker " << index_ << ": " << network_.getLastError() << std::endl;
+        return false;
+    }
+    
+    if (!network_.bindToPort(port)) {
+        std::cerr << "Worker " << index_ << ": failed to bind to port: " << network_.getLastError() << std::endl;
+        return false;
+    }
+    
+    network_.setBatchedIO(batchedIO, batchSize);
+    return true;
+}
+
+void ServerWorker::run() {
+    running_ = true;
+    reportStart_ = std::chrono::steady_clock::now();
+    pinToCore();
+    TickProfiler::setCurrent(&profiler_);
+    
+    if (pipelined_ && !startPipeline()) {
+        std::cerr << "Worker " << index_ << ": pipeline not supported here, running all stages on one thread" << std::endl;
+        pipelined_ = false;
+    }
+    
+#ifdef __linux__
+    if (runEventLoop()) {
+        stopPipeline();
+        return;
+    }
+    std::cerr << "Worker " << index_ << ": falling back to polling loop" << std::endl;
+#endif
+    runPollingLoop();
+    stopPipeline();
+}
+
+void ServerWorker::stop() {
+    running_ = false;
+#ifdef __linux__
+    uint64_t one = 1;
+    if (wakeFd_ >= 0 && write(wakeFd_, &one, sizeof(one)) < 0) {
+        // Nothing to do; the loop also wakes on the next tick
+    }
+#endif
+}
+
+void ServerWorker::adoptRoom(std::unique_ptr<GameRoom> room) {
+    room->setOutput(&broadcast_);
+    {
+        std::lock_guard<std::mutex> lock(inboxMutex_);
+        adoptedRooms_.push_back(std::move(room));
+    }
+#ifdef __linux__
+    uint64_t one = 1;
+    if (wakeFd_ >= 0 && write(wakeFd_, &one, sizeof(one)) < 0) {
+        // Counter saturated; the worker is already awake
+    }
+#endif
+}
+
+void ServerWorker::post(const NetworkMessage& message, const sockaddr_in& fromAddress) {
+    bool wasEmpty;
+    {
+        std::lock_guard<std::mutex> lock(inboxMutex_);
+        wasEmpty = inbox_.empty();
+        inbox_.push_back(InboundMessage{message, fromAddress});
+    }
+#ifdef __linux__
+    // One wakeup per batch is enough; the worker drains everything queued
+    uint64_t one = 1;
+    if (wasEmpty && wakeFd_ >= 0 && write(wakeFd_, &one, sizeof(one)) < 0) {
+        // Counter saturated; the worker is already awake
+    }
+#else
+    (void)wasEmpty;
+#endif
+}
+
+#ifdef __linux__
+// Sleeps in epoll_wait until a datagram, a forwarded message or the tick timer
+// arrives, so inputs are handled on arrival and ticks follow the timerfd schedule
+bool ServerWorker::runEventLoop() {
+    const long tickNanos = 1000000000L / tickRate_;
+    const float stepSeconds = 1.0f / tickRate_;
+    
+    int epollFd = epoll_create1(0);
+    int timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+    if (epollFd < 0 || timerFd < 0 || wakeFd_ < 0) {
+        if (epollFd >= 0) close(epollFd);
+        if (timerFd >= 0) close(timerFd);
+        return false;
+    }
+    
+    itimerspec schedule = {};
+    schedule.it_interval.tv_sec = tickNanos / 1000000000L; // tv_nsec must stay below one second
+    schedule.it_interval.tv_nsec = tickNanos % 1000000000L;
+    schedule.it_value = schedule.it_interval;
+    
+    epoll_event socketEvent = {};
+    socketEvent.events = EPOLLIN;
+    socketEvent.data.fd = network_.getSocketHandle();
+    
+    epoll_event timerEvent = {};
+    timerEvent.events = EPOLLIN;
+    timerEvent.data.fd = timerFd;
+    
+    epoll_event wakeEvent = {};
+    wakeEvent.events = EPOLLIN;
+    wakeEvent.data.fd = wakeFd_;
+    
+    if (timerfd_settime(timerFd, 0, &schedule, nullptr) < 0 ||
+        (!pipelined_ && epoll_ctl(epollFd, EPOLL_CTL_ADD, socketEvent.data.fd, &socketEvent) < 0) ||
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, timerFd, &timerEvent) < 0 ||
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd_, &wakeEvent) < 0) {
+        close(epollFd);
+        close(timerFd);
+        return false;
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    uint64_t scheduledTicks = 0;
+    
+    epoll_event events[4];
+    while (running_) {
+        int count = epoll_wait(epollFd, events, 4, -1);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        
+        auto busyStart = std::chrono::steady_clock::now();
+        for (int i = 0; i < count; i++) {
+            if (events[i].data.fd == timerFd) {
+                uint64_t expirations = 0;
+                if (read(timerFd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+                    continue;
+                }
+                auto now = std::chrono::steady_clock::now();
+                
+                // Deviation from when this tick was due (missed expirations count as lateness)
+                scheduledTicks += expirations;
+                auto due = start + std::chrono::nanoseconds(tickNanos * scheduledTicks);
+                
+                // Each expiration is exactly one step of simulated time
+                drainInbound();
+                tickRooms(expirations * stepSeconds);
+                
+                float workSeconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - now).count();
+                simulateSeconds_ += workSeconds;
+                recordTick(std::chrono::duration<float, std::micro>(now - due).count(), workSeconds,
+                           static_cast<int>(expirations));
+            } else if (events[i].data.fd == wakeFd_) {
+                uint64_t value;
+                if (read(wakeFd_, &value, sizeof(value)) < 0) {
+                    // Spurious wakeup; the inbox is drained below either way
+                }
+                drainInbox();
+            } else {
+                processSocket();
+            }
+        }
+        broadcast_.publish();
+        busySeconds_ += std::chrono::duration<double>(std::chrono::steady_clock::now() - busyStart).count();
+    }
+    
+    close(epollFd);
+    close(timerFd);
+    return true;
+}
+#endif
+
+void ServerWorker::runPollingLoop() {
+    const float tickTime = 1.0f / tickRate_;
+    auto lastTick = std::chrono::steady_clock::now();
+    
+    while (running_) {
+        auto currentTime = std::chrono::steady_clock::now();
+        float deltaTime = std::chrono::duration<float>(currentTime - lastTick).count();
+        
+        drainInbox();
+        if (!pipelined_) processSocket();
+        
+        if (deltaTime >= tickTime) {
+            auto tickStart = std::chrono::steady_clock::now();
+            drainInbound();
+            tickRooms(deltaTime);
+            
+            auto done = std::chrono::steady_clock::now();
+            float workSeconds = std::chrono::duration<float>(done - currentTime).count();
+            busySeconds_ += workSeconds;
+            simulateSeconds_ += std::chrono::duration<double>(done - tickStart).count();
+            recordTick((deltaTime - tickTime) * 1000000.0f, workSeconds, static_cast<int>(deltaTime / tickTime));
+            lastTick = currentTime;
+        }
+        
+        broadcast_.publish();
+        
+        // Small sleep to prevent 100% CPU usage
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+bool ServerWorker::startPipeline() {
+#ifdef __linux__
+    if (!broadcast_.start()) return false;
+    receiveThread_ = std::thread(&ServerWorker::runReceiveLoop, this);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void ServerWorker::stopPipeline() {
+    // running_ is already false; the receive thread notices within one poll timeout
+    if (receiveThread_.joinable()) receiveThread_.join();
+    broadcast_.stop();
+}
+
+void ServerWorker::runReceiveLoop() {
+#ifdef __linux__
+    // Only this thread reads the socket; the broadcast stage only writes to it
+    pollfd socketPoll = {};
+    socketPoll.fd = network_.getSocketHandle();
+    socketPoll.events = POLLIN;
+    TickProfiler::setCurrent(&receiveProfiler_);
+    
+    // One profile sample per wakeup: everything drained from the socket in one go
+    while (running_) {
+        if (poll(&socketPoll, 1, 100) > 0) {
+            processSocket();
+            receiveProfiler_.endTick();
+        }
+    }
+#endif
+}
+
+void ServerWorker::processSocket() {
+    auto start = std::chrono::steady_clock::now();
+    PROFILE_SCOPE("messages.receive");
+    
+    NetworkMessage message;
+    sockaddr_in fromAddress;
+    while (network_.receiveMessage(message, fromAddress)) {
+        route(message, fromAddress);
+    }
+    
+    receiveNanos_ += std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+void ServerWorker::drainInbound() {
+    PROFILE_SCOPE("messages.inbound");
+    InboundMessage inbound;
+    while (inbound_.pop(inbound)) {
+        handleLocal(inbound.message, inbound.fromAddress);
+    }
+}
+
+void ServerWorker::drainInbox() {
+    PROFILE_SCOPE("messages.forwarded");
+    {
+        std::lock_guard<std::mutex> lock(inboxMutex_);
+        draining_.swap(inbox_);
+    }
+    
+    // Rooms first: a forwarded join may be waiting for its room
+    adoptPendingRooms();
+    
+    for (const InboundMessage& forwarded : draining_) {
+        handleLocal(forwarded.message, forwarded.fromAddress);
+    }
+    draining_.clear();
+}
+
+void ServerWorker::adoptPendingRooms() {
+    std::vector<std::unique_ptr<GameRoom>> adopted;
+    {
+        std::lock_guard<std::mutex> lock(inboxMutex_);
+        adopted.swap(adoptedRooms_);
+    }
+    
+    for (std::unique_ptr<GameRoom>& room : adopted) {
+        int roomIndex = room->getIndex();
+        rooms_[roomIndex] = std::move(room);
+    }
+}
+
+void ServerWorker::route(NetworkMessage& message, const sockaddr_in& fromAddress) {
+    if (message.type == MessageType::SERVER_STATS) {
+        deliverLocal(message, fromAddress); // Answered by whichever worker it reaches
+        return;
+    }
+    
+    if (isJoin(message)) {
+        // The chosen room travels in the player id
+        NetworkMessage join;
+        if (!GameRoom::unwrapJoin(message, join)) return;
+        std::string playerName, roomName;
+        int rate;
+        if (!GameRoom::parseJoin(join.data, playerName, roomName, rate)) return;
+        int roomIndex = roomManager_.placePlayer(roomName, NetworkManager::addressKey(fromAddress));
+        if (roomIndex < 0) return; // Server full; the client's resend may find a place
+        message.playerId = roomIndex << GameRoom::PLAYER_ID_BITS;
+    }
+    
+    ServerWorker* owner = roomManager_.ownerOf(GameRoom::roomOfPlayer(message.playerId));
+    if (owner == this) {
+        deliverLocal(message, fromAddress);
+    } else if (owner) {
+        owner->post(message, fromAddress);
+    }
+}
+
+void ServerWorker::deliverLocal(NetworkMessage& message, const sockaddr_in& fromAddress) {
+    if (!pipelined_) {
+        handleLocal(message, fromAddress);
+        return;
+    }
+    
+    // Pipelined: the simulation thread picks it up at the start of its next tick
+    MessageType type = message.type;
+    int roomIndex = GameRoom::roomOfPlayer(message.playerId);
+    if (!inbound_.push(InboundMessage{std::move(message), fromAddress})) {
+        droppedInbound_++;
+        // Give back the place reserved for a dropped join; a reliable one keeps it
+        // for the client's resend
+        if (type == MessageType::PLAYER_JOIN) {
+            roomManager_.playerLeft(roomIndex, NetworkManager::addressKey(fromAddress));
+        }
+    }
+}
+
+void ServerWorker::handleLocal(const NetworkMessage& message, const sockaddr_in& fromAddress) {
+    if (message.type == MessageType::SERVER_STATS) {
+        replyStats(fromAddress);
+        return;
+    }
+    
+    int roomIndex = GameRoom::roomOfPlayer(message.playerId);
+    auto it = rooms_.find(roomIndex);
+    if (it == rooms_.end()) {
+        // The room may have just been created for this join
+        adoptPendingRooms();
+        it = rooms_.find(roomIndex);
+        if (it == rooms_.end()) return;
+    }
+    
+    GameRoom& room = *it->second;
+    if (isJoin(message)) {
+        room.join(message, fromAddress);
+        return;
+    }
+    
+    room.handleMessage(message);
+    releaseDeparted(room);
+}
+
+void ServerWorker::tickRooms(float elapsedSeconds) {
+    PROFILE_SCOPE("tick");
+    auto now = RoomManager::Clock::now();
+    closedRooms_.clear();
+    for (auto& room : rooms_) {
+        room.second->tick(elapsedSeconds);
+        releaseDeparted(*room.second); // Timed out
+        
+        if (room.second->getPlayerCount() == 0 && roomManager_.closeIfIdle(room.first, now)) {
+            closedRooms_.push_back(room.first);
+        }
+    }
+    
+    // The index may already be handed out again; its new room is adopted after this
+    for (int roomIndex : closedRooms_) {
+        rooms_.erase(roomIndex);
+        broadcast_.beginJob(roomIndex, BroadcastKind::ROOM_CLOSED);
+        broadcast_.submit();
+    }
+}
+
+void ServerWorker::releaseDeparted(GameRoom& room) {
+    departed_.clear();
+    room.takeDeparted(departed_);
+    for (uint64_t addressKey : departed_) {
+        roomManager_.playerLeft(room.getIndex(), addressKey);
+    }
+}
+
+void ServerWorker::replyStats(const sockaddr_in& address) {
+    WorkerStats stats;
+    stats.worker = index_;
+    stats.tickRate = tickRate_;
+    stats.ticks = totalTicks_;
+    stats.overruns = totalOverruns_;
+    stats.workMicros = static_cast<uint64_t>(totalWorkSeconds_ * 1e6);
+    stats.rooms = static_cast<int>(rooms_.size());
+    for (const auto& room : rooms_) {
+        stats.players += static_cast<int>(room.second->getPlayerCount());
+    }
+    
+    NetworkMessage reply;
+    reply.type = MessageType::SERVER_STATS;
+    reply.playerId = 0;
+    reply.data = formatStats(stats);
+    broadcast_.sendMessage(-1, reply, address);
+}
+
+std::string ServerWorker::formatStats(const WorkerStats& stats) {
+    return std::to_string(stats.worker) + "|" + std::to_string(stats.tickRate) + "|" + std::to_string(stats.ticks) + "|" +
+           std::to_string(stats.overruns) + "|" + std::to_string(stats.workMicros) + "|" + std::to_string(stats.rooms) +
+           "|" + std::to_string(stats.players);
+}
+
+bool ServerWorker::parseStats(const std::string& data, WorkerStats& stats) {
+    uint64_t values[7];
+    size_t count = 0;
+    size_t start = 0;
+    while (start <= data.size()) {
+        size_t end = data.find('|', start);
+        if (end == std::string::npos) end = data.size();
+        
+        // Every field is an unsigned decimal, nothing else
+        const char* field = data.c_str() + start;
+        char* parsed;
+        if (count == 7 || end == start || !std::isdigit(static_cast<unsigned char>(*field))) return false;
+        values[count++] = std::strtoull(field, &parsed, 10);
+        if (parsed != data.c_str() + end) return false;
+        start = end + 1;
+    }
+    if (count != 7 || values[0] > INT_MAX || values[1] > INT_MAX || values[5] > INT_MAX || values[6] > INT_MAX) {
+        return false;
+    }
+    
+    stats.worker = static_cast<int>(values[0]);
+    stats.tickRate = static_cast<int>(values[1]);
+    stats.ticks = values[2];
+    stats.overruns = values[3];
+    stats.workMicros = values[4];
+    stats.rooms = static_cast<int>(values[5]);
+    stats.players = static_cast<int>(values[6]);
+    return true;
+}
+
+void ServerWorker::recordTick(float deviationMicros, float workSeconds, int ticks) {
+    tickJitter_.add(deviationMicros < 0 ? -deviationMicros : deviationMicros);
+    if (workSeconds > 1.0f / tickRate_) {
+        tickOverruns_++;
+        totalOverruns_++;
+    }
+    totalTicks_ += ticks;
+    totalWorkSeconds_ += workSeconds;
+    profiler_.endTick();
+    
+    // Periodic report so load and scheduling can be checked per core. Timed by the
+    // clock: an overloaded worker coalesces timer expirations into fewer ticks.
+    ticksSinceReport_ += ticks;
+    auto now = std::chrono::steady_clock::now();
+    if (now - reportStart_ >= std::chrono::seconds(STATS_REPORT_SECONDS)) {
+        double wallSeconds = std::chrono::duration<double>(now - reportStart_).count();
+        
+        size_t players = 0;
+        float rttTotal = 0, rttMax = 0;
+        size_t rttCount = 0;
+        for (const auto& room : rooms_) {
+            players += room.second->getPlayerCount();
+            room.second->getConnections().accumulateRtt(rttTotal, rttMax, rttCount);
+        }
+        
+        // Per-stage cost of a tick. Inline, broadcasting runs inside the room ticks.
+        double receiveSeconds = receiveNanos_.exchange(0) / 1e9;
+        double broadcastSeconds = broadcast_.takeBusySeconds();
+        double simulateSeconds = simulateSeconds_;
+        if (!broadcast_.isThreaded()) {
+            simulateSeconds = simulateSeconds > broadcastSeconds ? simulateSeconds - broadcastSeconds : 0;
+        }
+        double microsPerTick = ticksSinceReport_ > 0 ? 1000000.0 / ticksSinceReport_ : 0;
+        
+        std::ostringstream report;
+        report << "Worker " << index_ << ": " << static_cast<int>(100.0 * busySeconds_ / wallSeconds) << "% busy, "
+               << rooms_.size() << " rooms, " << players << " players, "
+               << tickOverruns_ << " tick overruns, jitter (us) p50=" << tickJitter_.percentile(50)
+               << " p99=" << tickJitter_.percentile(99) << " max=" << tickJitter_.max()
+               << ", us/tick receive=" << static_cast<int>(receiveSeconds * microsPerTick)
+               << " simulate=" << static_cast<int>(simulateSeconds * microsPerTick)
+               << " broadcast=" << static_cast<int>(broadcastSeconds * microsPerTick);
+        if (rttCount > 0) {
+            report << ", rtt (ms) avg=" << 1000 * rttTotal / rttCount << " max=" << 1000 * rttMax;
+        }
+        uint64_t dropped = droppedInbound_.exchange(0);
+        if (dropped > 0) {
+            report << ", " << dropped << " inbound drops";
+        }
+        report << "\n";
+        if (TickProfiler::isEnabled()) {
+            reportProfile(report, wallSeconds, players);
+        }
+        std::cout << report.str() << std::flush;
+        
+        busySeconds_ = 0;
+        simulateSeconds_ = 0;
+        tickOverruns_ = 0;
+        ticksSinceReport_ = 0;
+        reportStart_ = now;
+    }
+}
+
+void ServerWorker::reportProfile(std::ostream& out, double wallSeconds, size_t players) {
+    size_t bullets = 0;
+    for (const auto& room : rooms_) {
+        bullets += room.second->getGameState().getBullets().size();
+    }
+    
+    // Traffic since the last report; the socket is shared by this worker's threads
+    size_t datagramsIn = network_.getDatagramsReceived();
+    size_t datagramsOut = network_.getDatagramsSent();
+    size_t bytesIn = network_.getBytesReceived();
+    size_t bytesOut = network_.getBytesSent();
+    out << "Worker " << index_ << " profile: " << players << " players, " << bullets << " bullets, datagrams/s in="
+        << static_cast<int>((datagramsIn - reportedDatagramsIn_) / wallSeconds)
+        << " out=" << static_cast<int>((datagramsOut - reportedDatagramsOut_) / wallSeconds)
+        << ", KB/s in=" << static_cast<int>((bytesIn - reportedBytesIn_) / wallSeconds / 1024)
+        << " out=" << static_cast<int>((bytesOut - reportedBytesOut_) / wallSeconds / 1024) << "\n";
+    reportedDatagramsIn_ = datagramsIn;
+    reportedDatagramsOut_ = datagramsOut;
+    reportedBytesIn_ = bytesIn;
+    reportedBytesOut_ = bytesOut;
+    
+    profiler_.report(out, "  ");
+    if (receiveThread_.joinable()) {
+        receiveProfiler_.report(out, "  receive thread: ");
+    }
+    if (broadcast_.isThreaded()) {
+        broadcast_.getProfiler().report(out, "  send thread: ");
+    }
+}
+
+void ServerWorker::pinToCore() {
+#ifdef __linux__
+    // One worker per core keeps each room's state in one core's cache
+    if (roomManager_.getWorkerCount() <= 1) return;
+    
+    unsigned cores = std::thread::hardware_concurrency();
+    if (cores == 0) return;
+    
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(index_ % cores, &cpus);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+#endif
+}
@@ -0,0 +1,72 @@
+#include "SlotMap.h"
+
+SlotIndex::SlotIndex() : freeHead_(NONE) {
+}
+
+void SlotIndex::reserve(size_t capacity) {
+    slots_.reserve(capacity);
+    denseToSlot_.reserve(capacity);
+}
+
+void SlotIndex::clear() {
+    // Retire every live slot so outstanding handles go stale, keeping capacity
+    for (size_t i = 0; i < denseToSlot_.size(); i++) {
+        release(i);
+    }
+    denseToSlot_.clear();
+}
+
+SlotHandle SlotIndex::acquire() {
+    uint32_t slot;
+    if (freeHead_ != NONE) {
+        slot = freeHead_;
+        freeHead_ = slots_[slot].denseIndex;
+    } else {
+        slot = static_cast<uint32_t>(slots_.size());
+        slots_.push_back(Slot{0, 0});
+    }
+    
+    slots_[slot].denseIndex = static_cast<uint32_t>(denseToSlot_.size());
+    denseToSlot_.push_back(slot);
+    return SlotHandle{slot, slots_[slot].generation};
+}
+
+size_t SlotIndex::eraseAt(size_t i) {
+    size_t last = denseToSlot_.size() - 1;
+    release(i);
+    if (i != last) {
+        relocate(last, i);
+    }
+    denseToSlot_.pop_back();
+    return last;
+}
+
+void SlotIndex::release(size_t i) {
+    uint32_t slot = denseToSlot_[i];
+    slots_[slot].generation++;
+    slots_[slot].denseIndex = freeHead_;
+    freeHead_ = slot;
+}
+
+void SlotIndex::relocate(size_t from, size_t to) {
+    uint32_t slot = denseToSlot_[from];
+    denseToSlot_[to] = slot;
+    slots_[slot].denseIndex = static_cast<uint32_t>(to);
+}
+
+void SlotIndex::truncate(size_t size) {
+    denseToSlot_.resize(size);
+}
+
+int SlotIndex::denseIndex(SlotHandle handle) const {
+    if (handle.index >= slots_.size()) return -1;
+    
+    const Slot& slot = slots_[handle.index];
+    if (slot.generation != handle.generation) return -1;
+    return static_cast<int>(slot.denseIndex);
+}
+
+SlotHandle SlotIndex::handleAt(size_t i) const {
+    uint32_t slot = denseToSlot_[i];
+    return SlotHandle{slot, slots_[slot].generation};
+}
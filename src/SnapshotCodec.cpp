@@ -0,0 +1,385 @@
+#include "SnapshotCodec.h"
+#include <cmath>
+#include <algorithm>
+
+static const float POSITION_SCALE = 8.0f; // 1/8 unit precision
+static const float PI = 3.14159265358979f;
+
+// Low-level writers
+static void writeU8(std::string& out, uint8_t value) {
+    out.push_back(static_cast<char>(value));
+}
+
+static void writeU16(std::string& out, uint16_t value) {
+    out.push_back(static_cast<char>(value & 0xFF));
+    out.push_back(static_cast<char>(value >> 8));
+}
+
+static void writeVarint(std::string& out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+// Low-level readers (return false when the buffer runs out)
+static bool readU8(const std::string& data, size_t& pos, uint8_t& value) {
+    if (pos + 1 > data.size()) return false;
+    value = static_cast<uint8_t>(data[pos++]);
+    return true;
+}
+
+static bool readU16(const std::string& data, size_t& pos, uint16_t& value) {
+    if (pos + 2 > data.size()) return false;
+    value = static_cast<uint16_t>(static_cast<uint8_t>(data[pos]) |
+                                  (static_cast<uint8_t>(data[pos + 1]) << 8));
+    pos += 2;
+    return true;
+}
+
+static bool readVarint(const std::string& data, size_t& pos, uint32_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (pos >= data.size()) return false;
+        uint8_t byte = static_cast<uint8_t>(data[pos++]);
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+int16_t SnapshotCodec::quantizePosition(float value) {
+    float scaled = std::round(value * POSITION_SCALE);
+    if (scaled > 32767.0f) scaled = 32767.0f;
+    if (scaled < -32768.0f) scaled = -32768.0f;
+    return static_cast<int16_t>(scaled);
+}
+
+float SnapshotCodec::dequantizePosition(int16_t value) {
+    return value / POSITION_SCALE;
+}
+
+uint16_t SnapshotCodec::quantizeAngle(float angle) {
+    // Map [-pi, pi) onto the full 16-bit range, wrapping anything outside it
+    float normalized = (angle + PI) / (2.0f * PI);
+    normalized -= std::floor(normalized);
+    return static_cast<uint16_t>(static_cast<uint32_t>(std::round(normalized * 65536.0f)) & 0xFFFF);
+}
+
+float SnapshotCodec::dequantizeAngle(uint16_t value) {
+    return (value / 65536.0f) * 2.0f * PI - PI;
+}
+
+enum SnapshotKind : uint8_t {
+    KIND_FULL = 0,
+    KIND_DELTA = 1
+};
+
+// Per-field bits used by delta entries
+enum PlayerField : uint8_t {
+    PLAYER_NAME = 1 << 0,
+    PLAYER_X = 1 << 1,
+    PLAYER_Y = 1 << 2,
+    PLAYER_ANGLE = 1 << 3,
+    PLAYER_STATUS = 1 << 4,
+    PLAYER_INPUT = 1 << 5,
+    PLAYER_ALL = 0x3F
+};
+
+enum BulletField : uint8_t {
+    BULLET_OWNER = 1 << 0,
+    BULLET_X = 1 << 1,
+    BULLET_Y = 1 << 2,
+    BULLET_VEL_X = 1 << 3,
+    BULLET_VEL_Y = 1 << 4,
+    BULLET_ALL = 0x1F
+};
+
+static uint8_t packStatus(const PlayerSnapshot& player) {
+    // Health fits in 7 bits, alive flag takes the top bit
+    int health = player.health < 0 ? 0 : (player.health > 127 ? 127 : player.health);
+    return static_cast<uint8_t>(health | (player.alive ? 0x80 : 0));
+}
+
+// Fields are compared after quantization so "unchanged" means unchanged on the wire
+static uint8_t diffPlayer(const PlayerSnapshot& base, const PlayerSnapshot& current) {
+    uint8_t mask = 0;
+    if (base.name != current.name) mask |= PLAYER_NAME;
+    if (SnapshotCodec::quantizePosition(base.x) != SnapshotCodec::quantizePosition(current.x)) mask |= PLAYER_X;
+    if (SnapshotCodec::quantizePosition(base.y) != SnapshotCodec::quantizePosition(current.y)) mask |= PLAYER_Y;
+    if (SnapshotCodec::quantizeAngle(base.angle) != SnapshotCodec::quantizeAngle(current.angle)) mask |= PLAYER_ANGLE;
+    if (packStatus(base) != packStatus(current)) mask |= PLAYER_STATUS;
+    if (base.lastInputSequence != current.lastInputSequence) mask |= PLAYER_INPUT;
+    return mask;
+}
+
+static uint8_t diffBullet(const BulletSnapshot& base, const BulletSnapshot& current) {
+    uint8_t mask = 0;
+    if (base.ownerId != current.ownerId) mask |= BULLET_OWNER;
+    if (SnapshotCodec::quantizePosition(base.x) != SnapshotCodec::quantizePosition(current.x)) mask |= BULLET_X;
+    if (SnapshotCodec::quantizePosition(base.y) != SnapshotCodec::quantizePosition(current.y)) mask |= BULLET_Y;
+    if (SnapshotCodec::quantizePosition(base.velX) != SnapshotCodec::quantizePosition(current.velX)) mask |= BULLET_VEL_X;
+    if (SnapshotCodec::quantizePosition(base.velY) != SnapshotCodec::quantizePosition(current.velY)) mask |= BULLET_VEL_Y;
+    return mask;
+}
+
+static void writePosition(std::string& out, float value) {
+    writeU16(out, static_cast<uint16_t>(SnapshotCodec::quantizePosition(value)));
+}
+
+static bool readPosition(const std::string& data, size_t& pos, float& value) {
+    uint16_t raw;
+    if (!readU16(data, pos, raw)) return false;
+    value = SnapshotCodec::dequantizePosition(static_cast<int16_t>(raw));
+    return true;
+}
+
+static void writePlayerFields(std::string& out, const PlayerSnapshot& player, uint8_t mask) {
+    if (mask & PLAYER_NAME) {
+        writeVarint(out, static_cast<uint32_t>(player.name.size()));
+        out.append(player.name);
+    }
+    if (mask & PLAYER_X) writePosition(out, player.x);
+    if (mask & PLAYER_Y) writePosition(out, player.y);
+    if (mask & PLAYER_ANGLE) writeU16(out, SnapshotCodec::quantizeAngle(player.angle));
+    if (mask & PLAYER_STATUS) writeU8(out, packStatus(player));
+    if (mask & PLAYER_INPUT) writeVarint(out, player.lastInputSequence);
+}
+
+static bool readPlayerFields(const std::string& data, size_t& pos, PlayerSnapshot& player, uint8_t mask) {
+    if (mask & PLAYER_NAME) {
+        uint32_t nameLength;
+        if (!readVarint(data, pos, nameLength) || nameLength > data.size() - pos) return false;
+        player.name.assign(data, pos, nameLength);
+        pos += nameLength;
+    }
+    if ((mask & PLAYER_X) && !readPosition(data, pos, player.x)) return false;
+    if ((mask & PLAYER_Y) && !readPosition(data, pos, player.y)) return false;
+    if (mask & PLAYER_ANGLE) {
+        uint16_t angle;
+        if (!readU16(data, pos, angle)) return false;
+        player.angle = SnapshotCodec::dequantizeAngle(angle);
+    }
+    if (mask & PLAYER_STATUS) {
+        uint8_t status;
+        if (!readU8(data, pos, status)) return false;
+        player.health = status & 0x7F;
+        player.alive = (status & 0x80) != 0;
+    }
+    if ((mask & PLAYER_INPUT) && !readVarint(data, pos, player.lastInputSequence)) return false;
+    return true;
+}
+
+static void writeBulletFields(std::string& out, const BulletSnapshot& bullet, uint8_t mask) {
+    if (mask & BULLET_OWNER) writeVarint(out, static_cast<uint32_t>(bullet.ownerId));
+    if (mask & BULLET_X) writePosition(out, bullet.x);
+    if (mask & BULLET_Y) writePosition(out, bullet.y);
+    if (mask & BULLET_VEL_X) writePosition(out, bullet.velX);
+    if (mask & BULLET_VEL_Y) writePosition(out, bullet.velY);
+}
+
+static bool readBulletFields(const std::string& data, size_t& pos, BulletSnapshot& bullet, uint8_t mask) {
+    if (mask & BULLET_OWNER) {
+        uint32_t ownerId;
+        if (!readVarint(data, pos, ownerId)) return false;
+        bullet.ownerId = static_cast<int>(ownerId);
+    }
+    if ((mask & BULLET_X) && !readPosition(data, pos, bullet.x)) return false;
+    if ((mask & BULLET_Y) && !readPosition(data, pos, bullet.y)) return false;
+    if ((mask & BULLET_VEL_X) && !readPosition(data, pos, bullet.velX)) return false;
+    if ((mask & BULLET_VEL_Y) && !readPosition(data, pos, bullet.velY)) return false;
+    return true;
+}
+
+// Merge two id-sorted entity lists, writing removals followed by changed/new entries
+template <typename Entity, typename DiffFn, typename WriteFn>
+static void writeEntityDelta(std::string& out, const std::vector<Entity>& base, const std::vector<Entity>& current,
+                             uint8_t allMask, DiffFn diff, WriteFn writeFields) {
+    std::vector<int> removed;
+    std::vector<std::pair<size_t, uint8_t>> changed;
+    
+    size_t b = 0, c = 0;
+    while (b < base.size() || c < current.size()) {
+        if (c == current.size() || (b < base.size() && base[b].id < current[c].id)) {
+            removed.push_back(base[b].id);
+            b++;
+        } else if (b == base.size() || current[c].id < base[b].id) {
+            changed.push_back(std::make_pair(c, allMask));
+            c++;
+        } else {
+            uint8_t mask = diff(base[b], current[c]);
+            if (mask != 0) {
+                changed.push_back(std::make_pair(c, mask));
+            }
+            b++;
+            c++;
+        }
+    }
+    
+    writeVarint(out, static_cast<uint32_t>(removed.size()));
+    for (int id : removed) {
+        writeVarint(out, static_cast<uint32_t>(id));
+    }
+    
+    writeVarint(out, static_cast<uint32_t>(changed.size()));
+    for (const auto& entry : changed) {
+        const Entity& entity = current[entry.first];
+        writeVarint(out, static_cast<uint32_t>(entity.id));
+        writeU8(out, entry.second);
+        writeFields(out, entity, entry.second);
+    }
+}
+
+// Rebuild an entity list from its baseline plus the removals/changes in the delta
+template <typename Entity, typename ReadFn>
+static bool readEntityDelta(const std::string& data, size_t& pos, const std::vector<Entity>& base,
+                            std::vector<Entity>& result, uint8_t allMask, ReadFn readFields) {
+    uint32_t removedCount;
+    if (!readVarint(data, pos, removedCount) || removedCount > data.size() - pos) return false;
+    
+    std::vector<int> removed(removedCount);
+    for (uint32_t i = 0; i < removedCount; i++) {
+        uint32_t id;
+        if (!readVarint(data, pos, id)) return false;
+        removed[i] = static_cast<int>(id);
+    }
+    std::sort(removed.begin(), removed.end());
+    
+    result.clear();
+    result.reserve(base.size());
+    for (const Entity& entity : base) {
+        if (!std::binary_search(removed.begin(), removed.end(), entity.id)) {
+            result.push_back(entity);
+        }
+    }
+    
+    uint32_t changedCount;
+    if (!readVarint(data, pos, changedCount) || changedCount > (data.size() - pos) / 2) return false;
+    
+    for (uint32_t i = 0; i < changedCount; i++) {
+        uint32_t id;
+        uint8_t mask;
+        if (!readVarint(data, pos, id) || !readU8(data, pos, mask)) return false;
+        
+        auto it = std::lower_bound(result.begin(), result.end(), static_cast<int>(id),
+                                   [](const Entity& entity, int value) { return entity.id < value; });
+        if (it == result.end() || it->id != static_cast<int>(id)) {
+            // New entities must carry every field
+            if ((mask & allMask) != allMask) return false;
+            Entity entity = Entity();
+            entity.id = static_cast<int>(id);
+            it = result.insert(it, entity);
+        }
+        if (!readFields(data, pos, *it, mask)) return false;
+    }
+    return true;
+}
+
+static void writeHeader(std::string& out, uint8_t kind, int tick) {
+    writeU8(out, SnapshotCodec::MAGIC);
+    writeU8(out, SnapshotCodec::VERSION);
+    writeU8(out, kind);
+    writeVarint(out, static_cast<uint32_t>(tick));
+}
+
+void SnapshotCodec::encode(const WorldSnapshot& snapshot, std::string& out) {
+    out.clear();
+    out.reserve(8 + snapshot.players.size() * 24 + snapshot.bullets.size() * 12);
+    
+    writeHeader(out, KIND_FULL, snapshot.tick);
+    
+    writeVarint(out, static_cast<uint32_t>(snapshot.players.size()));
+    for (const PlayerSnapshot& player : snapshot.players) {
+        writeVarint(out, static_cast<uint32_t>(player.id));
+        writePlayerFields(out, player, PLAYER_ALL);
+    }
+    
+    writeVarint(out, static_cast<uint32_t>(snapshot.bullets.size()));
+    for (const BulletSnapshot& bullet : snapshot.bullets) {
+        writeVarint(out, static_cast<uint32_t>(bullet.id));
+        writeBulletFields(out, bullet, BULLET_ALL);
+    }
+}
+
+void SnapshotCodec::encodeDelta(const WorldSnapshot& baseline, const WorldSnapshot& snapshot, std::string& out) {
+    out.clear();
+    
+    writeHeader(out, KIND_DELTA, snapshot.tick);
+    writeVarint(out, static_cast<uint32_t>(baseline.tick));
+    
+    writeEntityDelta(out, baseline.players, snapshot.players, PLAYER_ALL, diffPlayer, writePlayerFields);
+    writeEntityDelta(out, baseline.bullets, snapshot.bullets, BULLET_ALL, diffBullet, writeBulletFields);
+}
+
+bool SnapshotCodec::decode(const std::string& data, WorldSnapshot& snapshot, const SnapshotHistory* history) {
+    size_t pos = 0;
+    uint8_t magic, version, kind;
+    uint32_t tick;
+    if (!readU8(data, pos, magic) || magic != MAGIC) return false;
+    if (!readU8(data, pos, version) || version != VERSION) return false;
+    if (!readU8(data, pos, kind) || !readVarint(data, pos, tick)) return false;
+    
+    if (kind == KIND_DELTA) {
+        uint32_t baselineTick;
+        if (!readVarint(data, pos, baselineTick)) return false;
+        
+        // Without the baseline the delta is useless; the server falls back to a full snapshot
+        const WorldSnapshot* baseline = history ? history->find(static_cast<int>(baselineTick)) : nullptr;
+        if (baseline == nullptr || baseline == &snapshot) return false;
+        
+        snapshot.tick = static_cast<int>(tick);
+        if (!readEntityDelta(data, pos, baseline->players, snapshot.players, PLAYER_ALL, readPlayerFields)) return false;
+        if (!readEntityDelta(data, pos, baseline->bullets, snapshot.bullets, BULLET_ALL, readBulletFields)) return false;
+        return pos == data.size();
+    }
+    
+    if (kind != KIND_FULL) return false;
+    
+    snapshot.clear();
+    snapshot.tick = static_cast<int>(tick);
+    
+    uint32_t playerCount;
+    if (!readVarint(data, pos, playerCount)) return false;
+    // Every player takes at least 10 bytes, reject counts the buffer can't hold
+    if (playerCount > (data.size() - pos) / 10) return false;
+    snapshot.players.resize(playerCount);
+    
+    for (PlayerSnapshot& player : snapshot.players) {
+        uint32_t id;
+        if (!readVarint(data, pos, id)) return false;
+        player.id = static_cast<int>(id);
+        if (!readPlayerFields(data, pos, player, PLAYER_ALL)) return false;
+    }
+    
+    uint32_t bulletCount;
+    if (!readVarint(data, pos, bulletCount)) return false;
+    // Every bullet takes at least 10 bytes
+    if (bulletCount > (data.size() - pos) / 10) return false;
+    snapshot.bullets.resize(bulletCount);
+    
+    for (BulletSnapshot& bullet : snapshot.bullets) {
+        uint32_t id;
+        if (!readVarint(data, pos, id)) return false;
+        bullet.id = static_cast<int>(id);
+        if (!readBulletFields(data, pos, bullet, BULLET_ALL)) return false;
+    }
+    
+    return pos == data.size();
+}
+
+bool SnapshotCodec::isBinary(const std::string& data) {
+    return !data.empty() && static_cast<uint8_t>(data[0]) == MAGIC;
+}
+
+bool SnapshotCodec::parseFormat(const std::string& name, SnapshotFormat& format) {
+    if (name == "binary") {
+        format = SnapshotFormat::BINARY;
+        return true;
+    }
+    if (name == "text") {
+        format = SnapshotFormat::TEXT;
+        return true;
+    }
+    return false;
+}
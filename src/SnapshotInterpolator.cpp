@@ -0,0 +1,160 @@
+#include "SnapshotInterpolator.h"
+#include "GameState.h"
+#include <cmath>
+
+static const float PI = 3.14159265358979f;
+
+// Drift of the render clock beyond this snaps it back instead of easing
+static const float MAX_CLOCK_DRIFT = 0.25f;
+
+static float lerpAngle(float from, float to, float t) {
+    float diff = to - from;
+    while (diff > PI) diff -= 2.0f * PI;
+    while (diff < -PI) diff += 2.0f * PI;
+    return from + diff * t;
+}
+
+void SnapshotInterpolator::Track::push(const Sample& sample) {
+    if (count == SAMPLE_COUNT) {
+        start = (start + 1) % SAMPLE_COUNT;
+        count--;
+    }
+    samples[(start + count) % SAMPLE_COUNT] = sample;
+    count++;
+}
+
+SnapshotInterpolator::SnapshotInterpolator()
+    : delay_(0.1f), maxExtrapolation_(0.25f), renderTime_(0), latestServerTime_(0),
+      hasTime_(false), snapshotCount_(0) {
+}
+
+void SnapshotInterpolator::addSnapshot(const GameState& state, float serverTime, int localPlayerId) {
+    // Out-of-order snapshots would break the time ordering of the rings
+    if (hasTime_ && serverTime <= latestServerTime_) return;
+    
+    snapshotCount_++;
+    
+    for (const Player* player : state.getAllPlayers()) {
+        if (player->getId() == localPlayerId) continue; // Predicted, not interpolated
+        
+        Track& track = players_[player->getId()];
+        if (!player->isAlive()) {
+            // Don't blend across death and respawn
+            track.count = 0;
+        }
+        track.push(Sample{serverTime, player->getX(), player->getY(), player->getAngle()});
+        track.lastSeenSnapshot = snapshotCount_;
+    }
+    
+    const BulletSystem& bullets = state.getBullets();
+    for (size_t i = 0; i < bullets.size(); i++) {
+        Track& track = bullets_[bullets.getId(i)];
+        track.push(Sample{serverTime, bullets.getX(i), bullets.getY(i), 0});
+        track.lastSeenSnapshot = snapshotCount_;
+    }
+    
+    prune(players_);
+    prune(bullets_);
+    
+    latestServerTime_ = serverTime;
+    if (!hasTime_) {
+        renderTime_ = serverTime - delay_;
+        hasTime_ = true;
+    }
+}
+
+void SnapshotInterpolator::apply(GameState& state, float deltaTime, int localPlayerId) {
+    if (!hasTime_) return;
+    
+    // Advance with the local clock, easing toward "newest snapshot minus delay"
+    renderTime_ += deltaTime;
+    float target = latestServerTime_ - delay_;
+    float drift = target - renderTime_;
+    if (std::fabs(drift) > MAX_CLOCK_DRIFT) {
+        renderTime_ = target;
+    } else {
+        renderTime_ += drift * 0.1f;
+    }
+    
+    Sample result;
+    
+    for (Player* player : state.getAllPlayers()) {
+        if (player->getId() == localPlayerId) continue;
+        
+        auto it = players_.find(player->getId());
+        if (it != players_.end() && sample(it->second, renderTime_, result)) {
+            player->setPosition(result.x, result.y);
+            player->setAngle(result.angle);
+        }
+    }
+    
+    BulletSystem& bullets = state.getBullets();
+    for (size_t i = 0; i < bullets.size(); i++) {
+        auto it = bullets_.find(bullets.getId(i));
+        if (it != bullets_.end() && sample(it->second, renderTime_, result)) {
+            bullets.setPosition(i, result.x, result.y);
+        }
+    }
+}
+
+void SnapshotInterpolator::clear() {
+    players_.clear();
+    bullets_.clear();
+    hasTime_ = false;
+    renderTime_ = 0;
+    latestServerTime_ = 0;
+}
+
+bool SnapshotInterpolator::sample(const Track& track, float time, Sample& out) const {
+    if (track.count == 0) return false;
+    
+    const Sample& oldest = track.at(0);
+    const Sample& newest = track.at(track.count - 1);
+    
+    if (time <= oldest.time || track.count == 1) {
+        // Entity is newer than the render time (just spawned) or has a single sample
+        out = time <= oldest.time ? oldest : newest;
+        return true;
+    }
+    
+    if (time >= newest.time) {
+        // Ran out of data: continue the last motion for a short while, then hold
+        const Sample& previous = track.at(track.count - 2);
+        float span = newest.time - previous.time;
+        float ahead = std::fmin(time - newest.time, maxExtrapolation_);
+        float t = span > 0 ? ahead / span : 0;
+        out.time = time;
+        out.x = newest.x + (newest.x - previous.x) * t;
+        out.y = newest.y + (newest.y - previous.y) * t;
+        out.angle = newest.angle;
+        return true;
+    }
+    
+    for (size_t i = 1; i < track.count; i++) {
+        const Sample& to = track.at(i);
+        if (to.time < time) continue;
+        
+        const Sample& from = track.at(i - 1);
+        float span = to.time - from.time;
+        float t = span > 0 ? (time - from.time) / span : 1.0f;
+        out.time = time;
+        out.x = from.x + (to.x - from.x) * t;
+        out.y = from.y + (to.y - from.y) * t;
+        out.angle = lerpAngle(from.angle, to.angle, t);
+        return true;
+    }
+    
+    out = newest;
+    return true;
+}
+
+void SnapshotInterpolator::prune(std::unordered_map<int, Track>& tracks) {
+    // Drop entities that were missing from the latest snapshot
+    for (auto it = tracks.begin(); it != tracks.end();) {
+        if (it->second.lastSeenSnapshot != snapshotCount_) {
+            it = tracks.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
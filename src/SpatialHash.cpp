@@ -0,0 +1,54 @@
+#include "SpatialHash.h"
+#include <algorithm>
+
+SpatialHash::SpatialHash(float cellSize)
+    : cellSize_(cellSize > 0 ? cellSize : 64.0f), inverseCellSize_(1.0f / cellSize_), bucketMask_(0) {
+}
+
+void SpatialHash::clear() {
+    staged_.clear();
+    bucketStart_.clear();
+    entries_.clear();
+}
+
+void SpatialHash::insert(uint32_t item, float x, float y, float width, float height) {
+    staged_.push_back(Staged{item, cellCoord(x), cellCoord(y), cellCoord(x + width), cellCoord(y + height)});
+}
+
+void SpatialHash::build() {
+    // Roughly one cell entry per bucket keeps chains short
+    size_t cellEntries = 0;
+    for (const Staged& s : staged_) {
+        cellEntries += static_cast<size_t>(s.c1 - s.c0 + 1) * (s.r1 - s.r0 + 1);
+    }
+    size_t bucketCount = 64;
+    while (bucketCount < cellEntries) bucketCount <<= 1;
+    bucketMask_ = bucketCount - 1;
+    
+    bucketStart_.assign(bucketCount + 1, 0);
+    for (const Staged& s : staged_) {
+        for (int r = s.r0; r <= s.r1; r++) {
+            for (int c = s.c0; c <= s.c1; c++) {
+                bucketStart_[hashCell(c, r) + 1]++;
+            }
+        }
+    }
+    for (size_t b = 0; b < bucketCount; b++) {
+        bucketStart_[b + 1] += bucketStart_[b];
+    }
+    
+    // clear() leaves entries_ empty, so resize() alone would grow it to exactly the
+    // new high-water mark each time; double it instead so rebuilds stop allocating
+    if (entries_.capacity() < cellEntries) {
+        entries_.reserve(std::max(cellEntries, entries_.capacity() * 2));
+    }
+    entries_.resize(cellEntries);
+    cursor_.assign(bucketStart_.begin(), bucketStart_.end() - 1);
+    for (const Staged& s : staged_) {
+        for (int r = s.r0; r <= s.r1; r++) {
+            for (int c = s.c0; c <= s.c1; c++) {
+                entries_[cursor_[hashCell(c, r)]++] = s.item;
+            }
+        }
+    }
+}
@@ -0,0 +1,74 @@
+#include "TickProfiler.h"
+#include <cstring>
+
+std::atomic<bool> TickProfiler::enabled_(false);
+
+static std::mutex sectionsMutex;
+static const char* sectionNames[TickProfiler::MAX_SECTIONS];
+static std::atomic<int> sectionCount(0);
+
+static thread_local TickProfiler* currentProfiler = nullptr;
+
+TickProfiler::TickProfiler()
+    : anyTouched_(false), samples_(MAX_SECTIONS, RollingStats(SAMPLE_CAPACITY)) {
+    for (int i = 0; i < MAX_SECTIONS; i++) {
+        tickNanos_[i] = 0;
+        touched_[i] = false;
+    }
+}
+
+int TickProfiler::registerSection(const char* name) {
+    std::lock_guard<std::mutex> lock(sectionsMutex);
+    int count = sectionCount.load();
+    
+    // The same name from two call sites is one section
+    for (int i = 0; i < count; i++) {
+        if (std::strcmp(sectionNames[i], name) == 0) return i;
+    }
+    if (count >= MAX_SECTIONS) return -1;
+    
+    sectionNames[count] = name;
+    sectionCount.store(count + 1);
+    return count;
+}
+
+TickProfiler* TickProfiler::current() {
+    return currentProfiler;
+}
+
+void TickProfiler::setCurrent(TickProfiler* profiler) {
+    currentProfiler = profiler;
+}
+
+void TickProfiler::add(int section, uint64_t nanos) {
+    tickNanos_[section] += nanos;
+    touched_[section] = true;
+    anyTouched_ = true;
+}
+
+void TickProfiler::endTick() {
+    if (!anyTouched_) return;
+    
+    std::lock_guard<std::mutex> lock(samplesMutex_);
+    int count = sectionCount.load();
+    for (int i = 0; i < count; i++) {
+        if (!touched_[i]) continue;
+        samples_[i].add(tickNanos_[i] / 1000.0f);
+        tickNanos_[i] = 0;
+        touched_[i] = false;
+    }
+    anyTouched_ = false;
+}
+
+void TickProfiler::report(std::ostream& out, const char* prefix) {
+    std::lock_guard<std::mutex> lock(samplesMutex_);
+    int count = sectionCount.load();
+    for (int i = 0; i < count; i++) {
+        RollingStats& stats = samples_[i];
+        if (stats.count() == 0) continue;
+        
+        out << prefix << sectionNames[i] << " (us, " << stats.count() << " samples) p50=" << stats.percentile(50)
+            << " p95=" << stats.percentile(95) << " p99=" << stats.percentile(99) << " max=" << stats.max() << "\n";
+        stats.clear();
+    }
+}
@@ -0,0 +1,111 @@
+#include "TestHarness.h"
+#include "GameState.h"
+#include <cstdlib>
+#include <new>
+#include <string>
+
+// Counts heap allocations made while a tick runs. The replacement operator new
+// only exists in the test binary; it counts while enabled and otherwise just
+// forwards to malloc.
+
+namespace {
+
+bool countingEnabled = false;
+size_t allocationCount = 0;
+
+const int WARM_UP_TICKS = 300;
+const int MEASURED_TICKS = 300;
+const int SHOTS_PER_TICK = 20;
+
+void populate(GameState& state, int players) {
+    std::srand(11);
+    state.setLagCompensation(true, 6);
+    for (int id = 1; id <= players; id++) {
+        state.addPlayer(id, "bot" + std::to_string(id));
+    }
+}
+
+// One server step at a high fire rate: everyone keeps moving, a few players shoot
+// each tick (some rewound, as lagged shooters are) and the dead respawn
+void runTick(GameState& state, int players, int tick, int& nextBulletId) {
+    for (int i = 0; i < SHOTS_PER_TICK; i++) {
+        int shooter = 1 + (tick * SHOTS_PER_TICK + i) % players;
+        Player* player = state.getPlayer(shooter);
+        if (!player || !player->isAlive()) continue;
+        float angle = static_cast<float>((tick * 37 + i * 53) % 628) / 100.0f;
+        state.addBullet(nextBulletId++, shooter, player->getX() + 20, player->getY() + 20, angle, 400.0f, i % 4);
+    }
+    
+    for (Player* player : state.getAllPlayers()) {
+        if (!player->isAlive()) {
+            state.respawnPlayer(player->getId());
+            continue;
+        }
+        InputCommand command;
+        command.left = (tick / 15 + player->getId()) % 4 == 0;
+        command.right = (tick / 15 + player->getId()) % 4 == 2;
+        command.up = (tick / 10 + player->getId()) % 3 == 0;
+        command.down = (tick / 10 + player->getId()) % 3 == 1;
+        state.applyInput(player, command);
+    }
+    
+    state.update(1.0f / 30.0f);
+}
+
+size_t countSteadyStateAllocations(int players, bool churnPlayers) {
+    GameState state;
+    populate(state, players);
+    int nextBulletId = 1;
+    
+    int tick = 0;
+    for (; tick < WARM_UP_TICKS; tick++) {
+        runTick(state, players, tick, nextBulletId);
+    }
+    
+    allocationCount = 0;
+    countingEnabled = true;
+    for (; tick < WARM_UP_TICKS + MEASURED_TICKS; tick++) {
+        if (churnPlayers) {
+            // A player leaves and another takes the freed slot
+            int id = 1 + tick % players;
+            state.removePlayer(id);
+            state.addPlayer(id, "rejoined");
+        }
+        runTick(state, players, tick, nextBulletId);
+    }
+    countingEnabled = false;
+    return allocationCount;
+}
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    if (countingEnabled) allocationCount++;
+    void* memory = std::malloc(size > 0 ? size : 1);
+    if (!memory) throw std::bad_alloc();
+    return memory;
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+TEST_CASE(allocation, no_allocations_per_tick_nested_loop) {
+    // Below GameState's spatial hash threshold
+    size_t allocations = countSteadyStateAllocations(8, false);
+    CHECK_MSG(allocations == 0, std::to_string(allocations) + " allocations");
+}
+
+TEST_CASE(allocation, no_allocations_per_tick_spatial_hash) {
+    size_t allocations = countSteadyStateAllocations(32, false);
+    CHECK_MSG(allocations == 0, std::to_string(allocations) + " allocations");
+}
+
+TEST_CASE(allocation, no_allocations_when_players_rejoin) {
+    size_t allocations = countSteadyStateAllocations(32, true);
+    CHECK_MSG(allocations == 0, std::to_string(allocations) + " allocations");
+}
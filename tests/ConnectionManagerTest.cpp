@@ -0,0 +1,165 @@
+#include "TestHarness.h"
+#include "ConnectionManager.h"
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Timeouts, pings and RTT, on a clock the test moves by hand
+
+namespace {
+
+typedef ConnectionManager::Clock Clock;
+
+const Clock::time_point START = Clock::time_point() + std::chrono::hours(1);
+
+Clock::time_point at(int millis) {
+    return START + std::chrono::milliseconds(millis);
+}
+
+bool near(float a, float b) {
+    return std::fabs(a - b) < 1e-5f;
+}
+
+// Runs one update and returns the ping sent to playerId, or "" if none was due
+std::string pingFor(ConnectionManager& connections, int playerId, Clock::time_point now) {
+    std::vector<int> timedOut;
+    std::vector<NetworkMessage> pings;
+    connections.update(now, timedOut, pings);
+    for (const NetworkMessage& ping : pings) {
+        if (ping.playerId == playerId) return ping.data;
+    }
+    return "";
+}
+
+} // namespace
+
+TEST_CASE(connection, silent_clients_time_out) {
+    ConnectionManager connections(5.0f);
+    connections.add(1, at(0));
+    connections.add(2, at(0));
+    connections.heard(1, at(4000));
+    
+    std::vector<int> timedOut;
+    std::vector<NetworkMessage> pings;
+    connections.update(at(5000), timedOut, pings);
+    CHECK(timedOut.empty()); // Silent for exactly the timeout is still alive
+    
+    connections.update(at(6000), timedOut, pings);
+    CHECK(timedOut.size() == 1 && timedOut[0] == 2);
+    connections.remove(2);
+    CHECK(connections.find(2) == nullptr);
+    
+    // Anything heard restarts the clock
+    connections.heard(1, at(8000));
+    timedOut.clear();
+    connections.update(at(12999), timedOut, pings);
+    CHECK(timedOut.empty());
+    connections.update(at(13001), timedOut, pings);
+    CHECK(timedOut.size() == 1 && timedOut[0] == 1);
+    
+    // Timeout 0 keeps everyone
+    connections.setTimeout(0);
+    timedOut.clear();
+    connections.update(at(600000), timedOut, pings);
+    CHECK(timedOut.empty());
+}
+
+TEST_CASE(connection, pings_once_per_interval) {
+    ConnectionManager connections;
+    connections.add(1, at(0));
+    CHECK(pingFor(connections, 1, at(0)) == "1"); // Right away
+    CHECK(pingFor(connections, 1, at(500)) == "");
+    CHECK(pingFor(connections, 1, at(999)) == "");
+    CHECK(pingFor(connections, 1, at(1000)) == "2");
+    CHECK(pingFor(connections, 1, at(1500)) == "");
+    CHECK(pingFor(connections, 1, at(2100)) == "3");
+}
+
+TEST_CASE(connection, rtt_and_jitter_smoothing) {
+    ConnectionManager connections;
+    connections.add(1, at(0));
+    CHECK(connections.getRtt(1) == 0 && !connections.find(1)->hasRtt);
+    
+    // First sample is taken as is
+    std::string id = pingFor(connections, 1, at(0));
+    CHECK(connections.handlePong(1, id, at(100)));
+    CHECK(near(connections.getRtt(1), 0.100f));
+    CHECK(near(connections.getJitter(1), 0.0f));
+    
+    // Then rtt moves 1/8 of the way to each sample, jitter 1/16 of the way to the change
+    id = pingFor(connections, 1, at(1000));
+    CHECK(connections.handlePong(1, id, at(1180)));
+    CHECK(near(connections.getRtt(1), 0.100f + (0.180f - 0.100f) / 8));
+    CHECK(near(connections.getJitter(1), 0.080f / 16));
+    
+    float rtt = connections.getRtt(1);
+    float jitter = connections.getJitter(1);
+    id = pingFor(connections, 1, at(2000));
+    CHECK(connections.handlePong(1, id, at(2120)));
+    CHECK(near(connections.getRtt(1), rtt + (0.120f - rtt) / 8));
+    CHECK(near(connections.getJitter(1), jitter + (0.060f - jitter) / 16));
+    
+    // A steady link settles: rtt on the sample, jitter towards 0
+    for (int second = 3; second < 200; second++) {
+        id = pingFor(connections, 1, at(second * 1000));
+        connections.heard(1, at(second * 1000 + 50));
+        connections.handlePong(1, id, at(second * 1000 + 50));
+    }
+    CHECK(near(connections.getRtt(1), 0.050f));
+    CHECK(connections.getJitter(1) < 1e-4f);
+    
+    float total = 0, maximum = 0;
+    size_t count = 0;
+    connections.add(2, at(0)); // Not measured yet, left out
+    connections.accumulateRtt(total, maximum, count);
+    CHECK(count == 1 && near(total, 0.050f) && near(maximum, 0.050f));
+}
+
+TEST_CASE(connection, rejects_duplicate_and_unknown_pongs) {
+    ConnectionManager connections;
+    connections.add(1, at(0));
+    std::string first = pingFor(connections, 1, at(0));
+    
+    CHECK(connections.handlePong(1, first, at(100)));
+    CHECK(!connections.handlePong(1, first, at(150))); // Duplicated on the way back
+    CHECK(near(connections.getRtt(1), 0.100f));
+    
+    CHECK(!connections.handlePong(1, "0", at(200)));
+    CHECK(!connections.handlePong(1, "", at(200)));
+    CHECK(!connections.handlePong(1, "garbage", at(200)));
+    CHECK(!connections.handlePong(1, "99", at(200)));  // Never sent
+    CHECK(!connections.handlePong(7, first, at(200))); // Unknown player
+    
+    // Pings outlive PING_HISTORY newer ones only until their slot is reused
+    std::vector<std::string> ids;
+    for (int i = 1; i <= ConnectionManager::PING_HISTORY + 1; i++) {
+        ids.push_back(pingFor(connections, 1, at(i * 1000)));
+    }
+    CHECK(!connections.handlePong(1, ids[0], at(7000)));
+    CHECK(connections.handlePong(1, ids[1], at(7000)));
+    CHECK(connections.handlePong(1, ids.back(), at(7000)));
+    CHECK(!connections.handlePong(1, ids.back(), at(7001)));
+}
+
+TEST_CASE(connection, ping_ids_wrap_past_zero) {
+    ConnectionManager connections;
+    connections.add(1, at(0), UINT32_MAX - 2);
+    
+    std::vector<std::string> ids;
+    for (int i = 0; i < 5; i++) {
+        ids.push_back(pingFor(connections, 1, at(i * 1000)));
+    }
+    CHECK(ids[0] == std::to_string(UINT32_MAX - 2));
+    CHECK(ids[2] == std::to_string(UINT32_MAX));
+    CHECK(ids[3] == "1"); // 0 means "no ping" and is skipped
+    CHECK(ids[4] == "2");
+    
+    // Pings from both sides of the wrap match; the oldest shares a slot with 1
+    CHECK(!connections.handlePong(1, ids[0], at(4100)));
+    CHECK(connections.handlePong(1, ids[2], at(4100)));
+    CHECK(connections.handlePong(1, ids[3], at(4100)));
+    CHECK(connections.handlePong(1, ids[4], at(4100)));
+    CHECK(!connections.handlePong(1, "0", at(4100)));
+    CHECK(near(connections.find(1)->lastSample, 0.100f));
+}
@@ -0,0 +1,265 @@
+#include "TestHarness.h"
+#include "InterestFilter.h"
+#include "GameState.h"
+#include "SnapshotCodec.h"
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace {
+
+const float STEP = 1.0f / 30.0f;
+
+PlayerSnapshot player(int id, float x, float y) {
+    PlayerSnapshot snapshot;
+    snapshot.id = id;
+    snapshot.name = "p" + std::to_string(id);
+    snapshot.x = x;
+    snapshot.y = y;
+    snapshot.health = 100;
+    snapshot.alive = true;
+    snapshot.angle = 0;
+    snapshot.lastInputSequence = 0;
+    return snapshot;
+}
+
+BulletSnapshot bullet(int id, int ownerId, float x, float y) {
+    return BulletSnapshot{id, ownerId, x, y, 400.0f, 0.0f};
+}
+
+const PlayerSnapshot* findPlayer(const WorldSnapshot& snapshot, int id) {
+    for (const PlayerSnapshot& entry : snapshot.players) {
+        if (entry.id == id) return &entry;
+    }
+    return nullptr;
+}
+
+bool hasBullet(const WorldSnapshot& snapshot, int id) {
+    for (const BulletSnapshot& entry : snapshot.bullets) {
+        if (entry.id == id) return true;
+    }
+    return false;
+}
+
+// A busy room: everyone strafes and keeps firing, so every tick has moved players,
+// new bullets and expired ones
+class Room {
+public:
+    explicit Room(int players) : nextBulletId_(1), tick_(0) {
+        std::srand(19);
+        for (int id = 1; id <= players; id++) {
+            state_.addPlayer(id, "player" + std::to_string(id));
+        }
+    }
+    
+    const WorldSnapshot& step() {
+        tick_++;
+        for (Player* player : state_.getAllPlayers()) {
+            InputCommand command;
+            command.right = (tick_ / 15 + player->getId()) % 2 == 0;
+            command.left = !command.right;
+            command.down = (tick_ / 25 + player->getId()) % 3 == 0;
+            state_.applyInput(player, command);
+            if ((tick_ + player->getId()) % 6 == 0) {
+                float angle = static_cast<float>((nextBulletId_ * 37) % 628) / 100.0f;
+                state_.addBullet(nextBulletId_++, player->getId(), player->getX() + 20, player->getY() + 20, angle, 400.0f);
+            }
+        }
+        state_.update(STEP);
+        state_.captureSnapshot(snapshot_);
+        return snapshot_;
+    }
+
+private:
+    GameState state_;
+    WorldSnapshot snapshot_;
+    int nextBulletId_;
+    int tick_;
+};
+
+} // namespace
+
+TEST_CASE(interest, budget_caps_each_delta) {
+    const int budgets[] = {60, 150, 400};
+    for (int budget : budgets) {
+        Room room(48);
+        InterestFilter filter;
+        InterestState state;
+        size_t over = 0, largest = 0;
+        for (int tick = 0; tick < 150; tick++) {
+            const WorldSnapshot& full = room.step();
+            WorldSnapshot previous = state.view;
+            filter.update(full, 1, budget, state);
+            
+            // What the client that acked the previous view is sent
+            std::string delta;
+            SnapshotCodec::encodeDelta(previous, state.view, delta);
+            largest = std::max(largest, delta.size());
+            if (delta.size() > static_cast<size_t>(budget)) over++;
+        }
+        CHECK_MSG(over == 0, std::to_string(over) + " deltas over " + std::to_string(budget) +
+                  " bytes, largest " + std::to_string(largest));
+        // There's always more to send than fits, so the budget should be mostly used
+        CHECK_MSG(largest * 3 >= static_cast<size_t>(budget) * 2, "largest delta " + std::to_string(largest));
+    }
+}
+
+TEST_CASE(interest, starved_entities_gain_priority_until_sent) {
+    // All on screen and moving; the budget fits the viewer and about one other player
+    const int PLAYERS = 10;
+    const int budget = InterestFilter::SNAPSHOT_HEADER_BYTES + 3 * InterestFilter::PLAYER_UPDATE_BYTES;
+    InterestFilter filter;
+    InterestState state;
+    
+    std::vector<float> lastPriority(PLAYERS + 1, 0.0f);
+    std::vector<int> lastSent(PLAYERS + 1, -1);
+    int longestWait = 0;
+    size_t fellWhileHeld = 0;
+    for (int tick = 1; tick <= 200; tick++) {
+        WorldSnapshot full;
+        full.tick = tick;
+        for (int id = 1; id <= PLAYERS; id++) {
+            full.players.push_back(player(id, 500.0f + id * 20 + tick * 3.0f, 500.0f + (tick % 7) * id));
+        }
+        filter.update(full, 1, budget, state);
+        
+        for (size_t i = 0; i < state.view.players.size(); i++) {
+            int id = state.view.players[i].id;
+            float priority = state.playerPriority[i];
+            bool sent = state.view.players[i].x == full.players[id - 1].x;
+            if (sent) {
+                CHECK(priority == 0.0f);
+                if (lastSent[id] >= 0) longestWait = std::max(longestWait, tick - lastSent[id]);
+                lastSent[id] = tick;
+            } else if (priority <= lastPriority[id]) {
+                fellWhileHeld++;
+            }
+            lastPriority[id] = priority;
+        }
+    }
+    
+    CHECK_MSG(fellWhileHeld == 0, std::to_string(fellWhileHeld) + " held entries lost priority");
+    for (int id = 1; id <= PLAYERS; id++) {
+        CHECK_MSG(lastSent[id] > 180, "player " + std::to_string(id) + " last sent at " + std::to_string(lastSent[id]));
+    }
+    // Nine players sharing roughly one slot each snapshot take turns
+    CHECK_MSG(longestWait <= 2 * PLAYERS, "waited " + std::to_string(longestWait) + " snapshots");
+}
+
+TEST_CASE(interest, viewer_always_refreshed) {
+    // Even a budget too small for the viewer's own entry, and with everything else new
+    const int budgets[] = {1, InterestFilter::SNAPSHOT_HEADER_BYTES + InterestFilter::PLAYER_UPDATE_BYTES, 0};
+    for (int budget : budgets) {
+        Room room(32);
+        InterestFilter filter;
+        InterestState state;
+        size_t stale = 0;
+        for (int tick = 0; tick < 60; tick++) {
+            const WorldSnapshot& full = room.step();
+            filter.update(full, 5, budget, state);
+            
+            const PlayerSnapshot* truth = findPlayer(full, 5);
+            const PlayerSnapshot* seen = findPlayer(state.view, 5);
+            if (!seen || seen->x != truth->x || seen->y != truth->y || seen->health != truth->health ||
+                seen->lastInputSequence != truth->lastInputSequence) {
+                stale++;
+            }
+        }
+        CHECK_MSG(stale == 0, "budget " + std::to_string(budget) + ": " + std::to_string(stale) + " stale views");
+    }
+}
+
+TEST_CASE(interest, off_screen_bullets_dropped) {
+    // Viewer in the middle; reach is the half view plus the margin on each axis
+    const float reachX = InterestFilter::VIEW_HALF_WIDTH + InterestFilter::VIEW_MARGIN;
+    InterestFilter filter;
+    InterestState state;
+    
+    WorldSnapshot full;
+    full.tick = 1;
+    full.players.push_back(player(1, 1000, 700));
+    full.players.push_back(player(2, 1000 + reachX + 500, 700)); // Off screen
+    full.bullets.push_back(bullet(10, 2, 1100, 700));            // On screen
+    full.bullets.push_back(bullet(11, 2, 1000 + reachX + 400, 700));
+    full.bullets.push_back(bullet(12, 1, 1000 - reachX - 400, 700)); // The viewer's own, off screen
+    filter.update(full, 1, 0, state);
+    
+    CHECK(findPlayer(state.view, 2) != nullptr); // Players are never left out
+    CHECK(hasBullet(state.view, 10));
+    CHECK(!hasBullet(state.view, 11));
+    CHECK(hasBullet(state.view, 12));
+    CHECK(state.bulletPriority.size() == state.view.bullets.size());
+    
+    // Bullet 10 flies off screen, 11 flies onto it
+    full.tick = 2;
+    full.bullets[0].x = 1000 + reachX + 10;
+    full.bullets[1].x = 1000 + reachX - 10;
+    filter.update(full, 1, 0, state);
+    CHECK(!hasBullet(state.view, 10));
+    CHECK(hasBullet(state.view, 11));
+    CHECK(hasBullet(state.view, 12));
+    
+    // Entities gone from the world are gone from the view
+    full.tick = 3;
+    full.players.pop_back();
+    full.bullets.clear();
+    filter.update(full, 1, 0, state);
+    CHECK(state.view.players.size() == 1 && state.view.bullets.empty());
+    CHECK(state.playerPriority.size() == 1 && state.bulletPriority.empty());
+}
+
+TEST_CASE(interest, distant_players_refreshed_in_turn) {
+    const int NEAR = 6, DISTANT = 18;
+    InterestFilter filter;
+    InterestState state;
+    
+    std::vector<int> refreshes(NEAR + DISTANT + 2, 0);
+    size_t wrongCount = 0, staleNear = 0;
+    for (int tick = 1; tick <= 60; tick++) {
+        // Everyone moves every tick; ids 2..7 next to the viewer, the rest far away
+        WorldSnapshot full;
+        full.tick = tick;
+        full.players.push_back(player(1, 200, 200));
+        for (int i = 0; i < NEAR + DISTANT; i++) {
+            bool near = i < NEAR;
+            full.players.push_back(player(i + 2, (near ? 250.0f + i * 30 : 1200.0f + i * 20) + tick, near ? 250.0f : 1200.0f));
+        }
+        filter.update(full, 1, 0, state);
+        if (tick == 1) continue; // Everyone is new on the first snapshot
+        
+        int distantRefreshed = 0;
+        for (size_t i = 1; i < state.view.players.size(); i++) {
+            bool sent = state.view.players[i].x == full.players[i].x;
+            bool near = static_cast<int>(i) <= NEAR;
+            if (sent && !near) {
+                distantRefreshed++;
+                refreshes[state.view.players[i].id]++;
+            }
+            if (!sent && near) staleNear++;
+        }
+        if (distantRefreshed != InterestFilter::DISTANT_UPDATES) wrongCount++;
+    }
+    
+    CHECK_MSG(wrongCount == 0, std::to_string(wrongCount) + " snapshots refreshed the wrong number of distant players");
+    CHECK_MSG(staleNear == 0, std::to_string(staleNear) + " on-screen players held");
+    
+    // 59 snapshots x 4 refreshes over 18 players. The farthest gain priority slowest
+    // and wait longest, but none is left behind.
+    for (int id = NEAR + 2; id < NEAR + DISTANT + 2; id++) {
+        CHECK_MSG(refreshes[id] >= 59 * InterestFilter::DISTANT_UPDATES / DISTANT / 2,
+                  "player " + std::to_string(id) + " refreshed " + std::to_string(refreshes[id]) + " times");
+    }
+    
+    // The count is configurable
+    filter.setDistantUpdates(1);
+    WorldSnapshot full = state.view;
+    full.tick = 61;
+    for (PlayerSnapshot& entry : full.players) entry.x += 5;
+    filter.update(full, 1, 0, state);
+    int sent = 0;
+    for (size_t i = NEAR + 1; i < state.view.players.size(); i++) {
+        if (state.view.players[i].x == full.players[i].x) sent++;
+    }
+    CHECK(sent == 1);
+}
@@ -0,0 +1,125 @@
+#include "TestHarness.h"
+#include "LinkConditioner.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <chrono>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+typedef LinkConditioner::Clock Clock;
+
+const int DATAGRAMS = 2000;
+
+struct Counts {
+    size_t dropped;
+    size_t duplicated;
+    size_t reordered;
+    size_t received;
+    size_t outOfOrder; // Datagrams that arrived after a later one
+};
+
+// Sends numbered datagrams through a conditioner to a loopback socket and counts
+// what the conditioner did and what came out the other end
+Counts runLink(const LinkConditions& conditions) {
+    int receiver = socket(AF_INET, SOCK_DGRAM, 0);
+    int sender = socket(AF_INET, SOCK_DGRAM, 0);
+    int buffer = 4 << 20;
+    setsockopt(receiver, SOL_SOCKET, SO_RCVBUF, &buffer, sizeof(buffer));
+    
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = inet_addr("127.0.0.1");
+    bind(receiver, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    socklen_t length = sizeof(address);
+    getsockname(receiver, reinterpret_cast<sockaddr*>(&address), &length);
+    
+    Counts counts = {};
+    {
+        LinkConditioner conditioner(sender, conditions);
+        for (int i = 0; i < DATAGRAMS; i++) {
+            std::string data = std::to_string(i);
+            conditioner.submit(data.data(), data.size(), address);
+        }
+        counts.dropped = conditioner.getDropped();
+        counts.duplicated = conditioner.getDuplicated();
+        counts.reordered = conditioner.getReordered();
+        
+        // Everything is due within the latency plus the reorder hold-back
+        size_t expected = DATAGRAMS - counts.dropped + counts.duplicated;
+        Clock::time_point deadline = Clock::now() + std::chrono::seconds(3);
+        int highest = -1;
+        char data[32];
+        while (counts.received < expected && Clock::now() < deadline) {
+            ssize_t bytes = recv(receiver, data, sizeof(data) - 1, MSG_DONTWAIT);
+            if (bytes <= 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+            data[bytes] = '\0';
+            int number = std::stoi(data);
+            if (number < highest) counts.outOfOrder++;
+            highest = std::max(highest, number);
+            counts.received++;
+        }
+    }
+    
+    close(sender);
+    close(receiver);
+    return counts;
+}
+
+bool parses(const std::string& spec) {
+    LinkConditions conditions;
+    return LinkConditioner::parseConditions(spec, conditions);
+}
+
+} // namespace
+
+TEST_CASE(conditioner, parse_checks_ranges) {
+    LinkConditions conditions;
+    CHECK(LinkConditioner::parseConditions("latency=80,jitter=10,loss=2.5,dup=1,reorder=100,kbps=512,seed=4294967295",
+                                           conditions));
+    CHECK(conditions.latencyMs == 80 && conditions.jitterMs == 10 && conditions.bandwidthKbps == 512);
+    CHECK(conditions.lossPercent == 2.5f && conditions.duplicatePercent == 1 && conditions.reorderPercent == 100);
+    CHECK(conditions.seed == 4294967295u);
+    CHECK(parses(""));
+    
+    CHECK(!parses("loss=100.5"));
+    CHECK(!parses("dup=101"));
+    CHECK(!parses("reorder=1000"));
+    CHECK(!parses("loss=-1"));
+    CHECK(!parses("loss=nan"));
+    CHECK(!parses("seed=4294967296"));
+    CHECK(!parses("seed=1e30"));
+    CHECK(!parses("seed=1.5"));
+    CHECK(!parses("latency=3e9"));
+    CHECK(!parses("kbps=inf"));
+    CHECK(!parses("latency"));
+    CHECK(!parses("latency=10ms"));
+    CHECK(!parses("bogus=1"));
+}
+
+TEST_CASE(conditioner, same_seed_same_link) {
+    LinkConditions conditions;
+    CHECK(LinkConditioner::parseConditions("latency=5,loss=10,dup=5,reorder=5,seed=42", conditions));
+    
+    Counts first = runLink(conditions);
+    Counts second = runLink(conditions);
+    CHECK_MSG(first.dropped == second.dropped, std::to_string(first.dropped) + " vs " + std::to_string(second.dropped));
+    CHECK(first.duplicated == second.duplicated);
+    CHECK(first.reordered == second.reordered);
+    
+    // Roughly the configured rates, and they show up at the receiver
+    CHECK_MSG(first.dropped > DATAGRAMS / 20 && first.dropped < DATAGRAMS * 3 / 20, std::to_string(first.dropped));
+    CHECK(first.duplicated > 0 && first.reordered > 0);
+    CHECK_MSG(first.received == DATAGRAMS - first.dropped + first.duplicated, std::to_string(first.received));
+    CHECK(first.outOfOrder > 0);
+    
+    conditions.seed = 43;
+    Counts other = runLink(conditions);
+    CHECK(other.dropped != first.dropped || other.duplicated != first.duplicated || other.reordered != first.reordered);
+}
@@ -0,0 +1,222 @@
+#include "TestHarness.h"
+#include "SpscQueue.h"
+#include "BroadcastStage.h"
+#include "GameState.h"
+#include "NetworkManager.h"
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// The lock-free pieces of the pipelined worker: SpscQueue on its own and across two
+// threads, and BroadcastStage run on its send thread against the same jobs run inline.
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const int CLIENTS = 3;
+
+// A socket standing in for one client, bound to a loopback port
+struct Client {
+    NetworkManager socket;
+    sockaddr_in address;
+    std::vector<std::string> received; // Type and payload of every message, in order
+    
+    Client() {
+        socket.initializeSocket();
+        socket.bindToPort(0);
+        socklen_t length = sizeof(address);
+        getsockname(socket.getSocketHandle(), (sockaddr*)&address, &length);
+        address.sin_addr.s_addr = inet_addr("127.0.0.1");
+    }
+    
+    void drain() {
+        NetworkMessage message;
+        sockaddr_in from;
+        while (socket.receiveMessage(message, from)) {
+            received.push_back(std::to_string(static_cast<int>(message.type)) + "|" + message.data);
+        }
+    }
+};
+
+// A room's worth of traffic: join replies, snapshots (full, delta, filtered within
+// a budget), an oversized message that gets fragmented, a client leaving and the
+// room closing. Between bursts, a run of jobs with no datagrams fills every job slot
+// without waking the send thread, so the producer has to wait for recycled jobs.
+std::vector<size_t> sendRoomTraffic(BroadcastStage& stage, std::vector<std::unique_ptr<Client>>& clients) {
+    std::srand(21);
+    GameState world;
+    for (int id = 1; id <= 12; id++) {
+        world.addPlayer(id, "p" + std::to_string(id));
+    }
+    
+    for (int i = 0; i < CLIENTS; i++) {
+        NetworkMessage reply;
+        reply.type = MessageType::PLAYER_JOIN;
+        reply.playerId = i + 1;
+        reply.data = std::to_string(i + 1) + "|30|room-0";
+        stage.sendMessage(0, reply, clients[i]->address);
+    }
+    
+    for (int tick = 1; tick <= 120; tick++) {
+        for (Player* player : world.getAllPlayers()) {
+            InputCommand command;
+            command.right = (tick / 10 + player->getId()) % 2 == 0;
+            command.left = !command.right;
+            world.applyInput(player, command);
+        }
+        world.update(1.0f / 30.0f);
+        
+        BroadcastJob& job = stage.beginJob(0, BroadcastKind::BINARY_SNAPSHOT);
+        world.captureSnapshot(job.snapshot);
+        job.interestFilter = tick > 60;
+        for (int i = 0; i < CLIENTS; i++) {
+            // Client 0 never acks, client 1 acks two ticks behind, client 2 has a budget
+            int acked = i == 0 ? -1 : tick - 2;
+            job.recipients.push_back(SnapshotRecipient{i + 1, clients[i]->address, acked, i == 2 ? 120 : 0});
+        }
+        stage.submit();
+        
+        if (tick == 30) {
+            BroadcastJob& big = stage.beginJob(0, BroadcastKind::MESSAGE);
+            big.message.type = MessageType::GAME_STATE_UPDATE;
+            big.message.playerId = 0;
+            big.message.data = world.serialize() + std::string(4000, 'x');
+            for (int i = 0; i < CLIENTS; i++) {
+                big.recipients.push_back(SnapshotRecipient{i + 1, clients[i]->address, -1, 0});
+            }
+            stage.submit();
+        }
+        if (tick == 90) {
+            BroadcastJob& left = stage.beginJob(0, BroadcastKind::CLIENT_LEFT);
+            left.recipients.push_back(SnapshotRecipient{3, clients[2]->address, -1, 0});
+            stage.submit();
+        }
+        if (tick % 40 == 0) {
+            for (size_t i = 0; i < BroadcastStage::QUEUE_CAPACITY + 20; i++) {
+                stage.beginJob(1, BroadcastKind::ROOM_CLOSED);
+                stage.submit();
+            }
+        }
+        
+        stage.publish();
+        for (auto& client : clients) {
+            client->drain();
+        }
+    }
+    
+    std::vector<size_t> counts;
+    for (auto& client : clients) {
+        counts.push_back(client->received.size());
+    }
+    return counts;
+}
+
+} // namespace
+
+TEST_CASE(pipeline, spsc_wraps_and_refuses_when_full) {
+    SpscQueue<int> queue(3);
+    CHECK(queue.capacity() == 4); // Rounded up to a power of two
+    
+    int value = -1;
+    CHECK(!queue.pop(value));
+    
+    // Go round the ring many times, filling it completely each time
+    int next = 0, expected = 0;
+    for (int round = 0; round < 50; round++) {
+        while (queue.push(next)) next++;
+        CHECK(next - expected == 4);
+        
+        // One slot freed makes room for exactly one more
+        CHECK(queue.pop(value) && value == expected++);
+        CHECK(queue.push(next++));
+        CHECK(!queue.push(next));
+        
+        while (queue.pop(value)) {
+            CHECK(value == expected);
+            expected++;
+        }
+        CHECK(expected == next);
+    }
+    
+    // Move-only values go through intact
+    SpscQueue<std::unique_ptr<std::string>> owned(2);
+    CHECK(owned.push(std::unique_ptr<std::string>(new std::string("snapshot"))));
+    std::unique_ptr<std::string> out;
+    CHECK(owned.pop(out) && out && *out == "snapshot");
+}
+
+TEST_CASE(pipeline, spsc_two_threads_in_order) {
+    const uint64_t COUNT = 200000;
+    SpscQueue<uint64_t> queue(8); // Small, so both the full and the empty paths are hit constantly
+    
+    uint64_t producerFull = 0;
+    std::thread producer([&]() {
+        for (uint64_t i = 1; i <= COUNT; i++) {
+            while (!queue.push(i)) {
+                producerFull++;
+                std::this_thread::yield();
+            }
+        }
+    });
+    
+    uint64_t expected = 1, outOfOrder = 0, consumerEmpty = 0;
+    uint64_t value;
+    while (expected <= COUNT) {
+        if (!queue.pop(value)) {
+            consumerEmpty++;
+            std::this_thread::yield();
+            continue;
+        }
+        if (value != expected) outOfOrder++;
+        expected = value + 1;
+    }
+    producer.join();
+    
+    CHECK_MSG(outOfOrder == 0, std::to_string(outOfOrder) + " out of order");
+    CHECK(!queue.pop(value));
+    CHECK_MSG(producerFull > 0, "the full path never ran");
+    CHECK_MSG(consumerEmpty > 0, "the empty path never ran");
+}
+
+TEST_CASE(pipeline, broadcast_thread_sends_what_inline_sends) {
+    std::vector<std::unique_ptr<Client>> inlineClients, threadedClients;
+    for (int i = 0; i < CLIENTS; i++) {
+        inlineClients.emplace_back(new Client());
+        threadedClients.emplace_back(new Client());
+    }
+    
+    NetworkManager inlineSocket;
+    inlineSocket.initializeSocket();
+    BroadcastStage inlineStage(inlineSocket);
+    std::vector<size_t> sent = sendRoomTraffic(inlineStage, inlineClients);
+    
+    NetworkManager threadedSocket;
+    threadedSocket.initializeSocket();
+    threadedSocket.setBatchedIO(true);
+    BroadcastStage threadedStage(threadedSocket);
+    CHECK(threadedStage.start());
+    CHECK(threadedStage.isThreaded());
+    sendRoomTraffic(threadedStage, threadedClients);
+    threadedStage.stop();
+    
+    // The send thread may still have been working when the traffic ended
+    Clock::time_point deadline = Clock::now() + std::chrono::seconds(2);
+    for (int i = 0; i < CLIENTS; i++) {
+        while (threadedClients[i]->received.size() < sent[i] && Clock::now() < deadline) {
+            threadedClients[i]->drain();
+        }
+    }
+    
+    for (int i = 0; i < CLIENTS; i++) {
+        std::string label = "client " + std::to_string(i);
+        CHECK_MSG(sent[i] > 120, label + " got " + std::to_string(sent[i]));
+        CHECK_MSG(threadedClients[i]->received.size() == sent[i],
+                  label + ": " + std::to_string(threadedClients[i]->received.size()) + " of " + std::to_string(sent[i]));
+        CHECK_MSG(threadedClients[i]->received == inlineClients[i]->received, label);
+    }
+}
@@ -0,0 +1,182 @@
+#include "TestHarness.h"
+#include "GameRoom.h"
+#include "GameState.h"
+#include "BroadcastStage.h"
+#include "NetworkManager.h"
+#include "PredictionBuffer.h"
+#include "SnapshotCodec.h"
+#include "FixedTimestep.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cmath>
+#include <cstdlib>
+#include <deque>
+#include <string>
+
+// Client-side prediction against a real GameRoom that sees every input one trip
+// late. The room queues and applies inputs itself and sends its snapshots through
+// an inline send stage to a loopback socket standing in for the client; the test
+// holds each message back by half the round trip, rounded up to whole ticks.
+
+namespace {
+
+const int TICK_RATE = FixedTimestep::DEFAULT_TICK_RATE;
+const int TICKS = 600;
+
+struct InFlight {
+    int arrivesAt; // Tick
+    NetworkMessage message;
+};
+
+// Walks a loop with a change of direction every 20 ticks, pausing now and then
+// and running into the world edges and obstacles on the way
+InputCommand scriptedInput(uint32_t sequence) {
+    InputCommand command;
+    command.sequence = sequence;
+    switch ((sequence / 20) % 6) {
+        case 0: command.right = true; break;
+        case 1: command.right = true; command.down = true; break;
+        case 2: break;
+        case 3: command.left = true; break;
+        case 4: command.up = true; command.left = true; break;
+        case 5: command.up = true; break;
+    }
+    command.angle = static_cast<float>(sequence % 360);
+    return command;
+}
+
+struct LatencyResult {
+    float maxCorrection = 0;   // Jump applied to the prediction by a snapshot
+    float maxSnapshotLag = 0;  // How far the raw server position trails the prediction
+    int snapshots = 0;
+    int undecodable = 0;
+};
+
+LatencyResult runWithLatency(int roundTripMs, int snapshotLossPercent) {
+    const float step = 1.0f / TICK_RATE;
+    const int oneWayTicks = (roundTripMs / 2 * TICK_RATE + 999) / 1000;
+    
+    // The client's end of the link
+    NetworkManager clientSocket;
+    clientSocket.initializeSocket();
+    clientSocket.bindToPort(0);
+    sockaddr_in clientAddress;
+    socklen_t length = sizeof(clientAddress);
+    getsockname(clientSocket.getSocketHandle(), reinterpret_cast<sockaddr*>(&clientAddress), &length);
+    clientAddress.sin_addr.s_addr = inet_addr("127.0.0.1");
+    
+    std::srand(7);
+    RoomSettings settings;
+    settings.tickRate = TICK_RATE;
+    settings.clientTimeoutMs = 0;
+    NetworkManager serverSocket;
+    serverSocket.initializeSocket();
+    BroadcastStage output(serverSocket);
+    GameRoom room(0, "prediction", settings);
+    room.setOutput(&output);
+    
+    NetworkMessage join;
+    join.type = MessageType::PLAYER_JOIN;
+    join.playerId = 0;
+    join.data = "local";
+    const int playerId = room.join(join, clientAddress);
+    
+    GameState client;
+    PredictionBuffer prediction;
+    SnapshotHistory history;
+    WorldSnapshot snapshot;
+    std::deque<InFlight> toServer;
+    std::deque<InFlight> toClient;
+    uint32_t sequence = 0;
+    LatencyResult result;
+    
+    for (int tick = 0; tick < TICKS; tick++) {
+        // Server: hand the room what has arrived, step it once, collect what it sent
+        while (!toServer.empty() && toServer.front().arrivesAt <= tick) {
+            room.handleMessage(toServer.front().message);
+            toServer.pop_front();
+        }
+        room.tick(step);
+        
+        NetworkMessage message;
+        sockaddr_in from;
+        while (clientSocket.receiveMessage(message, from)) {
+            if (message.type != MessageType::GAME_STATE_UPDATE) continue; // Join reply, pings
+            if (std::rand() % 100 < snapshotLossPercent) continue;
+            toClient.push_back(InFlight{tick + oneWayTicks, message});
+        }
+        
+        // Client: apply snapshots that arrived, ack them and replay what the server hasn't seen
+        while (!toClient.empty() && toClient.front().arrivesAt <= tick) {
+            bool decoded = SnapshotCodec::decode(toClient.front().message.data, snapshot, &history);
+            toClient.pop_front();
+            if (!decoded) {
+                result.undecodable++;
+                continue;
+            }
+            history.store(snapshot);
+            
+            Player* predicted = client.getPlayer(playerId);
+            float predictedX = predicted ? predicted->getX() : 0;
+            float predictedY = predicted ? predicted->getY() : 0;
+            client.applySnapshot(snapshot);
+            
+            InFlight ack{tick + oneWayTicks, NetworkMessage()};
+            ack.message.type = MessageType::SNAPSHOT_ACK;
+            ack.message.playerId = playerId;
+            ack.message.data = std::to_string(snapshot.tick);
+            toServer.push_back(ack);
+            
+            Player* localPlayer = client.getPlayer(playerId);
+            if (!localPlayer) continue;
+            float lag = std::hypot(localPlayer->getX() - predictedX, localPlayer->getY() - predictedY);
+            float correction = prediction.reconcile(client, *localPlayer, localPlayer->getLastInputSequence(),
+                                                    predictedX, predictedY, step);
+            if (predicted) {
+                result.maxCorrection = std::max(result.maxCorrection, correction);
+                result.maxSnapshotLag = std::max(result.maxSnapshotLag, lag);
+                result.snapshots++;
+            }
+        }
+        
+        // Client step: predict locally and send the input, as GameClient does
+        Player* localPlayer = client.getPlayer(playerId);
+        if (localPlayer) {
+            InputCommand command = scriptedInput(++sequence);
+            client.applyInput(localPlayer, command);
+            prediction.record(command);
+            
+            InFlight input{tick + oneWayTicks, NetworkMessage()};
+            input.message.type = MessageType::PLAYER_MOVE;
+            input.message.playerId = playerId;
+            InputCommand::encodeBatch(&command, 1, input.message.data);
+            toServer.push_back(input);
+        }
+        client.update(step);
+    }
+    return result;
+}
+
+} // namespace
+
+TEST_CASE(prediction, bounded_error_under_latency) {
+    const int roundTrips[] = {100, 150, 200};
+    for (int roundTripMs : roundTrips) {
+        LatencyResult result = runWithLatency(roundTripMs, 0);
+        std::string label = std::to_string(roundTripMs) + " ms";
+        
+        CHECK_MSG(result.snapshots > TICKS / 2, label);
+        CHECK_MSG(result.undecodable == 0, label);
+        // Replaying the unacknowledged inputs lands on the same position the client
+        // already predicted, so snapshots barely move the local player...
+        CHECK_MSG(result.maxCorrection < 1.0f, label + ", correction " + std::to_string(result.maxCorrection));
+        // ...while taking the server position as-is would snap it back a whole trip
+        CHECK_MSG(result.maxSnapshotLag > 10.0f, label + ", lag " + std::to_string(result.maxSnapshotLag));
+    }
+}
+
+TEST_CASE(prediction, bounded_error_with_lost_snapshots) {
+    LatencyResult result = runWithLatency(200, 20);
+    CHECK(result.snapshots > TICKS / 2);
+    CHECK_MSG(result.maxCorrection < 1.0f, "correction " + std::to_string(result.maxCorrection));
+}
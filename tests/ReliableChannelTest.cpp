@@ -0,0 +1,284 @@
+#include "TestHarness.h"
+#include "ReliableChannel.h"
+#include "LinkConditioner.h"
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+// Two channels talking over an in-process link that impairs datagrams the way
+// LinkConditioner does (loss, duplicates, jitter, held-back reordering), on a
+// simulated clock so every run is the same.
+
+namespace {
+
+typedef ReliableChannel::Clock Clock;
+
+const Clock::duration STEP = std::chrono::milliseconds(5);
+
+class SimulatedLink {
+public:
+    SimulatedLink(const LinkConditions& conditions) : conditions_(conditions), random_(conditions.seed), order_(0) {}
+    
+    // Datagrams go over the wire serialized, as NetworkManager sends them
+    void send(const NetworkMessage& message, Clock::time_point now) {
+        if (chance(conditions_.lossPercent)) return;
+        schedule(message.serialize(), now);
+        if (chance(conditions_.duplicatePercent)) schedule(message.serialize(), now);
+    }
+    
+    bool receive(Clock::time_point now, NetworkMessage& message) {
+        if (queue_.empty() || queue_.top().due > now) return false;
+        message = NetworkMessage::deserialize(queue_.top().data);
+        queue_.pop();
+        return true;
+    }
+    
+    bool empty() const { return queue_.empty(); }
+    
+    // Longest a datagram that isn't lost can take
+    Clock::duration maxDelay() const {
+        return std::chrono::milliseconds(conditions_.latencyMs + conditions_.jitterMs + 2 * conditions_.latencyMs);
+    }
+
+private:
+    struct InFlight {
+        Clock::time_point due;
+        uint64_t order;
+        std::string data;
+        
+        bool operator>(const InFlight& other) const {
+            return due != other.due ? due > other.due : order > other.order;
+        }
+    };
+    
+    LinkConditions conditions_;
+    std::mt19937 random_;
+    uint64_t order_;
+    std::priority_queue<InFlight, std::vector<InFlight>, std::greater<InFlight>> queue_;
+    
+    bool chance(float percent) {
+        return std::uniform_real_distribution<float>(0, 100)(random_) < percent;
+    }
+    
+    void schedule(const std::string& data, Clock::time_point now) {
+        int delayMs = conditions_.latencyMs + std::uniform_int_distribution<int>(0, conditions_.jitterMs)(random_);
+        if (chance(conditions_.reorderPercent)) {
+            delayMs += conditions_.latencyMs + std::uniform_int_distribution<int>(0, conditions_.latencyMs)(random_);
+        }
+        queue_.push(InFlight{now + std::chrono::milliseconds(delayMs), order_++, data});
+    }
+};
+
+// One end: a channel plus what it handed up, split by stream
+struct Peer {
+    ReliableChannel channel;
+    std::vector<std::string> reliable;
+    std::vector<std::pair<std::string, Clock::duration>> unreliable; // Payload, age on delivery
+    std::vector<NetworkMessage> scratch;
+    
+    // As the client and GameRoom do: envelopes through the channel, the rest straight up
+    void deliver(const NetworkMessage& message, Clock::time_point now) {
+        scratch.clear();
+        if (message.type == MessageType::RELIABLE) {
+            channel.receive(message, now, scratch);
+        } else {
+            scratch.push_back(message);
+        }
+        for (const NetworkMessage& delivered : scratch) {
+            if (delivered.type == MessageType::PLAYER_SHOOT || delivered.type == MessageType::PLAYER_RESPAWN) {
+                reliable.push_back(delivered.data);
+            } else if (delivered.type == MessageType::PLAYER_MOVE) {
+                size_t separator = delivered.data.find('@');
+                Clock::time_point sent(Clock::duration(std::stoll(delivered.data.substr(separator + 1))));
+                unreliable.emplace_back(delivered.data.substr(0, separator), now - sent);
+            }
+        }
+    }
+    
+    void flush(SimulatedLink& link, Clock::time_point now) {
+        scratch.clear();
+        channel.update(now, scratch);
+        for (const NetworkMessage& message : scratch) {
+            link.send(message, now);
+        }
+    }
+};
+
+NetworkMessage shot(int index) {
+    NetworkMessage message;
+    message.type = MessageType::PLAYER_SHOOT;
+    message.playerId = 1;
+    message.data = "shot-" + std::to_string(index);
+    return message;
+}
+
+NetworkMessage respawn(int index) {
+    NetworkMessage message = shot(index);
+    message.type = MessageType::PLAYER_RESPAWN;
+    message.data = "respawn-" + std::to_string(index);
+    return message;
+}
+
+NetworkMessage move(int index, Clock::time_point now) {
+    NetworkMessage message;
+    message.type = MessageType::PLAYER_MOVE;
+    message.playerId = 1;
+    message.data = "move-" + std::to_string(index) + "@" + std::to_string(now.time_since_epoch().count());
+    return message;
+}
+
+struct LossyRun {
+    int messages;
+    size_t pending;
+    bool inOrder;
+    bool replyInOrder;
+    int unreliableSent;
+    int unreliableWrapped; // Sent in an envelope to carry acks
+    size_t unreliableDelivered;
+    bool unreliableOnTime; // None waited longer than the link itself can delay
+};
+
+// The sender fires an unreliable input and a reliable event every 15 ms. The
+// receiver streams unreliable traffic back, as a server's snapshots, and a reliable
+// event of its own every fourth time, so both directions owe and carry acks.
+LossyRun runLossy(const LinkConditions& conditions, int messages) {
+    LinkConditions reverse = conditions;
+    reverse.seed = conditions.seed + 1;
+    SimulatedLink forward(conditions), backward(reverse);
+    Peer sender, receiver;
+    
+    Clock::time_point now;
+    Clock::time_point end = now + std::chrono::milliseconds(15 * messages);
+    Clock::time_point nextSend = now;
+    int sent = 0, moves = 0, wrapped = 0, replies = 0;
+    NetworkMessage message;
+    
+    // Run until everything is acked and off the wire, with a generous cap
+    while (now < end + std::chrono::seconds(30) &&
+           (sent < messages || sender.channel.getPendingCount() > 0 || receiver.channel.getPendingCount() > 0 ||
+            !forward.empty() || !backward.empty())) {
+        if (sent < messages && now >= nextSend) {
+            // Input first, so it picks up any ack owed to the receiver
+            NetworkMessage input = move(moves++, now);
+            if (sender.channel.wrapUnreliable(input)) wrapped++;
+            forward.send(input, now);
+            NetworkMessage envelope;
+            if (sender.channel.send(shot(sent), now, envelope)) {
+                forward.send(envelope, now);
+                sent++;
+            }
+            
+            if (moves % 4 == 0 && receiver.channel.send(respawn(replies), now, envelope)) {
+                backward.send(envelope, now);
+                replies++;
+            }
+            NetworkMessage state = move(0, now);
+            state.type = MessageType::GAME_STATE_UPDATE;
+            receiver.channel.wrapUnreliable(state);
+            backward.send(state, now);
+            nextSend += std::chrono::milliseconds(15);
+        }
+        
+        while (forward.receive(now, message)) receiver.deliver(message, now);
+        while (backward.receive(now, message)) sender.deliver(message, now);
+        sender.flush(forward, now);
+        receiver.flush(backward, now);
+        now += STEP;
+    }
+    
+    LossyRun run;
+    run.messages = messages;
+    run.pending = sender.channel.getPendingCount() + receiver.channel.getPendingCount();
+    run.inOrder = static_cast<int>(receiver.reliable.size()) == messages;
+    for (int i = 0; run.inOrder && i < messages; i++) {
+        run.inOrder = receiver.reliable[i] == "shot-" + std::to_string(i);
+    }
+    run.replyInOrder = static_cast<int>(sender.reliable.size()) == replies;
+    for (int i = 0; run.replyInOrder && i < replies; i++) {
+        run.replyInOrder = sender.reliable[i] == "respawn-" + std::to_string(i);
+    }
+    run.unreliableSent = moves;
+    run.unreliableWrapped = wrapped;
+    run.unreliableDelivered = receiver.unreliable.size();
+    run.unreliableOnTime = true;
+    for (const auto& delivered : receiver.unreliable) {
+        if (delivered.second > forward.maxDelay()) run.unreliableOnTime = false;
+    }
+    return run;
+}
+
+LinkConditions badLink(float lossPercent) {
+    LinkConditions conditions;
+    conditions.latencyMs = 40;
+    conditions.jitterMs = 30;
+    conditions.lossPercent = lossPercent;
+    conditions.duplicatePercent = 5;
+    conditions.reorderPercent = 10;
+    conditions.seed = 3;
+    return conditions;
+}
+
+} // namespace
+
+TEST_CASE(reliable, in_order_exactly_once_over_lossy_link) {
+    const float losses[] = {0, 10, 20, 30};
+    for (float loss : losses) {
+        LossyRun run = runLossy(badLink(loss), 2000);
+        std::string label = std::to_string(static_cast<int>(loss)) + "% loss";
+        
+        CHECK_MSG(run.inOrder, label);
+        CHECK_MSG(run.replyInOrder, label + ", reverse direction");
+        CHECK_MSG(run.pending == 0, label + ", " + std::to_string(run.pending) + " pending");
+    }
+}
+
+TEST_CASE(reliable, unreliable_stream_is_never_held_back) {
+    LossyRun run = runLossy(badLink(20), 2000);
+    
+    // Only what the link loses is missing (duplicates are delivered as they come)...
+    CHECK_MSG(run.unreliableDelivered >= static_cast<size_t>(run.unreliableSent * 0.7),
+              std::to_string(run.unreliableDelivered) + " of " + std::to_string(run.unreliableSent));
+    // ...and nothing waited for a resend of a reliable message ahead of it, including
+    // inputs that rode in envelopes to carry acks
+    CHECK(run.unreliableOnTime);
+    CHECK_MSG(run.unreliableWrapped > run.unreliableSent / 10, std::to_string(run.unreliableWrapped) + " wrapped");
+}
+
+TEST_CASE(reliable, gap_blocks_only_reliable_messages) {
+    ReliableChannel sender, receiver;
+    std::vector<NetworkMessage> delivered;
+    Clock::time_point now;
+    
+    NetworkMessage first, lost, third;
+    sender.send(shot(0), now, first);
+    sender.send(shot(1), now, lost);
+    sender.send(shot(2), now, third);
+    
+    // The receiver says something too, so the sender owes it an ack to wrap around input
+    NetworkMessage hello;
+    receiver.send(respawn(0), now, hello);
+    sender.receive(hello, now, delivered);
+    delivered.clear();
+    
+    receiver.receive(first, now, delivered);
+    receiver.receive(third, now, delivered);
+    CHECK(delivered.size() == 1 && delivered[0].data == "shot-0");
+    
+    // With shot-1 missing and shot-2 waiting behind it, input still goes straight through
+    NetworkMessage input = move(7, now);
+    CHECK(sender.wrapUnreliable(input));
+    delivered.clear();
+    receiver.receive(input, now, delivered);
+    CHECK(delivered.size() == 1 && delivered[0].type == MessageType::PLAYER_MOVE);
+    
+    // The resend fills the gap and releases both, in order, exactly once
+    std::vector<NetworkMessage> resends;
+    sender.update(now + std::chrono::seconds(1), resends);
+    delivered.clear();
+    for (const NetworkMessage& resend : resends) {
+        receiver.receive(resend, now, delivered);
+    }
+    receiver.receive(third, now, delivered); // A late duplicate
+    CHECK(delivered.size() == 2 && delivered[0].data == "shot-1" && delivered[1].data == "shot-2");
+}
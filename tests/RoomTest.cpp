@@ -0,0 +1,127 @@
+#include "TestHarness.h"
+#include "GameRoom.h"
+#include "RoomManager.h"
+#include "ServerWorker.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+TEST_CASE(rooms, join_fields) {
+    std::string name, room;
+    int rate = -1;
+    
+    CHECK(GameRoom::parseJoin("alice", name, room, rate));
+    CHECK(name == "alice" && room.empty() && rate == 0);
+    
+    CHECK(GameRoom::parseJoin("alice|lobby", name, room, rate));
+    CHECK(name == "alice" && room == "lobby" && rate == 0);
+    
+    CHECK(GameRoom::parseJoin("bot-3||4000", name, room, rate));
+    CHECK(name == "bot-3" && room.empty() && rate == 4000);
+}
+
+TEST_CASE(rooms, join_rejects_smuggled_fields) {
+    std::string name, room;
+    int rate;
+    
+    // A name carrying its own room and rate shows up as an extra field
+    CHECK(!GameRoom::parseJoin("bob|lobby|999999|x", name, room, rate));
+    CHECK(!GameRoom::parseJoin("bob|lobby|-5", name, room, rate));
+    CHECK(!GameRoom::parseJoin("bob|lobby|12abc", name, room, rate));
+    CHECK(!GameRoom::parseJoin("bob|lobby|", name, room, rate));
+    CHECK(!GameRoom::parseJoin("bob|" + std::string(GameRoom::MAX_NAME_LENGTH + 1, 'r'), name, room, rate));
+}
+
+TEST_CASE(rooms, join_clamps_name_and_rate) {
+    std::string name, room;
+    int rate;
+    
+    CHECK(GameRoom::parseJoin(std::string(100, 'n') + "|lobby|99999999999999999999", name, room, rate));
+    CHECK(name.size() == static_cast<size_t>(GameRoom::MAX_NAME_LENGTH));
+    CHECK(rate == GameRoom::MAX_CLIENT_RATE);
+}
+
+TEST_CASE(rooms, room_count_is_capped) {
+    RoomSettings settings;
+    settings.maxPlayers = 2;
+    settings.maxRooms = 3;
+    RoomManager manager(settings);
+    ServerWorker worker(0, manager, settings.tickRate); // Adopts the rooms; never run
+    manager.addWorker(&worker);
+    
+    CHECK(manager.placePlayer("a", 1) == 0);
+    CHECK(manager.placePlayer("b", 2) == 1);
+    CHECK(manager.placePlayer("", 3) == 2); // Auto-fill opens the last room
+    CHECK(manager.getRoomCount() == 3);
+    
+    // No new rooms: a new name falls back to auto-fill, and with that full too the join is dropped
+    CHECK(manager.placePlayer("d", 4) == 2);
+    CHECK(manager.placePlayer("e", 5) == -1);
+    CHECK(manager.getRoomCount() == 3);
+    
+    // Every index fits above the local id bits without reaching the sign bit
+    CHECK(((RoomManager::MAX_ROOMS - 1) << GameRoom::PLAYER_ID_BITS) > 0);
+}
+
+TEST_CASE(rooms, empty_rooms_close_and_free_their_index) {
+    RoomSettings settings;
+    settings.maxRooms = 2;
+    settings.emptyRoomSeconds = 30;
+    RoomManager manager(settings);
+    ServerWorker worker(0, manager, settings.tickRate);
+    manager.addWorker(&worker);
+    
+    CHECK(manager.placePlayer("a", 1) == 0);
+    CHECK(manager.placePlayer("b", 2) == 1);
+    RoomManager::Clock::time_point later = RoomManager::Clock::now() + std::chrono::seconds(31);
+    
+    // A reserved place (a join on its way) keeps the room open
+    CHECK(!manager.closeIfIdle(0, later));
+    
+    manager.playerLeft(0, 1);
+    CHECK(!manager.closeIfIdle(0, RoomManager::Clock::now()));
+    CHECK(manager.closeIfIdle(0, later));
+    CHECK(!manager.closeIfIdle(0, later));
+    CHECK(manager.getRoomCount() == 1);
+    
+    // The name is free again and the new room takes the old index
+    CHECK(manager.placePlayer("c", 3) == 0);
+    CHECK(manager.placePlayer("a", 4) == -1);
+}
+
+TEST_CASE(rooms, stats_reply_round_trip) {
+    WorkerStats sent;
+    sent.worker = 3;
+    sent.tickRate = 60;
+    sent.ticks = 123456789012ull;
+    sent.overruns = 17;
+    sent.workMicros = UINT64_MAX;
+    sent.rooms = 48;
+    sent.players = 384;
+    
+    std::string data = ServerWorker::formatStats(sent);
+    CHECK(data == "3|60|123456789012|17|18446744073709551615|48|384");
+    
+    WorkerStats received;
+    CHECK(ServerWorker::parseStats(data, received));
+    CHECK(received.worker == 3 && received.tickRate == 60 && received.ticks == sent.ticks);
+    CHECK(received.overruns == 17 && received.workMicros == UINT64_MAX);
+    CHECK(received.rooms == 48 && received.players == 384);
+    
+    // A fresh worker reports zeros
+    CHECK(ServerWorker::parseStats(ServerWorker::formatStats(WorkerStats()), received));
+    CHECK(received.ticks == 0 && received.rooms == 0 && received.players == 0);
+}
+
+TEST_CASE(rooms, stats_reply_rejects_malformed) {
+    WorkerStats stats;
+    CHECK(!ServerWorker::parseStats("", stats));
+    CHECK(!ServerWorker::parseStats("1|30|100|0|5000|2", stats));      // A field short
+    CHECK(!ServerWorker::parseStats("1|30|100|0|5000|2|16|9", stats)); // One too many
+    CHECK(!ServerWorker::parseStats("1|30|100||5000|2|16", stats));
+    CHECK(!ServerWorker::parseStats("1|30|100|0|5000|2|16|", stats));
+    CHECK(!ServerWorker::parseStats("1|30|-100|0|5000|2|16", stats));
+    CHECK(!ServerWorker::parseStats("1|30|100|0|5000|2|16x", stats));
+    CHECK(!ServerWorker::parseStats("1|30| 100|0|5000|2|16", stats));
+    CHECK(!ServerWorker::parseStats("1|30|100|0|5000|2|4294967296", stats)); // Players don't fit an int
+}
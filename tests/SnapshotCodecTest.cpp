@@ -0,0 +1,215 @@
+#include "TestHarness.h"
+#include "SnapshotCodec.h"
+#include <cmath>
+#include <random>
+#include <string>
+
+namespace {
+
+const float POSITION_STEP = 1.0f / 8.0f;
+const float ANGLE_STEP = 2.0f * 3.14159265f / 65536.0f;
+
+PlayerSnapshot player(int id, const std::string& name, float x, float y) {
+    PlayerSnapshot snapshot;
+    snapshot.id = id;
+    snapshot.name = name;
+    snapshot.x = x;
+    snapshot.y = y;
+    snapshot.health = 100;
+    snapshot.alive = true;
+    snapshot.angle = 0.5f;
+    snapshot.lastInputSequence = 1000 + id;
+    return snapshot;
+}
+
+BulletSnapshot bullet(int id, int ownerId, float x, float y) {
+    return BulletSnapshot{id, ownerId, x, y, 281.3f, -120.06f};
+}
+
+WorldSnapshot sampleWorld(int tick) {
+    WorldSnapshot world;
+    world.tick = tick;
+    world.players.push_back(player(1, "alice", 100.3f, 200.71f));
+    world.players.push_back(player(2, "bob", 1999.9f, 0.06f));
+    world.players.push_back(player(40000, "", 0, 1500)); // Multi-byte varint id
+    world.players[1].alive = false;
+    world.players[1].health = 0;
+    world.players[2].angle = -3.1f;
+    world.bullets.push_back(bullet(7, 1, 140.2f, 210.9f));
+    world.bullets.push_back(bullet(300, 2, 1890.55f, 12.4f));
+    return world;
+}
+
+// Equal as far as the wire can tell
+bool sameOnWire(const WorldSnapshot& expected, const WorldSnapshot& actual, std::string& why) {
+    if (expected.tick != actual.tick) { why = "tick"; return false; }
+    if (expected.players.size() != actual.players.size()) { why = "player count"; return false; }
+    if (expected.bullets.size() != actual.bullets.size()) { why = "bullet count"; return false; }
+    
+    for (size_t i = 0; i < expected.players.size(); i++) {
+        const PlayerSnapshot& a = expected.players[i];
+        const PlayerSnapshot& b = actual.players[i];
+        why = "player " + std::to_string(a.id);
+        if (a.id != b.id || a.name != b.name || a.health != b.health || a.alive != b.alive) return false;
+        if (a.lastInputSequence != b.lastInputSequence) return false;
+        if (std::fabs(a.x - b.x) > POSITION_STEP / 2 || std::fabs(a.y - b.y) > POSITION_STEP / 2) return false;
+        if (std::fabs(std::remainder(a.angle - b.angle, 2.0f * 3.14159265f)) > ANGLE_STEP) return false;
+    }
+    for (size_t i = 0; i < expected.bullets.size(); i++) {
+        const BulletSnapshot& a = expected.bullets[i];
+        const BulletSnapshot& b = actual.bullets[i];
+        why = "bullet " + std::to_string(a.id);
+        if (a.id != b.id || a.ownerId != b.ownerId) return false;
+        if (std::fabs(a.x - b.x) > POSITION_STEP / 2 || std::fabs(a.y - b.y) > POSITION_STEP / 2) return false;
+        if (std::fabs(a.velX - b.velX) > POSITION_STEP / 2 || std::fabs(a.velY - b.velY) > POSITION_STEP / 2) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+TEST_CASE(codec, full_round_trip) {
+    WorldSnapshot world = sampleWorld(123456);
+    std::string encoded;
+    SnapshotCodec::encode(world, encoded);
+    CHECK(SnapshotCodec::isBinary(encoded));
+    
+    WorldSnapshot decoded;
+    std::string why;
+    CHECK(SnapshotCodec::decode(encoded, decoded));
+    CHECK_MSG(sameOnWire(world, decoded, why), why);
+    
+    // An empty world is a valid snapshot too
+    WorldSnapshot empty;
+    empty.tick = 5;
+    SnapshotCodec::encode(empty, encoded);
+    CHECK(SnapshotCodec::decode(encoded, decoded));
+    CHECK(decoded.tick == 5 && decoded.players.empty() && decoded.bullets.empty());
+}
+
+TEST_CASE(codec, delta_round_trip) {
+    WorldSnapshot baseline = sampleWorld(10);
+    WorldSnapshot current = sampleWorld(11);
+    current.players[0].x += 3.2f;                                   // Moved
+    current.players[1].alive = true;                                // Respawned
+    current.players[1].health = 100;
+    current.players.erase(current.players.begin() + 2);             // Left
+    current.players.push_back(player(50000, "carol", 640, 480));    // Joined
+    current.bullets.erase(current.bullets.begin());                 // Hit something
+    current.bullets.push_back(bullet(301, 1, 400, 300));            // Fired
+    
+    SnapshotHistory history;
+    history.store(baseline);
+    
+    std::string delta, full;
+    SnapshotCodec::encodeDelta(baseline, current, delta);
+    SnapshotCodec::encode(current, full);
+    CHECK(delta.size() < full.size());
+    
+    WorldSnapshot decoded;
+    std::string why;
+    CHECK(SnapshotCodec::decode(delta, decoded, &history));
+    CHECK_MSG(sameOnWire(current, decoded, why), why);
+    
+    // Nothing changed: only the header and four empty lists
+    SnapshotCodec::encodeDelta(baseline, baseline, delta);
+    CHECK(SnapshotCodec::decode(delta, decoded, &history));
+    CHECK_MSG(sameOnWire(baseline, decoded, why), why);
+    CHECK(delta.size() <= 10);
+    
+    // Without the baseline a delta can't be applied
+    SnapshotHistory empty;
+    SnapshotCodec::encodeDelta(baseline, current, delta);
+    CHECK(!SnapshotCodec::decode(delta, decoded, &empty));
+    CHECK(!SnapshotCodec::decode(delta, decoded));
+}
+
+TEST_CASE(codec, quantization_bounds) {
+    // Positions: 1/8 px steps, rounded to nearest, clamped to the i16 range
+    const float positions[] = {0.0f, 0.06f, -0.06f, 1234.567f, -2048.3f, 4095.8f};
+    for (float position : positions) {
+        float back = SnapshotCodec::dequantizePosition(SnapshotCodec::quantizePosition(position));
+        CHECK_MSG(std::fabs(back - position) <= POSITION_STEP / 2, std::to_string(position));
+    }
+    CHECK(SnapshotCodec::quantizePosition(100000.0f) == 32767);
+    CHECK(SnapshotCodec::quantizePosition(-100000.0f) == -32768);
+    
+    // Angles cover a full turn and wrap instead of clamping
+    const float angles[] = {0.0f, 1.0f, -1.0f, 3.14f, -3.14159f, 6.0f, -9.5f};
+    for (float angle : angles) {
+        float back = SnapshotCodec::dequantizeAngle(SnapshotCodec::quantizeAngle(angle));
+        CHECK_MSG(std::fabs(std::remainder(back - angle, 2.0f * 3.14159265f)) <= ANGLE_STEP, std::to_string(angle));
+    }
+    CHECK(SnapshotCodec::quantizeAngle(3.14159265f) == SnapshotCodec::quantizeAngle(-3.14159265f));
+    
+    // Health has 7 bits next to the alive flag
+    WorldSnapshot world = sampleWorld(1);
+    world.players[0].health = 500;
+    world.players[1].health = -20;
+    std::string encoded;
+    SnapshotCodec::encode(world, encoded);
+    WorldSnapshot decoded;
+    CHECK(SnapshotCodec::decode(encoded, decoded));
+    CHECK(decoded.players[0].health == 127 && decoded.players[0].alive);
+    CHECK(decoded.players[1].health == 0 && !decoded.players[1].alive);
+}
+
+TEST_CASE(codec, rejects_truncated_and_garbage_input) {
+    WorldSnapshot baseline = sampleWorld(20);
+    WorldSnapshot current = sampleWorld(21);
+    current.players[0].y -= 40;
+    current.bullets.push_back(bullet(900, 2, 10, 10));
+    SnapshotHistory history;
+    history.store(baseline);
+    
+    std::string full, delta;
+    SnapshotCodec::encode(current, full);
+    SnapshotCodec::encodeDelta(baseline, current, delta);
+    WorldSnapshot decoded;
+    
+    // Every cut short of the whole message fails, as does anything trailing it
+    for (size_t length = 0; length < full.size(); length++) {
+        CHECK_MSG(!SnapshotCodec::decode(full.substr(0, length), decoded), "full cut at " + std::to_string(length));
+    }
+    for (size_t length = 0; length < delta.size(); length++) {
+        CHECK_MSG(!SnapshotCodec::decode(delta.substr(0, length), decoded, &history),
+                  "delta cut at " + std::to_string(length));
+    }
+    CHECK(!SnapshotCodec::decode(full + '\0', decoded));
+    CHECK(!SnapshotCodec::decode(delta + '\0', decoded, &history));
+    
+    // Wrong magic, version or kind
+    std::string bad = full;
+    bad[0] = 'x';
+    CHECK(!SnapshotCodec::isBinary(bad) && !SnapshotCodec::decode(bad, decoded));
+    bad = full;
+    bad[1] = static_cast<char>(SnapshotCodec::VERSION + 1);
+    CHECK(!SnapshotCodec::decode(bad, decoded));
+    bad = full;
+    bad[2] = 7;
+    CHECK(!SnapshotCodec::decode(bad, decoded));
+    
+    // A huge count is refused before anything is allocated for it
+    std::string huge;
+    huge.push_back(static_cast<char>(SnapshotCodec::MAGIC));
+    huge.push_back(static_cast<char>(SnapshotCodec::VERSION));
+    huge += std::string("\0\x01\xff\xff\xff\xff\x0f", 7);
+    CHECK(!SnapshotCodec::decode(huge, decoded));
+    
+    // The text format is not mistaken for binary
+    CHECK(!SnapshotCodec::isBinary("PLAYERS:1:alice:100:200"));
+    
+    // Random bytes behind a valid header never get past the length checks
+    std::mt19937 random(5);
+    int accepted = 0;
+    for (int i = 0; i < 2000; i++) {
+        std::string garbage = full.substr(0, 4);
+        size_t length = random() % 64;
+        for (size_t j = 0; j < length; j++) {
+            garbage.push_back(static_cast<char>(random() & 0xFF));
+        }
+        garbage[2] = static_cast<char>(random() % 2); // Full or delta
+        if (SnapshotCodec::decode(garbage, decoded, &history)) accepted++;
+    }
+    CHECK_MSG(accepted < 20, std::to_string(accepted) + " random payloads accepted");
+}
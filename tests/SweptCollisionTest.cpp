@@ -0,0 +1,114 @@
+#include "TestHarness.h"
+#include "GameState.h"
+#include <cmath>
+#include <string>
+
+// Fast bullets at long steps against the real map. Each case runs at the tick
+// rates a server might be turned down to, and once more with enough extra players
+// parked along the bottom edge to switch GameState onto its spatial hash.
+
+namespace {
+
+const float STEP_SECONDS[] = {1.0f / 30.0f, 0.1f, 0.25f, 0.5f};
+const int SHOOTER_ID = 99; // Never added, so no one is skipped as the owner
+const int TARGET_ID = 1;
+const float PI = 3.14159265f;
+
+void addFillerPlayers(GameState& state, bool useHash) {
+    if (!useHash) return;
+    for (int i = 0; i < 30; i++) {
+        int id = 100 + i;
+        state.addPlayer(id, "filler");
+        state.getPlayer(id)->setPosition(20.0f + 50.0f * i, 1450.0f);
+    }
+}
+
+// Steps until the bullet is gone or a couple of seconds have passed; returns the
+// number of steps that still had it in flight
+int runUntilGone(GameState& state, float step) {
+    int steps = 0;
+    for (; steps < static_cast<int>(2.0f / step) && state.getBullets().size() > 0; steps++) {
+        state.update(step);
+    }
+    return steps;
+}
+
+std::string label(float step, bool useHash) {
+    return "dt " + std::to_string(step) + (useHash ? ", spatial hash" : ", nested loop");
+}
+
+} // namespace
+
+TEST_CASE(swept, bullet_stops_at_thin_platform) {
+    for (bool useHash : {false, true}) {
+        for (float step : STEP_SECONDS) {
+            GameState state;
+            addFillerPlayers(state, useHash);
+            
+            // Straight down at the 38 px left upper platform (375, 500, 250, 38)
+            state.addBullet(1, SHOOTER_ID, 500, 440, PI / 2, 400.0f);
+            
+            // Stopped on the step that reaches it, never seen below it
+            bool stopped = false;
+            for (int i = 0; i < static_cast<int>(2.0f / step); i++) {
+                state.update(step);
+                const std::vector<Bullet>& bullets = state.getAllBullets();
+                if (bullets.empty()) {
+                    stopped = true;
+                    break;
+                }
+                if (bullets[0].getY() >= 500) break;
+            }
+            CHECK_MSG(stopped, label(step, useHash));
+        }
+    }
+}
+
+TEST_CASE(swept, fast_bullet_hits_player_it_would_skip) {
+    for (bool useHash : {false, true}) {
+        for (float step : STEP_SECONDS) {
+            GameState state;
+            addFillerPlayers(state, useHash);
+            state.addPlayer(TARGET_ID, "target");
+            state.getPlayer(TARGET_ID)->setPosition(1000, 100);
+            
+            // 1200 px/s: at every step here but 1/30 s the end point is past the player
+            state.addBullet(1, SHOOTER_ID, 975, 120, 0, 1200.0f);
+            runUntilGone(state, step);
+            
+            CHECK_MSG(state.getPlayer(TARGET_ID)->getHealth() < 100, label(step, useHash));
+            CHECK_MSG(state.getBullets().size() == 0, label(step, useHash));
+        }
+    }
+}
+
+TEST_CASE(swept, wall_shields_player_behind_it) {
+    for (bool useHash : {false, true}) {
+        for (float step : STEP_SECONDS) {
+            GameState state;
+            addFillerPlayers(state, useHash);
+            
+            // Behind the central cover wall (950, 700, 100, 200), in the line of fire
+            state.addPlayer(TARGET_ID, "target");
+            state.getPlayer(TARGET_ID)->setPosition(1060, 780);
+            
+            state.addBullet(1, SHOOTER_ID, 900, 800, 0, 1200.0f);
+            runUntilGone(state, step);
+            
+            CHECK_MSG(state.getPlayer(TARGET_ID)->getHealth() == 100, label(step, useHash));
+            CHECK_MSG(state.getBullets().size() == 0, label(step, useHash));
+        }
+    }
+}
+
+TEST_CASE(swept, open_line_of_fire_is_clear) {
+    // Control for the player case: with no one there the bullet keeps flying
+    // past where the target would stand
+    for (float step : STEP_SECONDS) {
+        GameState state;
+        state.addBullet(1, SHOOTER_ID, 975, 120, 0, 1200.0f);
+        state.update(step);
+        const std::vector<Bullet>& bullets = state.getAllBullets();
+        CHECK_MSG(bullets.size() == 1 && bullets[0].getX() > 1010, label(step, false));
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Minimal self-registering test cases for the headless test binary. Each case is
+// named "suite.case"; the binary runs every case whose name starts with its
+// argument, so CMake registers one ctest entry per suite.
+namespace test {
+
+struct TestCase {
+    const char* name;
+    void (*run)();
+};
+
+inline std::vector<TestCase>& registry() {
+    static std::vector<TestCase> cases;
+    return cases;
+}
+
+inline int& failures() {
+    static int count = 0;
+    return count;
+}
+
+struct Registrar {
+    Registrar(const char* name, void (*run)()) { registry().push_back(TestCase{name, run}); }
+};
+
+inline void fail(const char* file, int line, const std::string& what) {
+    std::cerr << file << ":" << line << ": check failed: " << what << std::endl;
+    failures()++;
+}
+
+} // namespace test
+
+#define TEST_CASE(suite, name)                                                        \
+    static void suite##_##name();                                                     \
+    static test::Registrar suite##_##name##_registrar(#suite "." #name, suite##_##name); \
+    static void suite##_##name()
+
+// Records the failure and carries on, so one run reports every broken case
+#define CHECK(condition)                                                              \
+    do {                                                                              \
+        if (!(condition)) test::fail(__FILE__, __LINE__, #condition);                 \
+    } while (0)
+
+#define CHECK_MSG(condition, message)                                                 \
+    do {                                                                              \
+        if (!(condition)) test::fail(__FILE__, __LINE__, std::string(#condition) + " (" + (message) + ")"); \
+    } while (0)
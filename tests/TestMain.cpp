@@ -0,0 +1,24 @@
+#include "TestHarness.h"
+#include <cstring>
+#include <iostream>
+
+// Runs the cases whose name starts with the first argument (all of them without one)
+int main(int argc, char* argv[]) {
+    const char* prefix = argc > 1 ? argv[1] : "";
+    
+    int run = 0;
+    for (const test::TestCase& testCase : test::registry()) {
+        if (std::strncmp(testCase.name, prefix, std::strlen(prefix)) != 0) continue;
+        
+        int failuresBefore = test::failures();
+        testCase.run();
+        std::cout << (test::failures() == failuresBefore ? "PASS " : "FAIL ") << testCase.name << std::endl;
+        run++;
+    }
+    
+    if (run == 0) {
+        std::cerr << "No test cases match '" << prefix << "'" << std::endl;
+        return 1;
+    }
+    return test::failures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,140 @@
+#include "TestHarness.h"
+#include "TickProfiler.h"
+#include <sstream>
+#include <string>
+
+namespace {
+
+// The value after "key=" on the report line for a section, or -1 if it's missing
+float reported(const std::string& report, const std::string& section, const std::string& key) {
+    size_t line = report.find(section + " (");
+    if (line == std::string::npos) return -1;
+    size_t end = report.find('\n', line);
+    size_t value = report.find(" " + key + "=", line);
+    if (value == std::string::npos || value > end) return -1;
+    return std::stof(report.substr(value + key.size() + 2));
+}
+
+std::string takeReport(TickProfiler& profiler) {
+    std::ostringstream out;
+    profiler.report(out, "");
+    return out.str();
+}
+
+// Restores the process-wide switches whatever a case leaves them at
+struct ProfilerScope {
+    explicit ProfilerScope(TickProfiler* profiler) {
+        TickProfiler::setCurrent(profiler);
+        TickProfiler::setEnabled(true);
+    }
+    ~ProfilerScope() {
+        TickProfiler::setEnabled(false);
+        TickProfiler::setCurrent(nullptr);
+    }
+};
+
+} // namespace
+
+TEST_CASE(profiler, percentiles_over_ticks) {
+    TickProfiler profiler;
+    int section = TickProfiler::registerSection("test.percentiles");
+    CHECK(section >= 0);
+    
+    // 1..100 us, one sample per tick, added out of order
+    for (int i = 0; i < 100; i++) {
+        profiler.add(section, static_cast<uint64_t>((i * 37) % 100 + 1) * 1000);
+        profiler.endTick();
+    }
+    
+    std::string report = takeReport(profiler);
+    CHECK_MSG(report.find("test.percentiles (us, 100 samples)") != std::string::npos, report);
+    CHECK(reported(report, "test.percentiles", "p50") == 51);
+    CHECK(reported(report, "test.percentiles", "p95") == 95);
+    CHECK(reported(report, "test.percentiles", "p99") == 99);
+    CHECK(reported(report, "test.percentiles", "max") == 100);
+    
+    // Reporting starts the next window
+    CHECK(takeReport(profiler).empty());
+}
+
+TEST_CASE(profiler, end_tick_sums_each_section_once) {
+    TickProfiler profiler;
+    int busy = TickProfiler::registerSection("test.busy");
+    int idle = TickProfiler::registerSection("test.idle");
+    CHECK(TickProfiler::registerSection("test.busy") == busy); // Same name, same section
+    
+    // Several scopes in one tick are one sample of their total
+    profiler.add(busy, 2000);
+    profiler.add(busy, 3000);
+    profiler.endTick();
+    
+    // A tick where the section didn't run adds no sample (rather than a zero)...
+    profiler.add(idle, 1000);
+    profiler.endTick();
+    
+    // ...and a tick where nothing ran adds nothing at all
+    profiler.endTick();
+    
+    profiler.add(busy, 7000);
+    profiler.endTick();
+    
+    std::string report = takeReport(profiler);
+    CHECK_MSG(report.find("test.busy (us, 2 samples)") != std::string::npos, report);
+    CHECK_MSG(report.find("test.idle (us, 1 samples)") != std::string::npos, report);
+    CHECK(reported(report, "test.busy", "max") == 7);
+    CHECK(reported(report, "test.busy", "p50") == 7); // Of {5, 7}
+    CHECK(reported(report, "test.idle", "max") == 1);
+    
+    // Time recorded after the last endTick waits for the next one
+    profiler.add(busy, 4000);
+    CHECK(takeReport(profiler).empty());
+    profiler.endTick();
+    CHECK(reported(takeReport(profiler), "test.busy", "max") == 4);
+}
+
+TEST_CASE(profiler, scopes_record_only_when_enabled) {
+    TickProfiler profiler;
+    TickProfiler::setCurrent(&profiler);
+    {
+        PROFILE_SCOPE("test.scope");
+    }
+    profiler.endTick();
+    CHECK(takeReport(profiler).empty());
+    
+    {
+        ProfilerScope enabled(&profiler);
+        {
+            PROFILE_SCOPE("test.scope");
+        }
+        profiler.endTick();
+    }
+    
+    // Without a profiler installed on the thread, an enabled scope is a no-op
+    {
+        ProfilerScope enabled(nullptr);
+        PROFILE_SCOPE("test.scope");
+    }
+    
+    std::string report = takeReport(profiler);
+#ifdef ENABLE_PROFILING
+    CHECK_MSG(report.find("test.scope (us, 1 samples)") != std::string::npos, report);
+#else
+    CHECK(report.empty());
+#endif
+}
+
+TEST_CASE(profiler, sample_window_keeps_the_latest_ticks) {
+    TickProfiler profiler;
+    int section = TickProfiler::registerSection("test.window");
+    
+    // The first ticks are slow, then they fall out of the window
+    for (size_t i = 0; i < TickProfiler::SAMPLE_CAPACITY + 10; i++) {
+        profiler.add(section, i < 10 ? 900000 : 1000);
+        profiler.endTick();
+    }
+    
+    std::string report = takeReport(profiler);
+    CHECK_MSG(report.find("(us, " + std::to_string(TickProfiler::SAMPLE_CAPACITY) + " samples)") != std::string::npos,
+              report);
+    CHECK(reported(report, "test.window", "max") == 1);
+}